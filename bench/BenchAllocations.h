@@ -0,0 +1,85 @@
+#pragma once
+
+/**
+ * @brief Counting replacement of global operator new for benchmarks: every heap allocation of process
+ *        (including std::pmr::new_delete_resource) is counted with its size.
+ * @note include into exactly one translation unit of benchmark executable
+ */
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <cstddef>
+
+namespace reactor::bench {
+
+    struct AllocationCounters
+    {
+        std::atomic<size_t> allocations { 0 };
+        std::atomic<size_t> bytes { 0 };
+    };
+
+    inline AllocationCounters g_allocations {};
+
+    /**
+     * @struct AllocationsSnapshot
+     * @brief counters at some moment, difference of two snapshots is cost of code between them
+     */
+    struct AllocationsSnapshot
+    {
+        size_t allocations { 0 };
+        size_t bytes { 0 };
+
+        static AllocationsSnapshot now()
+        {
+            return AllocationsSnapshot { g_allocations.allocations.load(std::memory_order_relaxed), g_allocations.bytes.load(std::memory_order_relaxed) };
+        }
+
+        AllocationsSnapshot operator-(const AllocationsSnapshot& other) const
+        {
+            return AllocationsSnapshot { allocations - other.allocations, bytes - other.bytes };
+        }
+    };
+}
+
+void* operator new(std::size_t size)
+{
+    reactor::bench::g_allocations.allocations.fetch_add(1, std::memory_order_relaxed);
+    reactor::bench::g_allocations.bytes.fetch_add(size, std::memory_order_relaxed);
+
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+    reactor::bench::g_allocations.allocations.fetch_add(1, std::memory_order_relaxed);
+    reactor::bench::g_allocations.bytes.fetch_add(size, std::memory_order_relaxed);
+
+    const auto alignValue = static_cast<std::size_t>(alignment);
+    if (void* pointer = std::aligned_alloc(alignValue, (size + alignValue - 1) / alignValue * alignValue))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+    std::free(pointer);
+}
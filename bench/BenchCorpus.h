@@ -0,0 +1,169 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <fmt/format.h>
+
+namespace reactor::bench {
+
+    /**
+     * @fn makeCorpus
+     * @brief getUpdates response with messages which have 0, 1, 2 and 3 entities (one of them is bot command)
+     */
+    inline std::string makeCorpus(size_t updatesCount, size_t firstUpdateId = 0)
+    {
+        static constexpr const char* Entities[] = {
+            "",
+            R"(,"entities":[{"type":"bot_command","offset":0,"length":6}])",
+            R"(,"entities":[{"type":"bot_command","offset":0,"length":6},{"type":"mention","offset":7,"length":5}])",
+            R"(,"entities":[{"type":"bold","offset":7,"length":5},{"type":"url","offset":13,"length":8},{"type":"hashtag","offset":22,"length":4}])"
+        };
+
+        std::string corpus = R"({"ok":true,"result":[)";
+
+        for (size_t updateId = firstUpdateId; updateId < firstUpdateId + updatesCount; ++updateId)
+        {
+            if (updateId > firstUpdateId)
+                corpus += ",";
+
+            corpus += fmt::format(
+                R"({{"update_id":{},"message":{{"message_id":{},"from":{{"id":1001,"is_bot":false,"first_name":"Alice"}},)"
+                R"("date":1600000000,"chat":{{"id":-100500,"type":"supergroup","title":"Bench"}},)"
+                R"("text":"/start @bob example.org #tag"{}}}}})",
+                updateId, updateId, Entities[updateId % 4]);
+        }
+
+        return corpus + "]}";
+    }
+
+    /**
+     * @enum PayloadKind
+     * @brief shapes of messages seen in recorded group traffic
+     */
+    enum class PayloadKind
+    {
+        PlainText,          ///< text without entities
+        HeavyEntities,      ///< text with 9 entities: mentions, commands with offset, urls, text links and text mentions
+        NestedReply,        ///< forwarded reply to reply, every level has own sender and entities
+        Sticker,            ///< sticker without text
+        JoinEvent           ///< service message: several users joined chat
+    };
+
+    inline constexpr PayloadKind PayloadKinds[] = {
+        PayloadKind::PlainText, PayloadKind::HeavyEntities, PayloadKind::NestedReply, PayloadKind::Sticker, PayloadKind::JoinEvent
+    };
+
+    inline const char* getPayloadName(PayloadKind kind)
+    {
+        switch (kind)
+        {
+            case PayloadKind::PlainText: return "plain_text";
+            case PayloadKind::HeavyEntities: return "heavy_entities";
+            case PayloadKind::NestedReply: return "nested_reply";
+            case PayloadKind::Sticker: return "sticker";
+            case PayloadKind::JoinEvent: return "join_event";
+        }
+
+        return "unknown";
+    }
+
+    /**
+     * @fn makeMessagePayload
+     * @brief message object as Bot API sends it, including fields which are not declared in TL schema (they are skipped by parser)
+     */
+    inline std::string makeMessagePayload(PayloadKind kind, size_t messageId)
+    {
+        static constexpr const char* Chat = R"("chat":{"id":-1001234567890,"title":"Reactor Developers","username":"reactor_dev","type":"supergroup"})";
+        static constexpr const char* From = R"("from":{"id":123456789,"is_bot":false,"first_name":"Alice","last_name":"Smith","username":"alice_dev","language_code":"en"})";
+
+        switch (kind)
+        {
+            case PayloadKind::PlainText:
+                return fmt::format(
+                    R"({{"message_id":{},{},{},"date":1609459200,"text":"Good morning! Did anybody look at the build failures from yesterday evening?"}})",
+                    messageId, From, Chat);
+
+            case PayloadKind::HeavyEntities:
+                return fmt::format(
+                    R"({{"message_id":{},{},{},"date":1609459260,)"
+                    R"("text":"Hey @alice_dev, please run /deploy@ReactorBot staging and check https://ci.example.org/builds/1234 #release #ci - thanks Bob, see docs or ping /status",)"
+                    R"("entities":[{{"offset":4,"length":10,"type":"mention"}},{{"offset":27,"length":18,"type":"bot_command"}},)"
+                    R"({{"offset":46,"length":7,"type":"code"}},{{"offset":64,"length":34,"type":"url"}},{{"offset":99,"length":8,"type":"hashtag"}},)"
+                    R"({{"offset":108,"length":3,"type":"hashtag"}},)"
+                    R"({{"offset":121,"length":3,"type":"text_mention","user":{{"id":987654321,"is_bot":false,"first_name":"Bob","language_code":"de"}}}},)"
+                    R"({{"offset":130,"length":4,"type":"text_link","url":"https://docs.example.org/reactor/deploy"}},{{"offset":143,"length":7,"type":"bot_command"}}]}})",
+                    messageId, From, Chat);
+
+            case PayloadKind::NestedReply:
+                return fmt::format(
+                    R"({{"message_id":{},{},{},"date":1609459320,)"
+                    R"("forward_from":{{"id":555000111,"is_bot":false,"first_name":"Carol","username":"carol_ops"}},"forward_date":1609450000,)"
+                    R"("reply_to_message":{{"message_id":{},"from":{{"id":987654321,"is_bot":false,"first_name":"Bob","language_code":"de"}},{},"date":1609459300,)"
+                    R"("reply_to_message":{{"message_id":{},{},{},"date":1609459280,"text":"/status@ReactorBot",)"
+                    R"("entities":[{{"offset":0,"length":18,"type":"bot_command"}}]}},)"
+                    R"("text":"@alice_dev status is green, see https://ci.example.org",)"
+                    R"("entities":[{{"offset":0,"length":10,"type":"mention"}},{{"offset":32,"length":22,"type":"url"}}]}},)"
+                    R"("text":"Confirmed, staging is healthy"}})",
+                    messageId, From, Chat, messageId - 1, Chat, messageId - 2, From, Chat);
+
+            case PayloadKind::Sticker:
+                return fmt::format(
+                    R"({{"message_id":{},{},{},"date":1609459380,)"
+                    R"("sticker":{{"width":512,"height":512,"emoji":"👍","set_name":"ReactorPack","is_animated":false,"is_video":false,"type":"regular",)"
+                    R"("thumb":{{"file_id":"AAMCAgADGQEAAgJhX_thumb","file_unique_id":"AQADthumb","file_size":5416,"width":128,"height":128}},)"
+                    R"("file_id":"CAACAgIAAxkBAAICYV_sticker_file_id","file_unique_id":"AgADsticker","file_size":26454}}}})",
+                    messageId, From, Chat);
+
+            case PayloadKind::JoinEvent:
+                return fmt::format(
+                    R"({{"message_id":{},{},{},"date":1609459440,)"
+                    R"("new_chat_participant":{{"id":700000001,"is_bot":false,"first_name":"Dave"}},)"
+                    R"("new_chat_member":{{"id":700000001,"is_bot":false,"first_name":"Dave"}},)"
+                    R"("new_chat_members":[{{"id":700000001,"is_bot":false,"first_name":"Dave"}},)"
+                    R"({{"id":700000002,"is_bot":false,"first_name":"Erin","last_name":"Walker","username":"erin_w","language_code":"en"}},)"
+                    R"({{"id":700000003,"is_bot":true,"first_name":"HelperBot","username":"helper_bot"}}]}})",
+                    messageId, From, Chat);
+        }
+
+        return {};
+    }
+
+    inline std::string makeUpdatePayload(PayloadKind kind, size_t updateId)
+    {
+        return fmt::format(R"({{"update_id":{},"message":{}}})", updateId, makeMessagePayload(kind, updateId + 1000));
+    }
+
+    /**
+     * @fn makeCorpus
+     * @brief getUpdates response where every update is message of given kind
+     */
+    inline std::string makeCorpus(PayloadKind kind, size_t updatesCount, size_t firstUpdateId = 0)
+    {
+        std::string corpus = R"({"ok":true,"result":[)";
+
+        for (size_t updateId = firstUpdateId; updateId < firstUpdateId + updatesCount; ++updateId)
+        {
+            if (updateId > firstUpdateId)
+                corpus += ",";
+
+            corpus += makeUpdatePayload(kind, updateId);
+        }
+
+        return corpus + "]}";
+    }
+
+    inline std::string makeVideoPayload()
+    {
+        return R"({"duration":37,"width":1280,"height":720,"file_name":"deploy.mp4","mime_type":"video/mp4",)"
+               R"("thumb":{"file_id":"AAMCAgADGQEAAgJjX_video_thumb","file_unique_id":"AQADvthumb","file_size":11028,"width":320,"height":180},)"
+               R"("file_id":"BAACAgIAAxkBAAICY1_video_file_id","file_unique_id":"AgADvideo","file_size":5839213})";
+    }
+
+    inline std::string makeChatMemberPayload()
+    {
+        return R"({"user":{"id":700000002,"is_bot":false,"first_name":"Erin","last_name":"Walker","username":"erin_w","language_code":"en"},)"
+               R"("status":"restricted","until_date":1612137600,"is_member":true,"can_send_messages":true,"can_send_media_messages":false,)"
+               R"("can_send_polls":false,"can_send_other_messages":false,"can_add_web_page_previews":true,"can_change_info":false,)"
+               R"("can_invite_users":true,"can_pin_messages":false})";
+    }
+}
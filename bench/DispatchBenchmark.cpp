@@ -0,0 +1,101 @@
+/**
+ * @brief DispatchBenchmark - cost of parsing and dispatching typical updates (0-3 entities per message).
+ *        Prints time, heap allocations and allocated bytes per update for parse and dispatch (Server::onUpdates) stages.
+ *
+ * Usage: DispatchBenchmark [iterations]
+ */
+#include <TelegramBot.h>
+#include "BenchCorpus.h"
+#include "BenchAllocations.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace reactor::bench {
+
+    class CountingProcessor : public telegram::ITelergamMessageProcessor
+    {
+    public:
+        size_t messagesCount { 0 };
+        size_t commandsCount { 0 };
+
+        void onMessage(const telegram::MessagePtr& message, const telegram::ServerPtr&) override
+        {
+            messagesCount += message->text.has_value() ? 1 : 0;
+        }
+
+        void onBotCommands(const telegram::MessagePtr&, const telegram::BotCommandsList& commands, const telegram::ServerPtr&) override
+        {
+            for (const auto& command : commands)
+                commandsCount += command.command.size();
+        }
+    };
+
+    telegram::UpdatesList parse(const nlohmann::json& response)
+    {
+        telegram::UpdatesList updates {};
+
+        for (const auto& element : response["result"])
+        {
+            telegram::UpdatePtr update = nullptr;
+            nlohmann::adl_serializer<telegram::UpdatePtr>::from_json(element, update);
+            updates.push_back(std::move(update));
+        }
+
+        return updates;
+    }
+
+    template <typename _Fn>
+    void measure(const char* stageName, size_t iterations, size_t updatesPerIteration, _Fn&& stage)
+    {
+        stage(); // warm up
+
+        const auto allocationsBefore = AllocationsSnapshot::now();
+        const auto startedAt = std::chrono::steady_clock::now();
+
+        for (size_t iteration = 0; iteration < iterations; ++iteration)
+            stage();
+
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startedAt).count();
+        const auto allocations = AllocationsSnapshot::now() - allocationsBefore;
+        const double updatesCount = static_cast<double>(iterations * updatesPerIteration);
+
+        std::printf("%-16s %10.1f ns/update %8.2f allocations/update %10.1f bytes/update\n", stageName, elapsed / updatesCount,
+                    static_cast<double>(allocations.allocations) / updatesCount, static_cast<double>(allocations.bytes) / updatesCount);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace reactor;
+
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    static constexpr size_t UpdatesPerBatch = 256;
+
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto response = nlohmann::json::parse(bench::makeCorpus(UpdatesPerBatch));
+
+    bench::CountingProcessor processor {};
+    auto server = std::make_shared<telegram::Server>("BENCH", &processor);
+
+    const auto updates = bench::parse(response);
+
+    bench::measure("parse", iterations, UpdatesPerBatch, [&response]() {
+        bench::parse(response);
+    });
+
+    telegram::TLIdentityMaps identityMaps {};
+    bench::measure("parse+identity", iterations, UpdatesPerBatch, [&response, &identityMaps]() {
+        telegram::TLIdentityScope identityScope { &identityMaps };
+        bench::parse(response);
+    });
+
+    bench::measure("dispatch", iterations, UpdatesPerBatch, [&server, &updates]() {
+        server->onUpdates(updates);
+    });
+
+    std::printf("processed %zu messages, %zu command bytes\n", processor.messagesCount, processor.commandsCount);
+    return EXIT_SUCCESS;
+}
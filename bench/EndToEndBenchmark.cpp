@@ -0,0 +1,368 @@
+/**
+ * @brief EndToEndBenchmark - Server with ChatBotMessageProcessor against local MockBotApiServer.
+ *        Every update is bot command "/u<update_id>" which processor answers with sendMessage ("Unknown command"),
+ *        latency is measured from moment update is available on mock server to moment its reply is received by mock server.
+ *        Result is printed to stdout as single JSON object (parameters, results and stage latencies of engine), progress is logged to stderr.
+ *
+ * Usage: EndToEndBenchmark [options]
+ *        --updates N         updates to process (default 20000)
+ *        --rate R            updates per second, 0 - all updates are available at start (default 0)
+ *        --batch N           getUpdates limit (default 100)
+ *        --handler-us N      busy time of handler per update in microseconds (default 0)
+ *        --delay-ms N        latency of every mock API response in milliseconds (default 0)
+ *        --concurrency N     max concurrent outcoming requests (default 0 - engine default)
+ *        --chats N           count of chats updates come from (default 16)
+ *        --body MODE         request body mode: query, form or json (default json)
+ *        --gzip              compressed responses
+ *        --arena             parse batches into arena
+ *        --pipeline          dispatch on own thread
+ *        --parallel          parse batches on worker pool
+ *        --timeout S         give up after S seconds (default 120)
+ */
+#include <ChatBotMessageProcessor.h>
+#include <MockBotApi.h>
+
+#include <spdlog/sinks/stdout_sinks.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace reactor::bench {
+
+    struct Parameters
+    {
+        size_t updates { 20000 };
+        double rate { 0.0 };
+        uint32_t batch { 100 };
+        int64_t handlerCost { 0 };          ///< Microseconds
+        int64_t networkDelay { 0 };         ///< Milliseconds
+        size_t concurrency { 0 };
+        size_t chats { 16 };
+        std::string bodyMode { "json" };
+        bool isCompressionEnabled { false };
+        bool isArenaEnabled { false };
+        bool isPipelineEnabled { false };
+        bool isParallelParsingEnabled { false };
+        int64_t timeout { 120 };            ///< Seconds
+    };
+
+    telegram::TLPollEngine::RequestBodyMode getRequestBodyMode(const std::string& name)
+    {
+        using Mode = telegram::TLPollEngine::RequestBodyMode;
+
+        if (name == "query")
+            return Mode::QueryString;
+
+        if (name == "form")
+            return Mode::FormUrlEncoded;
+
+        if (name == "json")
+            return Mode::Json;
+
+        throw std::invalid_argument(fmt::format("unknown request body mode {}", name));
+    }
+
+    Parameters parseParameters(int argc, char** argv)
+    {
+        Parameters parameters {};
+
+        for (int argument = 1; argument < argc; ++argument)
+        {
+            const std::string option = argv[argument];
+            const auto value = [&argument, argc, argv, &option]() -> std::string {
+                if (argument + 1 >= argc)
+                    throw std::invalid_argument(fmt::format("option {} requires value", option));
+
+                return argv[++argument];
+            };
+
+            if (option == "--updates")
+                parameters.updates = std::stoull(value());
+            else if (option == "--rate")
+                parameters.rate = std::stod(value());
+            else if (option == "--batch")
+                parameters.batch = static_cast<uint32_t>(std::stoul(value()));
+            else if (option == "--handler-us")
+                parameters.handlerCost = std::stoll(value());
+            else if (option == "--delay-ms")
+                parameters.networkDelay = std::stoll(value());
+            else if (option == "--concurrency")
+                parameters.concurrency = std::stoull(value());
+            else if (option == "--chats")
+                parameters.chats = std::max<size_t>(std::stoull(value()), 1);
+            else if (option == "--body")
+            {
+                parameters.bodyMode = value();
+                getRequestBodyMode(parameters.bodyMode); // validate
+            }
+            else if (option == "--timeout")
+                parameters.timeout = std::stoll(value());
+            else if (option == "--gzip")
+                parameters.isCompressionEnabled = true;
+            else if (option == "--arena")
+                parameters.isArenaEnabled = true;
+            else if (option == "--pipeline")
+                parameters.isPipelineEnabled = true;
+            else if (option == "--parallel")
+                parameters.isParallelParsingEnabled = true;
+            else
+                throw std::invalid_argument(fmt::format("unknown option {}", option));
+        }
+
+        return parameters;
+    }
+
+    /**
+     * @class BenchmarkProcessor
+     * @brief ChatBotMessageProcessor with configurable cost of handler
+     */
+    class BenchmarkProcessor : public raptor::ChatBotMessageProcessor
+    {
+        const std::chrono::microseconds m_handlerCost;
+
+    public:
+        std::atomic<size_t> processedUpdates { 0 };
+
+        explicit BenchmarkProcessor(std::chrono::microseconds handlerCost)
+            : m_handlerCost(handlerCost)
+        {
+        }
+
+        void onBotCommands(const telegram::MessagePtr& message, const telegram::BotCommandsList& commands, const telegram::ServerPtr& server) override
+        {
+            const auto busyUntil = std::chrono::steady_clock::now() + m_handlerCost;
+            while (std::chrono::steady_clock::now() < busyUntil)
+            {
+                // emulate work of handler
+            }
+
+            ++processedUpdates;
+            raptor::ChatBotMessageProcessor::onBotCommands(message, commands, server);
+        }
+    };
+
+    /**
+     * @class LatencyRecorder
+     * @brief publish time of every update and latency of its reply
+     */
+    class LatencyRecorder
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::vector<Clock::time_point> m_publishedAt;
+        std::mutex m_lock {};
+        std::vector<double> m_latencies {};     ///< Milliseconds
+        Clock::time_point m_lastReplyAt {};
+
+    public:
+        explicit LatencyRecorder(size_t updatesCount)
+            : m_publishedAt(updatesCount + 2)
+        {
+            m_latencies.reserve(updatesCount);
+        }
+
+        void onPublished(int64_t updateId)
+        {
+            if (static_cast<size_t>(updateId) < m_publishedAt.size())
+                m_publishedAt[updateId] = Clock::now();
+        }
+
+        void onReply(const mock::RecordedRequest& request)
+        {
+            // reply text is 'Unknown command "/u<update_id>".'
+            const std::string text = request.parameters.value("text", std::string());
+            const size_t idBegin = text.find("/u");
+            if (idBegin == std::string::npos)
+                return;
+
+            const auto updateId = static_cast<size_t>(std::strtoull(text.c_str() + idBegin + 2, nullptr, 10));
+            if (updateId >= m_publishedAt.size())
+                return;
+
+            std::lock_guard<std::mutex> guard { m_lock };
+
+            m_latencies.push_back(std::chrono::duration<double, std::milli>(request.receivedAt - m_publishedAt[updateId]).count());
+            m_lastReplyAt = request.receivedAt;
+        }
+
+        [[nodiscard]] Clock::time_point getLastReplyTime()
+        {
+            std::lock_guard<std::mutex> guard { m_lock };
+            return m_lastReplyAt;
+        }
+
+        /**
+         * @fn getPercentile
+         * @param fraction 0.5 for p50, 0.999 for p999
+         */
+        [[nodiscard]] double getPercentile(double fraction)
+        {
+            std::lock_guard<std::mutex> guard { m_lock };
+
+            if (m_latencies.empty())
+                return 0.0;
+
+            const size_t index = std::min(m_latencies.size() - 1, static_cast<size_t>(fraction * static_cast<double>(m_latencies.size())));
+            std::nth_element(m_latencies.begin(), m_latencies.begin() + static_cast<std::ptrdiff_t>(index), m_latencies.end());
+
+            return m_latencies[index];
+        }
+    };
+
+    nlohmann::json toJson(const LatencyHistogram::Snapshot& snapshot)
+    {
+        return {
+            { "count", snapshot.count },
+            { "mean", snapshot.mean },
+            { "p50", snapshot.p50 },
+            { "p99", snapshot.p99 },
+            { "p999", snapshot.p999 },
+            { "max", snapshot.max }
+        };
+    }
+
+    /**
+     * @fn getStageLatencies
+     * @brief stage histograms of engine and request latencies per method (milliseconds)
+     */
+    nlohmann::json getStageLatencies(const telegram::ServerPtr& server)
+    {
+        const auto& metrics = server->getLatencyMetrics();
+
+        nlohmann::json stages = {
+            { "long_poll_wait", toJson(metrics.longPollWait.getSnapshot()) },
+            { "download", toJson(metrics.download.getSnapshot()) },
+            { "parse", toJson(metrics.parse.getSnapshot()) },
+            { "dispatch", toJson(metrics.dispatch.getSnapshot()) },
+            { "handler", toJson(metrics.handler.getSnapshot()) },
+            { "action_queue", toJson(metrics.actionQueue.getSnapshot()) }
+        };
+
+        for (const auto& [method, snapshot] : server->getMethodLatencies())
+            stages["methods"][method] = toJson(snapshot);
+
+        return stages;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace reactor;
+    using Clock = std::chrono::steady_clock;
+
+    bench::Parameters parameters {};
+
+    try
+    {
+        parameters = bench::parseParameters(argc, argv);
+    }
+    catch (const std::exception& error)
+    {
+        std::fprintf(stderr, "%s\n", error.what());
+        return EXIT_FAILURE;
+    }
+
+    spdlog::set_default_logger(spdlog::stderr_logger_mt("bench"));
+    spdlog::set_level(spdlog::level::warn);
+
+    mock::MockBotApiServer::Config mockConfig {};
+    mockConfig.maxLimit = parameters.batch;
+    mockConfig.isCompressionEnabled = parameters.isCompressionEnabled;
+    mockConfig.isRecordingEnabled = false;
+
+    mock::MockBotApiServer mockServer { mockConfig };
+    mockServer.setLatency("", std::chrono::milliseconds(parameters.networkDelay));
+
+    bench::LatencyRecorder latencies { parameters.updates };
+    mockServer.setRequestObserver([&latencies](const mock::RecordedRequest& request) {
+        if (request.method == telegram::TLAPI::sendMessage)
+            latencies.onReply(request);
+    });
+
+    mockServer.start();
+
+    const auto generator = [&latencies, &parameters](int64_t updateId) {
+        latencies.onPublished(updateId);
+        return mock::generators::commands(fmt::format("/u{}", updateId), parameters.chats)(updateId);
+    };
+
+    bench::BenchmarkProcessor processor { std::chrono::microseconds(parameters.handlerCost) };
+    auto server = std::make_shared<telegram::Server>("BENCH", &processor);
+
+    server->setApiBaseUrl(mockServer.getBaseUrl());
+    server->setRequestBodyMode(bench::getRequestBodyMode(parameters.bodyMode));
+    if (parameters.concurrency > 0)
+        server->setMaxConcurrentRequests(parameters.concurrency);
+
+    server->setArenaEnabled(parameters.isArenaEnabled);
+    server->setParallelParsingEnabled(parameters.isParallelParsingEnabled);
+    server->setPipelineEnabled(parameters.isPipelineEnabled);
+
+    telegram::TLPollEngine::PollConfig pollConfig {};
+    pollConfig.pinnedLimit = parameters.batch;
+    server->setPollControllerConfig(pollConfig);
+
+    std::thread serverThread { [&server]() { server->start(false); } };
+
+    // first long-poll is pending: bot is ready
+    mockServer.waitForRequests(telegram::TLAPI::getUpdates, 1, std::chrono::seconds(10));
+
+    const auto startedAt = Clock::now();
+
+    if (parameters.rate > 0.0)
+        mockServer.startGenerator(parameters.rate, generator);
+    else
+        mockServer.generateUpdates(parameters.updates, generator);
+
+    const bool isCompleted = mockServer.waitForRequests(telegram::TLAPI::sendMessage, parameters.updates, std::chrono::seconds(parameters.timeout));
+
+    mockServer.stopGenerator();
+    server->stop();
+    mockServer.stop(); // release pending long-poll
+    serverThread.join();
+
+    const size_t replies = mockServer.getRequestsCount(telegram::TLAPI::sendMessage);
+    const double elapsed = std::chrono::duration<double>((replies > 0 ? latencies.getLastReplyTime() : Clock::now()) - startedAt).count();
+    const auto& transport = server->getTransportStatistics();
+
+    const nlohmann::json report = {
+        { "benchmark", "EndToEndBenchmark" },
+        { "parameters", {
+            { "updates", parameters.updates },
+            { "rate", parameters.rate },
+            { "batch", parameters.batch },
+            { "handler_us", parameters.handlerCost },
+            { "delay_ms", parameters.networkDelay },
+            { "concurrency", parameters.concurrency },
+            { "chats", parameters.chats },
+            { "body", parameters.bodyMode },
+            { "gzip", parameters.isCompressionEnabled },
+            { "arena", parameters.isArenaEnabled },
+            { "pipeline", parameters.isPipelineEnabled },
+            { "parallel", parameters.isParallelParsingEnabled }
+        } },
+        { "results", {
+            { "completed", isCompleted },
+            { "processed_updates", processor.processedUpdates.load() },
+            { "replies", replies },
+            { "elapsed_s", elapsed },
+            { "updates_per_s", static_cast<double>(processor.processedUpdates.load()) / elapsed },
+            { "sends_per_s", static_cast<double>(replies) / elapsed },
+            { "latency_ms", {
+                { "p50", latencies.getPercentile(0.5) },
+                { "p99", latencies.getPercentile(0.99) },
+                { "p999", latencies.getPercentile(0.999) },
+                { "max", latencies.getPercentile(1.0) }
+            } },
+            { "get_updates_requests", mockServer.getRequestsCount(telegram::TLAPI::getUpdates) },
+            { "failed_requests", transport.failedRequests },
+            { "wire_bytes", transport.wireBytes },
+            { "stages_ms", bench::getStageLatencies(server) }
+        } }
+    };
+
+    std::printf("%s\n", report.dump().c_str());
+    return isCompleted ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,105 @@
+/**
+ * @brief ReplayBenchmark - deserialization of recorded getUpdates responses on poll thread and on parsing pool.
+ *        Every response is replayed through TLPollEngine::replayBatch (arena enabled), time per update is printed
+ *        for serial parsing and for every size of pool up to TLPollEngine::DefaultParsingThreadsCount().
+ *
+ * Usage: ReplayBenchmark [iterations] [response.json ...]
+ *        Without files synthetic batches of 256 updates (TLPollEngine::UpdatesLimit) are replayed.
+ */
+#include <TelegramBot.h>
+#include "BenchCorpus.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace reactor::bench {
+
+    std::vector<std::string> loadBatches(int argc, char** argv)
+    {
+        std::vector<std::string> batches {};
+
+        for (int argument = 2; argument < argc; ++argument)
+        {
+            std::ifstream file { argv[argument], std::ios::binary };
+            if (!file)
+                throw std::runtime_error(fmt::format("[ReplayBenchmark] unable to open {}", argv[argument]));
+
+            std::stringstream content {};
+            content << file.rdbuf();
+            batches.push_back(content.str());
+        }
+
+        if (batches.empty())
+        {
+            static constexpr size_t SyntheticBatchesCount = 4;
+            static constexpr size_t UpdatesPerBatch = 256;
+
+            for (size_t batch = 0; batch < SyntheticBatchesCount; ++batch)
+                batches.push_back(makeCorpus(UpdatesPerBatch, batch * UpdatesPerBatch));
+        }
+
+        return batches;
+    }
+
+    /**
+     * @fn replay
+     * @return time per update in nanoseconds
+     */
+    double replay(telegram::TLPollEngine& engine, const std::vector<std::string>& batches, size_t iterations, size_t& updatesCount)
+    {
+        const auto replayAll = [&engine, &batches, &updatesCount]() {
+            for (const auto& batch : batches)
+            {
+                engine.replayBatch(batch, [&updatesCount](const telegram::UpdatesList& updates) {
+                    updatesCount += updates.size();
+                });
+            }
+        };
+
+        replayAll(); // warm up (arenas grow to size of batch)
+        updatesCount = 0;
+
+        const auto startedAt = std::chrono::steady_clock::now();
+
+        for (size_t iteration = 0; iteration < iterations; ++iteration)
+            replayAll();
+
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startedAt).count();
+        return updatesCount > 0 ? elapsed / static_cast<double>(updatesCount) : 0.0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace reactor;
+
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto batches = bench::loadBatches(argc, argv);
+    const size_t maxWorkers = telegram::TLPollEngine::DefaultParsingThreadsCount();
+
+    telegram::TLPollEngine engine { "BENCH", {} };
+    engine.setArenaEnabled(true);
+
+    size_t updatesCount = 0;
+    const double serialTime = bench::replay(engine, batches, iterations, updatesCount);
+
+    std::printf("%-16s %10.1f ns/update %6.2fx (%zu updates)\n", "serial", serialTime, 1.0, updatesCount);
+
+    for (size_t workers = 1; workers <= maxWorkers; ++workers)
+    {
+        engine.setParallelParsingEnabled(true, workers, 0);
+
+        const double parallelTime = bench::replay(engine, batches, iterations, updatesCount);
+        const auto stageName = fmt::format("workers={}", workers); // poll thread parses too
+
+        std::printf("%-16s %10.1f ns/update %6.2fx (%zu updates)\n", stageName.c_str(), parallelTime, serialTime / parallelTime, updatesCount);
+    }
+
+    return EXIT_SUCCESS;
+}
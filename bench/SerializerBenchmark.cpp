@@ -0,0 +1,203 @@
+/**
+ * @brief SerializerBenchmark - cost of generated adl_serializer specializations and of command extraction (Server::processUpdate)
+ *        on payloads shaped like recorded group traffic: plain text, heavy entities, nested reply, sticker and join event.
+ *        For every payload kind stages are measured separately:
+ *          json          - nlohmann::json DOM of update
+ *          UpdatePtr     - adl_serializer<UpdatePtr> on parsed DOM, objects on heap
+ *          UpdatePtr/arena - same inside of batch arena (TLMemoryScope)
+ *          MessagePtr    - adl_serializer<MessagePtr> on message object
+ *          dispatch      - Server::onUpdates: command extraction and handler call
+ *        VideoPtr and ChatMemberPtr are measured on their own payloads.
+ *        Prints time, heap allocations and allocated bytes per update (per object for standalone types).
+ *
+ * Usage: SerializerBenchmark [iterations] [response.json ...]
+ *        Recorded getUpdates responses passed as files are measured as extra payload kinds.
+ */
+#include <TelegramBot.h>
+#include "BenchCorpus.h"
+#include "BenchAllocations.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace reactor::bench {
+
+    class CommandsProcessor : public telegram::ITelergamMessageProcessor
+    {
+    public:
+        size_t messagesCount { 0 };
+        size_t commandsCount { 0 };
+        size_t commandBytes { 0 };
+
+        void onMessage(const telegram::MessagePtr&, const telegram::ServerPtr&) override
+        {
+            ++messagesCount;
+        }
+
+        void onBotCommands(const telegram::MessagePtr&, const telegram::BotCommandsList& commands, const telegram::ServerPtr&) override
+        {
+            ++messagesCount;
+            commandsCount += commands.size();
+
+            for (const auto& command : commands)
+                commandBytes += command.command.size();
+        }
+    };
+
+    /**
+     * @struct Payload
+     * @brief batch of updates of one kind: text of getUpdates response and its DOM
+     */
+    struct Payload
+    {
+        std::string name;
+        std::string response;
+        nlohmann::json updates;
+        size_t updatesCount { 0 };
+
+        Payload(std::string payloadName, std::string responseText)
+            : name(std::move(payloadName))
+            , response(std::move(responseText))
+            , updates(nlohmann::json::parse(response)["result"])
+            , updatesCount(updates.size())
+        {
+        }
+    };
+
+    std::vector<Payload> loadPayloads(int argc, char** argv, size_t updatesPerBatch)
+    {
+        std::vector<Payload> payloads {};
+
+        for (const PayloadKind kind : PayloadKinds)
+            payloads.emplace_back(getPayloadName(kind), makeCorpus(kind, updatesPerBatch));
+
+        for (int argument = 2; argument < argc; ++argument)
+        {
+            std::ifstream file { argv[argument], std::ios::binary };
+            if (!file)
+                throw std::runtime_error(fmt::format("[SerializerBenchmark] unable to open {}", argv[argument]));
+
+            std::stringstream content {};
+            content << file.rdbuf();
+            payloads.emplace_back(fmt::format("recorded:{}", argument - 1), content.str());
+        }
+
+        return payloads;
+    }
+
+    volatile size_t g_sink = 0; ///< Results of stages are stored here, so parsing could not be elided
+
+    template <typename _Fn>
+    void measure(const std::string& payloadName, const char* stageName, size_t iterations, size_t objectsPerIteration, _Fn&& stage)
+    {
+        if (objectsPerIteration == 0)
+            return;
+
+        stage(); // warm up
+
+        const auto allocationsBefore = AllocationsSnapshot::now();
+        const auto startedAt = std::chrono::steady_clock::now();
+
+        for (size_t iteration = 0; iteration < iterations; ++iteration)
+            stage();
+
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - startedAt).count();
+        const auto allocations = AllocationsSnapshot::now() - allocationsBefore;
+        const double objectsCount = static_cast<double>(iterations * objectsPerIteration);
+
+        std::printf("%-16s %-16s %10.1f ns/update %8.2f allocations/update %10.1f bytes/update\n", payloadName.c_str(), stageName,
+                    elapsed / objectsCount, static_cast<double>(allocations.allocations) / objectsCount,
+                    static_cast<double>(allocations.bytes) / objectsCount);
+    }
+
+    template <typename _Ptr>
+    void deserialize(const nlohmann::json& element)
+    {
+        _Ptr object = nullptr;
+        nlohmann::adl_serializer<_Ptr>::from_json(element, object);
+    }
+
+    telegram::UpdatesList parse(const nlohmann::json& updates)
+    {
+        telegram::UpdatesList result { telegram::TLMemoryScope::getResource() };
+        result.reserve(updates.size());
+
+        for (const auto& element : updates)
+        {
+            telegram::UpdatePtr update = nullptr;
+            nlohmann::adl_serializer<telegram::UpdatePtr>::from_json(element, update);
+            result.push_back(std::move(update));
+        }
+
+        return result;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace reactor;
+
+    const size_t iterations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    static constexpr size_t UpdatesPerBatch = 64;
+    static constexpr size_t ArenaSize = 4 * 1024 * 1024;
+
+    spdlog::set_level(spdlog::level::warn);
+
+    const auto payloads = bench::loadPayloads(argc, argv, UpdatesPerBatch);
+
+    bench::CommandsProcessor processor {};
+    auto server = std::make_shared<telegram::Server>("BENCH", &processor);
+
+    std::vector<std::byte> arenaBuffer(ArenaSize);
+    std::pmr::monotonic_buffer_resource arena { arenaBuffer.data(), arenaBuffer.size() };
+
+    for (const auto& payload : payloads)
+    {
+        bench::measure(payload.name, "json", iterations, payload.updatesCount, [&payload]() {
+            bench::g_sink = nlohmann::json::parse(payload.response).size();
+        });
+
+        bench::measure(payload.name, "UpdatePtr", iterations, payload.updatesCount, [&payload]() {
+            for (const auto& element : payload.updates)
+                bench::deserialize<telegram::UpdatePtr>(element);
+        });
+
+        bench::measure(payload.name, "UpdatePtr/arena", iterations, payload.updatesCount, [&payload, &arena]() {
+            {
+                telegram::TLMemoryScope memoryScope { &arena };
+                bench::parse(payload.updates);
+            }
+
+            arena.release();
+        });
+
+        bench::measure(payload.name, "MessagePtr", iterations, payload.updatesCount, [&payload]() {
+            for (const auto& element : payload.updates)
+            {
+                if (const auto message = element.find("message"); message != element.end())
+                    bench::deserialize<telegram::MessagePtr>(*message);
+            }
+        });
+
+        const auto updates = bench::parse(payload.updates);
+        bench::measure(payload.name, "dispatch", iterations, payload.updatesCount, [&server, &updates]() {
+            server->onUpdates(updates);
+        });
+    }
+
+    const auto video = nlohmann::json::parse(bench::makeVideoPayload());
+    bench::measure("video", "VideoPtr", iterations * UpdatesPerBatch, 1, [&video]() {
+        bench::deserialize<telegram::VideoPtr>(video);
+    });
+
+    const auto chatMember = nlohmann::json::parse(bench::makeChatMemberPayload());
+    bench::measure("chat_member", "ChatMemberPtr", iterations * UpdatesPerBatch, 1, [&chatMember]() {
+        bench::deserialize<telegram::ChatMemberPtr>(chatMember);
+    });
+
+    std::printf("processed %zu messages, %zu commands (%zu bytes)\n", processor.messagesCount, processor.commandsCount, processor.commandBytes);
+    return EXIT_SUCCESS;
+}
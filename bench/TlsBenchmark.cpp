@@ -0,0 +1,296 @@
+/**
+ * @brief TlsBenchmark - cost of TLS connection establishment against local stand-in of API host.
+ *        Stand-in is TLS server on 127.0.0.1 with self-signed certificate for localhost, every request opens new connection.
+ *        Modes:
+ *          insecure         - previous transport: no verification, CA bundle parsed by cURL anyway, full handshakes
+ *          verified         - peer verification with CA bundle parsed by cURL on every handshake
+ *          verified+store   - peer verification with process-wide store (cURLRuntime default)
+ *          verified+resumed - as above, TLS sessions are resumed through share object (cURLRuntime default)
+ *
+ * Usage: TlsBenchmark [requests]
+ */
+#include <TelegramBot.h>
+
+#include <openssl/ec.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+
+namespace reactor::bench {
+
+    /**
+     * @class TlsStandIn
+     * @brief minimal HTTPS server: one connection at a time, every request is answered with {"ok":true} and connection is closed
+     */
+    class TlsStandIn
+    {
+        EVP_PKEY* m_key { nullptr };
+        X509* m_certificate { nullptr };
+        SSL_CTX* m_context { nullptr };
+        int m_socket { -1 };
+        uint16_t m_port { 0 };
+        std::thread m_thread {};
+        std::atomic<bool> m_isDead { false };
+        std::atomic<size_t> m_handshakes { 0 };
+        std::atomic<size_t> m_resumedHandshakes { 0 };
+
+    public:
+        TlsStandIn()
+        {
+            createCertificate();
+
+            m_context = SSL_CTX_new(TLS_server_method());
+            SSL_CTX_use_certificate(m_context, m_certificate);
+            SSL_CTX_use_PrivateKey(m_context, m_key);
+
+            m_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+
+            const int reuse = 1;
+            ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = 0;
+
+            if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(m_socket, 16) != 0)
+                throw std::runtime_error("[TlsStandIn] unable to listen on loopback");
+
+            socklen_t addressSize = sizeof(address);
+            ::getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &addressSize);
+            m_port = ntohs(address.sin_port);
+
+            m_thread = std::thread { &TlsStandIn::serverProcedure, this };
+        }
+
+        ~TlsStandIn()
+        {
+            m_isDead = true;
+            ::shutdown(m_socket, SHUT_RDWR);
+            ::close(m_socket);
+            m_thread.join();
+
+            SSL_CTX_free(m_context);
+            X509_free(m_certificate);
+            EVP_PKEY_free(m_key);
+        }
+
+        [[nodiscard]] std::string getUrl() const { return fmt::format("https://localhost:{}/", m_port); }
+        [[nodiscard]] size_t getHandshakesCount() const { return m_handshakes; }
+        [[nodiscard]] size_t getResumedHandshakesCount() const { return m_resumedHandshakes; }
+
+        void resetCounters()
+        {
+            m_handshakes = 0;
+            m_resumedHandshakes = 0;
+        }
+
+        /**
+         * @fn writeCertificate
+         * @brief store certificate of stand-in (as PEM) into file
+         */
+        void writeCertificate(std::FILE* file) const
+        {
+            PEM_write_X509(file, m_certificate);
+        }
+
+    private:
+        void createCertificate()
+        {
+            m_key = EVP_EC_gen("P-256");
+            m_certificate = X509_new();
+
+            X509_set_version(m_certificate, 2);
+            ASN1_INTEGER_set(X509_get_serialNumber(m_certificate), 1);
+            X509_gmtime_adj(X509_getm_notBefore(m_certificate), -60);
+            X509_gmtime_adj(X509_getm_notAfter(m_certificate), 24 * 60 * 60);
+            X509_set_pubkey(m_certificate, m_key);
+
+            X509_NAME* name = X509_get_subject_name(m_certificate);
+            X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+            X509_set_issuer_name(m_certificate, name);
+
+            X509V3_CTX extensionContext {};
+            X509V3_set_ctx(&extensionContext, m_certificate, m_certificate, nullptr, nullptr, 0);
+
+            const std::pair<int, const char*> extensions[] = {
+                { NID_basic_constraints, "critical,CA:TRUE" },
+                { NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1" }
+            };
+
+            for (const auto& [nid, value] : extensions)
+            {
+                X509_EXTENSION* extension = X509V3_EXT_conf_nid(nullptr, &extensionContext, nid, value);
+                X509_add_ext(m_certificate, extension, -1);
+                X509_EXTENSION_free(extension);
+            }
+
+            X509_sign(m_certificate, m_key, EVP_sha256());
+        }
+
+        void serverProcedure()
+        {
+            static constexpr std::string_view Response = "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: 11\r\nConnection: close\r\n\r\n{\"ok\":true}";
+
+            while (!m_isDead)
+            {
+                const int client = ::accept(m_socket, nullptr, nullptr);
+                if (client < 0)
+                    continue;
+
+                SSL* connection = SSL_new(m_context);
+                SSL_set_fd(connection, client);
+
+                if (SSL_accept(connection) == 1)
+                {
+                    ++m_handshakes;
+                    m_resumedHandshakes += SSL_session_reused(connection) ? 1 : 0;
+
+                    std::string request {};
+                    char chunk[1024];
+
+                    while (request.find("\r\n\r\n") == std::string::npos)
+                    {
+                        const int received = SSL_read(connection, chunk, sizeof(chunk));
+                        if (received <= 0)
+                            break;
+
+                        request.append(chunk, static_cast<size_t>(received));
+                    }
+
+                    SSL_write(connection, Response.data(), static_cast<int>(Response.size()));
+                    SSL_shutdown(connection);
+                }
+
+                SSL_free(connection);
+                ::close(client);
+            }
+        }
+    };
+
+    enum class Mode { Insecure, Verified, VerifiedWithStore, VerifiedWithResumption };
+
+    size_t discard(char*, size_t size, size_t nmemb, void*)
+    {
+        return size * nmemb;
+    }
+
+    /**
+     * @fn measure
+     * @return average time of request (new connection) in microseconds
+     */
+    double measure(Mode mode, const std::string& url, const std::string& caFile, size_t requests)
+    {
+        auto& runtime = telegram::TLPollEngine::Runtime::getInstance();
+        double elapsed = 0.0;
+
+        for (size_t request = 0; request <= requests; ++request)
+        {
+            CURL* handle = runtime.acquireHandle();
+
+            curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+            curl_easy_setopt(handle, CURLOPT_NOPROXY, "*");
+            curl_easy_setopt(handle, CURLOPT_FRESH_CONNECT, 1L);
+            curl_easy_setopt(handle, CURLOPT_FORBID_REUSE, 1L);
+            curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, discard);
+
+            switch (mode)
+            {
+                case Mode::Insecure:
+                    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+                    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+                    [[fallthrough]];
+                case Mode::Verified:
+                    curl_easy_setopt(handle, CURLOPT_SSL_CTX_FUNCTION, nullptr);
+                    curl_easy_setopt(handle, CURLOPT_CAINFO, caFile.c_str());
+                    [[fallthrough]];
+                case Mode::VerifiedWithStore:
+                    curl_easy_setopt(handle, CURLOPT_SSL_SESSIONID_CACHE, 0L);
+                    break;
+                case Mode::VerifiedWithResumption:
+                    break;
+            }
+
+            const auto startedAt = std::chrono::steady_clock::now();
+            const CURLcode result = curl_easy_perform(handle);
+            const auto duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startedAt).count();
+
+            runtime.releaseHandle(handle);
+
+            if (result != CURLE_OK)
+                throw std::runtime_error(fmt::format("[TlsBenchmark] request failed: {}", curl_easy_strerror(result)));
+
+            if (request > 0) // first request warms up (and creates TLS session for resumption)
+                elapsed += duration;
+        }
+
+        return elapsed / static_cast<double>(requests);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace reactor;
+
+    const size_t requests = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200;
+
+    spdlog::set_level(spdlog::level::warn);
+
+    bench::TlsStandIn standIn {};
+
+    // system authorities and stand-in: verification costs as much as with real API host
+    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+    const auto caFile = (std::filesystem::temp_directory_path() / fmt::format("TlsBenchmark.{}.pem", ::getpid())).string();
+
+    {
+        std::ifstream systemBundle { info->cainfo ? info->cainfo : "" };
+        std::stringstream content {};
+        content << systemBundle.rdbuf();
+
+        std::FILE* file = std::fopen(caFile.c_str(), "w");
+        std::fputs(content.str().c_str(), file);
+        standIn.writeCertificate(file);
+        std::fclose(file);
+    }
+
+    auto& runtime = telegram::TLPollEngine::Runtime::getInstance();
+    runtime.setCertificateAuthorities(caFile);
+
+    if (!runtime.isSharedTrustStore())
+        std::printf("TLS backend is not OpenSSL (%s): shared store is not used\n", info->ssl_version);
+
+    const std::pair<bench::Mode, const char*> modes[] = {
+        { bench::Mode::Insecure, "insecure" },
+        { bench::Mode::Verified, "verified" },
+        { bench::Mode::VerifiedWithStore, "verified+store" },
+        { bench::Mode::VerifiedWithResumption, "verified+resumed" }
+    };
+
+    double baseline = 0.0;
+
+    for (const auto& [mode, modeName] : modes)
+    {
+        standIn.resetCounters();
+
+        const double requestTime = bench::measure(mode, standIn.getUrl(), caFile, requests);
+        if (mode == bench::Mode::Insecure)
+            baseline = requestTime;
+
+        std::printf("%-18s %10.1f us/connection %6.2fx (%zu handshakes, %zu resumed)\n", modeName, requestTime, baseline / requestTime,
+                    standIn.getHandshakesCount(), standIn.getResumedHandshakesCount());
+    }
+
+    std::filesystem::remove(caFile);
+    return EXIT_SUCCESS;
+}
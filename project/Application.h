@@ -8,9 +8,12 @@ namespace reactor {
     {
         std::string m_telegramToken;
         std::string m_telegramProxy;
+        std::string m_telegramApiUrl;   ///< Empty for api.telegram.org
 
     public:
+        Application(std::string telegramToken, std::string telegramProxy, std::string telegramApiUrl);
+
         int run();
     };
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <TelegramBot.h>
+
+namespace reactor {
+    namespace raptor {
+#define BOT_CALLBACK(method) std::bind(&ChatBotMessageProcessor::method, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)
+
+        class ChatBotMessageProcessor : public telegram::ITelergamMessageProcessor {
+
+            using BotCommandFunction = std::function<void(const telegram::MessagePtr&, const telegram::BotCommand&, const telegram::ServerPtr&)>;
+
+            std::unordered_map<std::string, BotCommandFunction> m_commandRoutes;
+
+        public:
+            ChatBotMessageProcessor()
+                : m_commandRoutes({
+                                          { "/status", BOT_CALLBACK(onStatusRequest) },
+                                          { "/auth", BOT_CALLBACK(onAuthorizationRequest) },
+                                          { "/get_video", BOT_CALLBACK(onVideoRequest) }
+                                  })
+            {
+            }
+
+            void onMessage(const telegram::MessagePtr& message, const telegram::ServerPtr& server) override
+            {
+            }
+
+            void onBotCommands(const telegram::MessagePtr& message, const telegram::BotCommandsList& commands, const telegram::ServerPtr& server) override
+            {
+                if (!message->from.has_value())
+                    return;
+
+                for (const auto& command : commands)
+                {
+                    auto iter = m_commandRoutes.find(command.command);
+                    if (iter == std::end(m_commandRoutes))
+                    {
+                        onBadCommand(message, command, server);
+                    }
+                    else
+                    {
+                        iter->second(message, command, server);
+                    }
+                }
+            }
+
+            void onMessageEdited(const telegram::MessagePtr& message, const telegram::ServerPtr& server) override
+            {
+                server->replyMessage(message->chat, message, "Я не буду обрабатывать это обновление!");
+            }
+
+        private:
+            void onBadCommand(const telegram::MessagePtr& message, const telegram::BotCommand& command, const telegram::ServerPtr& server)
+            {
+                server->sendMessage(message->chat, fmt::format("Unknown command \"{}\".", command.command));
+            }
+
+            void onStatusRequest(const telegram::MessagePtr& message, const telegram::BotCommand& command, const telegram::ServerPtr& server)
+            {
+                /**
+                 * @todo implement it
+                 */
+            }
+
+            void onAuthorizationRequest(const telegram::MessagePtr& message, const telegram::BotCommand& command, const telegram::ServerPtr& server)
+            {
+                /**
+                 * @todo implement it
+                 */
+            }
+
+            void onVideoRequest(const telegram::MessagePtr& message, const telegram::BotCommand& command, const telegram::ServerPtr& server)
+            {
+                /**
+                 * @todo implement it
+                 */
+            }
+        };
+#undef BOT_CALLBACK
+    }
+}
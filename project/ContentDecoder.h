@@ -0,0 +1,130 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <cstddef>
+#include <stdexcept>
+
+#include <zlib.h>
+
+namespace reactor {
+
+    /**
+     * @class ContentDecoder
+     * @brief Streaming inflate of HTTP bodies with Content-Encoding gzip or deflate.
+     *        Input is consumed chunk by chunk as it arrives from network, output is passed to sink in pieces of ChunkSize,
+     *        so compressed body is never stored as a whole. Decoder is reusable: reset() keeps zlib state allocated.
+     */
+    class ContentDecoder
+    {
+        static constexpr size_t ChunkSize = 16 * 1024;
+
+        z_stream m_stream {};
+        bool m_isInitialized { false };
+        bool m_isRawDeflate { false };      ///< Some servers send "deflate" without zlib header
+        bool m_isFinished { false };
+        size_t m_inputBytes { 0 };
+        size_t m_outputBytes { 0 };
+        std::chrono::nanoseconds m_decodingTime { 0 };
+        unsigned char m_chunk[ChunkSize];
+
+    public:
+        ContentDecoder() = default;
+
+        ContentDecoder(const ContentDecoder&) = delete;
+        ContentDecoder& operator=(const ContentDecoder&) = delete;
+
+        ~ContentDecoder()
+        {
+            if (m_isInitialized)
+                inflateEnd(&m_stream);
+        }
+
+        /**
+         * @fn reset
+         * @brief prepare decoder for next body (gzip and zlib formats are detected by header)
+         */
+        void reset()
+        {
+            const bool isReusable = m_isInitialized && !m_isRawDeflate;
+
+            m_isRawDeflate = false;
+            m_isFinished = false;
+            m_inputBytes = 0;
+            m_outputBytes = 0;
+            m_decodingTime = std::chrono::nanoseconds { 0 };
+
+            if (isReusable)
+                inflateReset(&m_stream); // window and state are kept
+            else
+                initialize();
+        }
+
+        /**
+         * @fn decode
+         * @brief inflate next piece of body, sink is called as sink(const char* data, size_t size)
+         * @throws std::runtime_error when body is corrupted
+         */
+        template <typename _Sink>
+        void decode(const char* data, size_t size, _Sink&& sink)
+        {
+            const bool isFirstPiece = m_inputBytes == 0;
+
+            m_inputBytes += size;
+            m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            m_stream.avail_in = static_cast<uInt>(size);
+
+            while (m_stream.avail_in > 0 && !m_isFinished)
+            {
+                m_stream.next_out = m_chunk;
+                m_stream.avail_out = ChunkSize;
+
+                const auto startedAt = std::chrono::steady_clock::now();
+                const int result = inflate(&m_stream, Z_NO_FLUSH);
+                m_decodingTime += std::chrono::steady_clock::now() - startedAt; // time of sink is not counted
+
+                if (result == Z_DATA_ERROR && isFirstPiece && !m_isRawDeflate && m_outputBytes == 0)
+                {
+                    // "deflate" without zlib header: restart body as raw stream
+                    m_isRawDeflate = true;
+                    initialize();
+
+                    m_stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+                    m_stream.avail_in = static_cast<uInt>(size);
+                    continue;
+                }
+
+                if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+                    throw std::runtime_error(std::string("[ContentDecoder::decode] corrupted body: ") + (m_stream.msg ? m_stream.msg : "unknown error"));
+
+                const size_t producedBytes = ChunkSize - m_stream.avail_out;
+                m_outputBytes += producedBytes;
+                m_isFinished = result == Z_STREAM_END;
+
+                if (producedBytes > 0)
+                    sink(reinterpret_cast<const char*>(m_chunk), producedBytes);
+                else if (result == Z_BUF_ERROR)
+                    break;
+            }
+        }
+
+        [[nodiscard]] size_t getInputBytes() const { return m_inputBytes; }
+        [[nodiscard]] size_t getOutputBytes() const { return m_outputBytes; }
+        [[nodiscard]] std::chrono::nanoseconds getDecodingTime() const { return m_decodingTime; }
+
+    private:
+        void initialize()
+        {
+            const int windowBits = m_isRawDeflate ? -MAX_WBITS : MAX_WBITS + 32; // +32: detect gzip or zlib header
+
+            if (m_isInitialized)
+                inflateEnd(&m_stream);
+
+            m_stream = z_stream {};
+            m_isInitialized = inflateInit2(&m_stream, windowBits) == Z_OK;
+
+            if (!m_isInitialized)
+                throw std::runtime_error("[ContentDecoder::initialize] unable to initialize zlib");
+        }
+    };
+}
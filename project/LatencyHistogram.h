@@ -0,0 +1,197 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+namespace reactor {
+
+    /**
+     * @class LatencyHistogram
+     * @brief HDR-style histogram of durations with microsecond resolution.
+     *        Values below 2^SubBucketBits are counted exactly, every next power of two is split into 2^(SubBucketBits - 1)
+     *        linear buckets, so reported value differs from recorded one by less than 6.25% over whole range (values above ~71 minutes are clamped).
+     *        Recording is lock free (few relaxed atomic increments): histogram is recorded on any thread and read at runtime from others.
+     */
+    class LatencyHistogram
+    {
+        static constexpr uint32_t SubBucketBits = 5;
+        static constexpr uint64_t SubBucketsCount = 1ull << SubBucketBits;      ///< Values with exact buckets
+        static constexpr uint64_t HalfSubBucketsCount = SubBucketsCount / 2;    ///< Buckets per power of two above exact range
+        static constexpr uint32_t MaxValueBits = 32;
+        static constexpr uint64_t MaxValue = (1ull << MaxValueBits) - 1;
+        static constexpr size_t BucketsCount = SubBucketsCount + (MaxValueBits - SubBucketBits) * HalfSubBucketsCount;
+
+        std::array<std::atomic<uint64_t>, BucketsCount> m_buckets {};
+        std::atomic<uint64_t> m_count { 0 };
+        std::atomic<uint64_t> m_sum { 0 };
+        std::atomic<uint64_t> m_max { 0 };
+
+    public:
+        /**
+         * @struct Snapshot
+         * @brief summary of histogram in milliseconds
+         */
+        struct Snapshot
+        {
+            uint64_t count { 0 };
+            double mean { 0.0 };
+            double p50 { 0.0 };
+            double p90 { 0.0 };
+            double p99 { 0.0 };
+            double p999 { 0.0 };
+            double max { 0.0 };
+        };
+
+        /**
+         * @class ScopedTimer
+         * @brief records time of own scope into histogram (also when scope is left by exception)
+         */
+        class ScopedTimer
+        {
+            LatencyHistogram& m_histogram;
+            const std::chrono::steady_clock::time_point m_startedAt { std::chrono::steady_clock::now() };
+
+        public:
+            explicit ScopedTimer(LatencyHistogram& histogram)
+                : m_histogram(histogram)
+            {
+            }
+
+            ~ScopedTimer()
+            {
+                m_histogram.recordSince(m_startedAt);
+            }
+
+            ScopedTimer(const ScopedTimer&) = delete;
+            ScopedTimer& operator=(const ScopedTimer&) = delete;
+        };
+
+        LatencyHistogram() = default;
+
+        LatencyHistogram(const LatencyHistogram&) = delete;
+        LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+        template <typename _Rep, typename _Period>
+        void record(std::chrono::duration<_Rep, _Period> duration)
+        {
+            const auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+            recordValue(microseconds > 0 ? static_cast<uint64_t>(microseconds) : 0);
+        }
+
+        /**
+         * @fn recordSince
+         * @brief record time passed since startedAt
+         */
+        void recordSince(std::chrono::steady_clock::time_point startedAt)
+        {
+            record(std::chrono::steady_clock::now() - startedAt);
+        }
+
+        void recordValue(uint64_t microseconds)
+        {
+            const uint64_t value = std::min(microseconds, MaxValue);
+
+            m_buckets[getBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+            m_count.fetch_add(1, std::memory_order_relaxed);
+            m_sum.fetch_add(value, std::memory_order_relaxed);
+
+            uint64_t max = m_max.load(std::memory_order_relaxed);
+            while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+            {
+                // max is reloaded by compare_exchange_weak
+            }
+        }
+
+        [[nodiscard]] uint64_t getCount() const { return m_count.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::chrono::microseconds getMax() const { return std::chrono::microseconds(m_max.load(std::memory_order_relaxed)); }
+
+        [[nodiscard]] std::chrono::microseconds getMean() const
+        {
+            const uint64_t count = getCount();
+            return std::chrono::microseconds(count > 0 ? m_sum.load(std::memory_order_relaxed) / count : 0);
+        }
+
+        /**
+         * @fn getValueAtPercentile
+         * @param percentile 50.0 for median, 99.9 for p999
+         * @return highest value equivalent to bucket where percentile is reached (never above recorded maximum)
+         */
+        [[nodiscard]] std::chrono::microseconds getValueAtPercentile(double percentile) const
+        {
+            const uint64_t count = getCount();
+            if (count == 0)
+                return std::chrono::microseconds(0);
+
+            const auto rank = static_cast<uint64_t>(std::clamp(percentile, 0.0, 100.0) / 100.0 * static_cast<double>(count) + 0.5);
+            const uint64_t max = m_max.load(std::memory_order_relaxed);
+            uint64_t accumulated = 0;
+
+            for (size_t index = 0; index < BucketsCount; ++index)
+            {
+                accumulated += m_buckets[index].load(std::memory_order_relaxed);
+
+                if (accumulated >= std::max<uint64_t>(rank, 1))
+                    return std::chrono::microseconds(std::min(getBucketUpperBound(index), max));
+            }
+
+            return std::chrono::microseconds(max); // counters were updated while histogram was read
+        }
+
+        [[nodiscard]] Snapshot getSnapshot() const
+        {
+            const auto toMilliseconds = [](std::chrono::microseconds value) {
+                return std::chrono::duration<double, std::milli>(value).count();
+            };
+
+            Snapshot snapshot {};
+            snapshot.count = getCount();
+            snapshot.mean = toMilliseconds(getMean());
+            snapshot.p50 = toMilliseconds(getValueAtPercentile(50.0));
+            snapshot.p90 = toMilliseconds(getValueAtPercentile(90.0));
+            snapshot.p99 = toMilliseconds(getValueAtPercentile(99.0));
+            snapshot.p999 = toMilliseconds(getValueAtPercentile(99.9));
+            snapshot.max = toMilliseconds(getMax());
+
+            return snapshot;
+        }
+
+        void reset()
+        {
+            for (auto& bucket : m_buckets)
+                bucket.store(0, std::memory_order_relaxed);
+
+            m_count.store(0, std::memory_order_relaxed);
+            m_sum.store(0, std::memory_order_relaxed);
+            m_max.store(0, std::memory_order_relaxed);
+        }
+
+    private:
+        static size_t getBucketIndex(uint64_t value)
+        {
+            if (value < SubBucketsCount)
+                return static_cast<size_t>(value);
+
+            const uint32_t highestBit = 63u - static_cast<uint32_t>(__builtin_clzll(value));
+            const uint32_t shift = highestBit - (SubBucketBits - 1);
+            const uint64_t subBucket = (value >> shift) - HalfSubBucketsCount;
+
+            return static_cast<size_t>(SubBucketsCount + (shift - 1) * HalfSubBucketsCount + subBucket);
+        }
+
+        static uint64_t getBucketUpperBound(size_t index)
+        {
+            if (index < SubBucketsCount)
+                return index;
+
+            const uint64_t offset = index - SubBucketsCount;
+            const uint64_t shift = offset / HalfSubBucketsCount + 1;
+            const uint64_t subBucket = offset % HalfSubBucketsCount + HalfSubBucketsCount;
+
+            return ((subBucket + 1) << shift) - 1;
+        }
+    };
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <memory_resource>
+#include <initializer_list>
+
+namespace reactor {
+
+    /**
+     * @class SmallVector
+     * @brief Contiguous container which keeps first _InlineCapacity elements inside of object.
+     *        Only when container grows above that size elements are moved to memory of allocator
+     *        (std::pmr allocator, so spilled elements of TL objects are placed into batch arena too).
+     * @note Copy of container uses default memory resource (same as std::pmr containers do), moved container keeps allocator
+     */
+    template <typename _T, std::size_t _InlineCapacity>
+    class SmallVector
+    {
+    public:
+        using value_type = _T;
+        using size_type = std::size_t;
+        using difference_type = std::ptrdiff_t;
+        using reference = _T&;
+        using const_reference = const _T&;
+        using pointer = _T*;
+        using const_pointer = const _T*;
+        using iterator = _T*;
+        using const_iterator = const _T*;
+        using allocator_type = std::pmr::polymorphic_allocator<_T>;
+
+        static constexpr size_type InlineCapacity = _InlineCapacity;
+
+        SmallVector() noexcept = default;
+
+        explicit SmallVector(const allocator_type& allocator) noexcept
+            : m_allocator(allocator)
+        {
+        }
+
+        SmallVector(std::initializer_list<_T> items, const allocator_type& allocator = allocator_type {})
+            : m_allocator(allocator)
+        {
+            reserve(items.size());
+
+            for (const auto& item : items)
+                emplace_back(item);
+        }
+
+        SmallVector(const SmallVector& other)
+            : SmallVector(other, allocator_type {})
+        {
+        }
+
+        SmallVector(const SmallVector& other, const allocator_type& allocator)
+            : m_allocator(allocator)
+        {
+            reserve(other.m_size);
+
+            for (const auto& item : other)
+                emplace_back(item);
+        }
+
+        SmallVector(SmallVector&& other) noexcept(std::is_nothrow_move_constructible_v<_T>)
+            : m_allocator(other.m_allocator)
+        {
+            takeFrom(std::move(other));
+        }
+
+        ~SmallVector()
+        {
+            clear();
+            freeHeap();
+        }
+
+        SmallVector& operator=(const SmallVector& other)
+        {
+            if (this == &other)
+                return *this;
+
+            clear();
+            reserve(other.m_size);
+
+            for (const auto& item : other)
+                emplace_back(item);
+
+            return *this;
+        }
+
+        SmallVector& operator=(SmallVector&& other)
+        {
+            if (this == &other)
+                return *this;
+
+            clear();
+
+            if (m_allocator == other.m_allocator)
+            {
+                freeHeap();
+                takeFrom(std::move(other));
+                return *this;
+            }
+
+            // memory of other container can't be adopted, so elements are moved one by one
+            reserve(other.m_size);
+
+            for (auto& item : other)
+                emplace_back(std::move(item));
+
+            other.clear();
+            return *this;
+        }
+
+        iterator begin() noexcept { return m_data; }
+        iterator end() noexcept { return m_data + m_size; }
+        const_iterator begin() const noexcept { return m_data; }
+        const_iterator end() const noexcept { return m_data + m_size; }
+        const_iterator cbegin() const noexcept { return m_data; }
+        const_iterator cend() const noexcept { return m_data + m_size; }
+
+        [[nodiscard]] size_type size() const noexcept { return m_size; }
+        [[nodiscard]] size_type capacity() const noexcept { return m_capacity; }
+        [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+        [[nodiscard]] bool isInline() const noexcept { return m_data == inlineData(); }
+
+        pointer data() noexcept { return m_data; }
+        const_pointer data() const noexcept { return m_data; }
+
+        reference operator[](size_type index) { return m_data[index]; }
+        const_reference operator[](size_type index) const { return m_data[index]; }
+
+        reference at(size_type index)
+        {
+            if (index >= m_size)
+                throw std::out_of_range("[SmallVector] index out of range");
+
+            return m_data[index];
+        }
+
+        const_reference at(size_type index) const
+        {
+            if (index >= m_size)
+                throw std::out_of_range("[SmallVector] index out of range");
+
+            return m_data[index];
+        }
+
+        reference front() { return m_data[0]; }
+        const_reference front() const { return m_data[0]; }
+        reference back() { return m_data[m_size - 1]; }
+        const_reference back() const { return m_data[m_size - 1]; }
+
+        [[nodiscard]] allocator_type get_allocator() const noexcept { return m_allocator; }
+
+        void reserve(size_type capacity)
+        {
+            if (capacity <= m_capacity)
+                return;
+
+            _T* storage = m_allocator.allocate(capacity);
+
+            for (size_type index = 0; index < m_size; ++index)
+            {
+                ::new (static_cast<void*>(storage + index)) _T(std::move_if_noexcept(m_data[index]));
+                m_data[index].~_T();
+            }
+
+            freeHeap();
+
+            m_data = storage;
+            m_capacity = capacity;
+        }
+
+        template <typename... _Args>
+        reference emplace_back(_Args&&... args)
+        {
+            if (m_size == m_capacity)
+            {
+                // arguments could refer to element of this container, so item is created before storage is moved
+                _T value(std::forward<_Args>(args)...);
+                reserve(std::max<size_type>(m_capacity * 2, 4));
+
+                _T* item = ::new (static_cast<void*>(m_data + m_size)) _T(std::move(value));
+                ++m_size;
+
+                return *item;
+            }
+
+            _T* item = ::new (static_cast<void*>(m_data + m_size)) _T(std::forward<_Args>(args)...);
+            ++m_size;
+
+            return *item;
+        }
+
+        void push_back(const _T& item) { emplace_back(item); }
+        void push_back(_T&& item) { emplace_back(std::move(item)); }
+
+        void pop_back()
+        {
+            --m_size;
+            m_data[m_size].~_T();
+        }
+
+        void clear() noexcept
+        {
+            for (size_type index = 0; index < m_size; ++index)
+                m_data[index].~_T();
+
+            m_size = 0;
+        }
+
+    private:
+        _T* inlineData() noexcept { return reinterpret_cast<_T*>(m_inline); }
+        const _T* inlineData() const noexcept { return reinterpret_cast<const _T*>(m_inline); }
+
+        void freeHeap() noexcept
+        {
+            if (!isInline())
+                m_allocator.deallocate(m_data, m_capacity);
+
+            m_data = inlineData();
+            m_capacity = _InlineCapacity;
+        }
+
+        /**
+         * @fn takeFrom
+         * @brief adopt heap memory of other container (allocators must be equal) or move its inline elements
+         */
+        void takeFrom(SmallVector&& other)
+        {
+            if (other.isInline())
+            {
+                for (size_type index = 0; index < other.m_size; ++index)
+                    ::new (static_cast<void*>(m_data + index)) _T(std::move(other.m_data[index]));
+
+                m_size = other.m_size;
+                other.clear();
+                return;
+            }
+
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+
+            other.m_data = other.inlineData();
+            other.m_size = 0;
+            other.m_capacity = _InlineCapacity;
+        }
+
+    private:
+        alignas(_T) std::byte m_inline[sizeof(_T) * (_InlineCapacity > 0 ? _InlineCapacity : 1)];
+        _T* m_data { inlineData() };
+        size_type m_size { 0 };
+        size_type m_capacity { _InlineCapacity };
+        allocator_type m_allocator {};
+    };
+}
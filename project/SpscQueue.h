@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <cstddef>
+
+namespace reactor {
+
+    /**
+     * @class SpscQueue
+     * @brief Bounded lock-free ring for exactly one producer thread and one consumer thread.
+     *        Capacity is rounded up to power of two. Queue never blocks: tryPush fails when ring is full,
+     *        tryPop fails when ring is empty (waiting is up to owner).
+     * @note _T must be default constructible and movable, popped slot is reset to _T {} to free resources early
+     */
+    template <typename _T>
+    class SpscQueue
+    {
+        static constexpr size_t CacheLineSize = 64;
+
+        std::unique_ptr<_T[]> m_slots;
+        const size_t m_capacity;
+        const size_t m_mask;
+
+        alignas(CacheLineSize) std::atomic<size_t> m_head { 0 };   ///< Next slot to pop (owned by consumer)
+        alignas(CacheLineSize) std::atomic<size_t> m_tail { 0 };   ///< Next slot to push (owned by producer)
+
+    public:
+        explicit SpscQueue(size_t capacity)
+            : m_slots(std::make_unique<_T[]>(roundUpToPowerOfTwo(capacity)))
+            , m_capacity(roundUpToPowerOfTwo(capacity))
+            , m_mask(m_capacity - 1)
+        {
+        }
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        /**
+         * @fn tryPush
+         * @brief producer side. Item is moved only when it was pushed
+         */
+        bool tryPush(_T& item)
+        {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+
+            if (tail - m_head.load(std::memory_order_acquire) == m_capacity)
+                return false;
+
+            m_slots[tail & m_mask] = std::move(item);
+            m_tail.store(tail + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        bool tryPush(_T&& item)
+        {
+            return tryPush(item);
+        }
+
+        /**
+         * @fn tryPop
+         * @brief consumer side
+         */
+        bool tryPop(_T& item)
+        {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+
+            if (head == m_tail.load(std::memory_order_acquire))
+                return false;
+
+            item = std::move(m_slots[head & m_mask]);
+            m_slots[head & m_mask] = _T {};
+            m_head.store(head + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        /**
+         * @fn size
+         * @return count of items at the moment of call (exact only on producer or consumer thread for its own side)
+         */
+        [[nodiscard]] size_t size() const
+        {
+            const size_t head = m_head.load(std::memory_order_acquire); // head is read first, so it never overtakes tail
+            return m_tail.load(std::memory_order_acquire) - head;
+        }
+
+        [[nodiscard]] bool empty() const { return size() == 0; }
+        [[nodiscard]] bool full() const { return size() >= m_capacity; }
+        [[nodiscard]] size_t capacity() const { return m_capacity; }
+
+    private:
+        static size_t roundUpToPowerOfTwo(size_t value)
+        {
+            size_t result = 1;
+
+            while (result < value)
+                result <<= 1;
+
+            return result;
+        }
+    };
+}
@@ -1,8 +1,27 @@
 #include <Application.h>
 
+#include <cstdlib>
 
+namespace {
+    std::string getEnvironment(const char* name, const char* defaultValue)
+    {
+        const char* value = std::getenv(name);
+        return value ? value : defaultValue;
+    }
+}
+
+/**
+ * Settings are taken from environment:
+ *  REACTOR_TELEGRAM_TOKEN   - bot token
+ *  REACTOR_TELEGRAM_PROXY   - proxy URI (optional)
+ *  REACTOR_TELEGRAM_API_URL - Bot API server (optional, e.g. http://127.0.0.1:8081 for MockBotApiServer)
+ */
 int main(int argc, char** argv) {
-    reactor::Application app {};
+    reactor::Application app {
+        getEnvironment("REACTOR_TELEGRAM_TOKEN", "TOKEN"),
+        getEnvironment("REACTOR_TELEGRAM_PROXY", ""),
+        getEnvironment("REACTOR_TELEGRAM_API_URL", "")
+    };
 
     return app.run();
-}
\ No newline at end of file
+}
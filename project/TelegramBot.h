@@ -0,0 +1,5198 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <cstddef>
+#include <charconv>
+
+#include <list>
+#include <vector>
+#include <set>
+#include <queue>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <string>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <exception>
+#include <system_error>
+#include <stdexcept>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+#include <map>
+#include <atomic>
+#include <ctime>
+#include <fstream>
+
+#include <spdlog/spdlog.h>
+#include <curl/curl.h>
+#include <fmt/format.h>
+#include <nlohmann/json.hpp>
+
+#include <SmallVector.h>
+#include <WorkerPool.h>
+#include <SpscQueue.h>
+#include <TlsTrustStore.h>
+#include <ContentDecoder.h>
+#include <LatencyHistogram.h>
+
+namespace reactor::telegram::exceptions {
+
+    class BadAuthorization : public std::exception {
+    public:
+        const char* what() const noexcept override {
+            return "Your access token not acceptable by Telegram server.";
+        }
+    };
+
+    class UnknownError : public std::exception {
+        std::string m_errorMessage;
+    public:
+        explicit UnknownError(int32_t errorCode)
+        {
+            m_errorMessage = fmt::format("Unknown API error. Error code : {}", errorCode);
+        }
+
+        const char* what() const noexcept override {
+            return m_errorMessage.c_str();
+        }
+    };
+
+    class BotNotFound : public std::exception {
+    public:
+        const char* what() const noexcept override {
+            return "Your bot not found. Possible your token isn't correct";
+        }
+    };
+
+    class DeadWall : public std::exception {
+    public:
+        const char* what() const noexcept override {
+            return "Probably your client machine is located in country when your human rights are equal to zero :)";
+        }
+    };
+}
+
+namespace reactor::telegram {
+        namespace error_codes {
+            static constexpr const int32_t BadAuthorization = 401;
+            static constexpr const int32_t NotFound = 404;
+        }
+
+        using TLId      = uint64_t;
+        using TLDate    = uint64_t;
+        using TLString  = std::pmr::string;   //TODO: Use multibyte UTF8 string, std::string for debug only
+        using TLAllocator = std::pmr::polymorphic_allocator<std::byte>;
+
+        template<typename _T>
+        using TLOptional        = std::optional<_T>;
+        using TLOptionalString  = TLOptional<TLString>;
+
+        /**
+         * @class TLMemoryScope
+         * @brief Selects memory resource for TL objects created by parsers on current thread while scope is alive.
+         *        Outside of any scope objects are allocated from default resource (heap)
+         */
+        class TLMemoryScope
+        {
+            std::pmr::memory_resource* m_previous { nullptr };
+
+        public:
+            explicit TLMemoryScope(std::pmr::memory_resource* resource)
+                : m_previous(current())
+            {
+                current() = resource;
+            }
+
+            ~TLMemoryScope()
+            {
+                current() = m_previous;
+            }
+
+            TLMemoryScope(const TLMemoryScope&) = delete;
+            TLMemoryScope& operator=(const TLMemoryScope&) = delete;
+
+            static std::pmr::memory_resource* getResource()
+            {
+                return current();
+            }
+
+        private:
+            static std::pmr::memory_resource*& current()
+            {
+                thread_local std::pmr::memory_resource* resource = std::pmr::get_default_resource();
+                return resource;
+            }
+        };
+
+        /**
+         * @class TLStringPool
+         * @brief Process-wide pool of interned strings. Interned value lives until process exit, so it could be
+         *        referenced by string_view and compared by address. Use it only for small closed vocabularies
+         */
+        class TLStringPool
+        {
+        public:
+            static const std::string* intern(std::string_view value)
+            {
+                static std::mutex s_mutex;
+                static std::set<std::string, std::less<>> s_pool;
+
+                std::lock_guard<std::mutex> lock { s_mutex };
+
+                auto iter = s_pool.find(value);
+                if (iter == s_pool.end())
+                    iter = s_pool.emplace(value).first;
+
+                return &(*iter);
+            }
+        };
+
+        /**
+         * @brief Specialized by TLCodegen for every enum of schema: fromString (perfect hash) and toString
+         */
+        template <typename _Enum>
+        struct TLEnumTraits;
+
+        /**
+         * @class TLEnum
+         * @brief Value of closed string vocabulary (chat type, entity type, ...) parsed into enum.
+         *        Values which are not known by schema are stored as _Enum::Unknown with interned original string
+         */
+        template <typename _Enum>
+        class TLEnum
+        {
+            _Enum m_value { _Enum::Unknown };
+            const std::string* m_unknownValue { nullptr };  ///< Interned original value when m_value is Unknown
+
+        public:
+            constexpr TLEnum() = default;
+            constexpr TLEnum(_Enum value) : m_value(value) {}
+
+            static TLEnum fromString(std::string_view value)
+            {
+                TLEnum result { TLEnumTraits<_Enum>::fromString(value) };
+
+                if (result.m_value == _Enum::Unknown)
+                    result.m_unknownValue = TLStringPool::intern(value);
+
+                return result;
+            }
+
+            [[nodiscard]] constexpr _Enum getValue() const { return m_value; }
+            [[nodiscard]] constexpr bool isKnown() const { return m_value != _Enum::Unknown; }
+
+            [[nodiscard]] constexpr std::string_view toString() const
+            {
+                if (m_value != _Enum::Unknown)
+                    return TLEnumTraits<_Enum>::toString(m_value);
+
+                return m_unknownValue ? std::string_view { *m_unknownValue } : std::string_view {};
+            }
+
+            constexpr bool operator==(_Enum value) const { return m_value == value; }
+            constexpr bool operator!=(_Enum value) const { return m_value != value; }
+
+            // unknown values are interned, so they are equal only when they point to the same string
+            constexpr bool operator==(const TLEnum& other) const { return m_value == other.m_value && m_unknownValue == other.m_unknownValue; }
+            constexpr bool operator!=(const TLEnum& other) const { return !(*this == other); }
+        };
+
+        /**
+         * @class TLIdentityMap
+         * @brief Bounded LRU directory of objects with identity (users, chats) keyed by TLId.
+         *        Parser merges every decoded object into map: unchanged known object is returned as is, so equal ids give
+         *        equal pointers across updates and batches. Changed object is published as new copy (copy-on-write),
+         *        pointers handed out before keep previous state.
+         * @note Objects are allocated from default resource (never from batch arena).
+         *       Published objects are never modified, so they could be read by handlers on any thread.
+         */
+        template <typename _T>
+        class TLIdentityMap
+        {
+        public:
+            using Pointer = std::shared_ptr<_T>;
+
+            static constexpr size_t DefaultCapacity = 16384;
+
+            struct Statistics
+            {
+                uint64_t hits { 0 };
+                uint64_t misses { 0 };
+                uint64_t updates { 0 };     ///< Hits where at least one field was changed (new copy was published)
+                uint64_t evictions { 0 };
+            };
+
+        private:
+            struct Entry
+            {
+                Pointer object { nullptr };
+                typename std::list<TLId>::iterator lruPosition {};
+            };
+
+            mutable std::mutex m_mutex;
+            size_t m_capacity { DefaultCapacity };
+            std::list<TLId> m_lru {};   ///< Most recently used id is first
+            std::unordered_map<TLId, Entry> m_index {};
+            Statistics m_statistics {};
+
+        public:
+            explicit TLIdentityMap(size_t capacity = DefaultCapacity)
+                : m_capacity(capacity)
+            {
+            }
+
+            /**
+             * @fn merge
+             * @brief return cached object with id of parsed object when it is not changed or cache copy of parsed object
+             *        (replaces previous state of object in map)
+             */
+            Pointer merge(const _T& parsed)
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+
+                auto iter = m_index.find(parsed.id);
+                if (iter != m_index.end())
+                {
+                    ++m_statistics.hits;
+                    m_lru.splice(m_lru.begin(), m_lru, iter->second.lruPosition);
+
+                    if (isChanged(*iter->second.object, parsed))
+                    {
+                        ++m_statistics.updates;
+                        iter->second.object = std::make_shared<_T>(parsed);
+                    }
+
+                    return iter->second.object;
+                }
+
+                ++m_statistics.misses;
+
+                auto object = std::make_shared<_T>(parsed); // copy places strings into default resource
+                m_lru.push_front(parsed.id);
+                m_index.emplace(parsed.id, Entry { object, m_lru.begin() });
+
+                evict();
+
+                return object;
+            }
+
+            /**
+             * @fn find
+             * @return known object with id or nullptr
+             */
+            [[nodiscard]] Pointer find(TLId id) const
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+
+                auto iter = m_index.find(id);
+                return iter == m_index.end() ? nullptr : iter->second.object;
+            }
+
+            void setCapacity(size_t capacity)
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+
+                m_capacity = capacity;
+                evict();
+            }
+
+            [[nodiscard]] size_t size() const
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                return m_index.size();
+            }
+
+            [[nodiscard]] Statistics getStatistics() const
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                return m_statistics;
+            }
+
+        private:
+            void evict()
+            {
+                while (m_index.size() > m_capacity)
+                {
+                    m_index.erase(m_lru.back());
+                    m_lru.pop_back();
+                    ++m_statistics.evictions;
+                }
+            }
+        };
+
+        class TLIdentityMaps;   ///< Generated: TLIdentityMap for every type with identity
+
+        /**
+         * @class TLIdentityScope
+         * @brief Selects identity maps used by parsers on current thread while scope is alive.
+         *        Outside of any scope every parsed object is unique
+         */
+        class TLIdentityScope
+        {
+            TLIdentityMaps* m_previous { nullptr };
+
+        public:
+            explicit TLIdentityScope(TLIdentityMaps* maps)
+                : m_previous(current())
+            {
+                current() = maps;
+            }
+
+            ~TLIdentityScope()
+            {
+                current() = m_previous;
+            }
+
+            TLIdentityScope(const TLIdentityScope&) = delete;
+            TLIdentityScope& operator=(const TLIdentityScope&) = delete;
+
+            static TLIdentityMaps* getMaps()
+            {
+                return current();
+            }
+
+        private:
+            static TLIdentityMaps*& current()
+            {
+                thread_local TLIdentityMaps* maps = nullptr;
+                return maps;
+            }
+        };
+
+        /**
+         * @class TLFlags
+         * @brief Group of optional boolean fields packed into presence and value bitmasks.
+         *        _Flag is generated enum where every value is a single bit
+         */
+        template <typename _Flag>
+        class TLFlags
+        {
+        public:
+            using Mask = std::underlying_type_t<_Flag>;
+
+        private:
+            Mask m_present { 0 };
+            Mask m_values { 0 };    ///< Bit is set only when flag is present and true
+
+        public:
+            /**
+             * @fn maskOf
+             * @brief combine flags into mask for hasAll / hasAny checks (could be computed at compile time)
+             */
+            template <typename... _Flags>
+            static constexpr Mask maskOf(_Flags... flags)
+            {
+                return (static_cast<Mask>(0) | ... | static_cast<Mask>(flags));
+            }
+
+            constexpr void set(_Flag flag, bool value)
+            {
+                const Mask mask = static_cast<Mask>(flag);
+
+                m_present |= mask;
+                m_values = (m_values & ~mask) | (static_cast<Mask>(0u - static_cast<Mask>(value)) & mask);
+            }
+
+            [[nodiscard]] constexpr TLOptional<bool> get(_Flag flag) const
+            {
+                if (!isPresent(flag))
+                    return std::nullopt;
+
+                return has(flag);
+            }
+
+            [[nodiscard]] constexpr bool isPresent(_Flag flag) const { return (m_present & static_cast<Mask>(flag)) != 0; }
+
+            /**
+             * @fn has
+             * @return true when flag is present and true
+             */
+            [[nodiscard]] constexpr bool has(_Flag flag) const { return (m_values & static_cast<Mask>(flag)) != 0; }
+            [[nodiscard]] constexpr bool hasAll(Mask mask) const { return (m_values & mask) == mask; }
+            [[nodiscard]] constexpr bool hasAny(Mask mask) const { return (m_values & mask) != 0; }
+
+            [[nodiscard]] constexpr Mask getPresentMask() const { return m_present; }
+            [[nodiscard]] constexpr Mask getValuesMask() const { return m_values; }
+
+            constexpr bool operator==(const TLFlags& other) const { return m_present == other.m_present && m_values == other.m_values; }
+            constexpr bool operator!=(const TLFlags& other) const { return !(*this == other); }
+        };
+
+        class Server;
+        class TLPollEngine;
+        class ErrorHandler;
+
+        using TLPollEnginePtr       = std::unique_ptr<TLPollEngine>;
+        using ServerPtr             = std::shared_ptr<Server>;
+    }
+
+/**
+ * @brief API types (Chat, User, Message, ...), their *Ptr/list aliases, JSON parsers and request structs
+ *        are generated by TLCodegen from schema/BotApi.schema
+ */
+#include <TLTypes.generated.h>
+
+namespace reactor::telegram {
+        class ErrorHandler
+        {
+        public:
+            static void processServerFailureByJsonRepresentation(const nlohmann::json& j);
+        };
+
+        struct BotCommand
+        {
+            std::string command {};
+            size_t offset { 0 };
+            size_t length { 0 };
+        };
+
+        using BotCommandsList = SmallVector<BotCommand, 4>;
+
+        /**
+         * @class JsonObjectView
+         * @brief Index of single JSON object level: positions of every value by key.
+         *        Values are not decoded here, nested objects are skipped (they could be indexed by separate view).
+         * @note View does not own memory, source must outlive it
+         */
+        class JsonObjectView
+        {
+            struct Field
+            {
+                std::string_view key;
+                std::string_view value;
+            };
+
+            static constexpr const size_t ExpectedFieldsCount = 16;
+
+            std::vector<Field> m_fields {};
+
+        public:
+            JsonObjectView() = default;
+
+            explicit JsonObjectView(std::string_view object)
+            {
+                m_fields.reserve(JsonObjectView::ExpectedFieldsCount);
+
+                size_t position = skipWhitespaces(object, 0);
+                if (position >= object.size() || object[position] != '{')
+                    throw std::runtime_error("[JsonObjectView] object expected");
+
+                ++position;
+
+                while (true)
+                {
+                    position = skipWhitespaces(object, position);
+                    if (position >= object.size())
+                        throw std::runtime_error("[JsonObjectView] unexpected end of object");
+
+                    if (object[position] == '}')
+                        break;
+
+                    if (object[position] == ',')
+                    {
+                        ++position;
+                        continue;
+                    }
+
+                    const size_t keyEnd = skipValue(object, position);   // key is a string value
+                    const std::string_view key = object.substr(position + 1, keyEnd - position - 2);
+
+                    position = skipWhitespaces(object, keyEnd);
+                    if (position >= object.size() || object[position] != ':')
+                        throw std::runtime_error("[JsonObjectView] ':' expected");
+
+                    position = skipWhitespaces(object, position + 1);
+
+                    const size_t valueEnd = skipValue(object, position);
+                    m_fields.push_back(Field { key, object.substr(position, valueEnd - position) });
+
+                    position = valueEnd;
+                }
+            }
+
+            [[nodiscard]] std::optional<std::string_view> find(std::string_view key) const
+            {
+                for (const auto& field : m_fields)
+                {
+                    if (field.key == key)
+                        return field.value;
+                }
+
+                return std::nullopt;
+            }
+
+            [[nodiscard]] bool contains(std::string_view key) const { return find(key).has_value(); }
+
+            /**
+             * @fn toInteger
+             * @note negative values are converted the same way as nlohmann::json::get does (static_cast from int64_t),
+             *       so negative ids of groups are equal to ids from eager parser
+             */
+            template <typename _T>
+            static _T toInteger(std::string_view value)
+            {
+                std::conditional_t<std::is_unsigned_v<_T>, int64_t, _T> signedResult { 0 };
+
+                if (!value.empty() && value.front() == '-')
+                {
+                    if (std::from_chars(value.data(), value.data() + value.size(), signedResult).ec != std::errc {})
+                        throw std::runtime_error("[JsonObjectView] integer expected");
+
+                    return static_cast<_T>(signedResult);
+                }
+
+                _T result { 0 };
+
+                if (std::from_chars(value.data(), value.data() + value.size(), result).ec != std::errc {})
+                    throw std::runtime_error("[JsonObjectView] integer expected");
+
+                return result;
+            }
+
+            static TLString toString(std::string_view value)
+            {
+                if (value.size() < 2 || value.front() != '"')
+                    throw std::runtime_error("[JsonObjectView] string expected");
+
+                if (value.find('\\') == std::string_view::npos)
+                    return TLString { value.substr(1, value.size() - 2) };  // nothing to unescape
+
+                return nlohmann::json::parse(value.begin(), value.end()).get<TLString>();
+            }
+
+        private:
+            static size_t skipWhitespaces(std::string_view json, size_t position)
+            {
+                while (position < json.size() && std::isspace(static_cast<unsigned char>(json[position])))
+                    ++position;
+
+                return position;
+            }
+
+            /**
+             * @return position right after the value which starts at position
+             */
+            static size_t skipValue(std::string_view json, size_t position)
+            {
+                size_t depth = 0;
+                bool isInString = false;
+                bool isEscaped = false;
+
+                for (; position < json.size(); ++position)
+                {
+                    const char ch = json[position];
+
+                    if (isInString)
+                    {
+                        if (isEscaped)
+                            isEscaped = false;
+                        else if (ch == '\\')
+                            isEscaped = true;
+                        else if (ch == '"')
+                        {
+                            isInString = false;
+
+                            if (depth == 0)
+                                return position + 1;
+                        }
+
+                        continue;
+                    }
+
+                    switch (ch)
+                    {
+                        case '"':
+                            isInString = true;
+                            break;
+                        case '{':
+                        case '[':
+                            ++depth;
+                            break;
+                        case '}':
+                        case ']':
+                            if (depth == 0)
+                                return position;    // end of parent object, value was primitive
+
+                            if (--depth == 0)
+                                return position + 1;
+                            break;
+                        case ',':
+                            if (depth == 0)
+                                return position;
+                            break;
+                        default:
+                            if (depth == 0 && std::isspace(static_cast<unsigned char>(ch)))
+                                return position;
+                            break;
+                    }
+                }
+
+                throw std::runtime_error("[JsonObjectView] unexpected end of value");
+            }
+        };
+
+        /**
+         * @class LazyUpdate
+         * @brief On-demand view over raw JSON of single update.
+         *        Keeps raw bytes, indexes positions of fields and decodes only fields which were touched by handler.
+         *        Whole object graph (same as eager parser gives) could be built by getMessage() / materialize().
+         * @note Decoded parts are cached, so instance must not be used from several threads at the same time
+         */
+        class LazyUpdate
+        {
+            std::string m_raw;
+            JsonObjectView m_update;
+            mutable std::optional<JsonObjectView> m_message;
+            mutable std::optional<JsonObjectView> m_chat;
+            mutable MessagePtr m_materializedMessage { nullptr };
+            mutable ChatPtr m_materializedChat { nullptr };
+
+        public:
+            explicit LazyUpdate(std::string_view raw)
+                : m_raw(raw)
+                , m_update(m_raw)
+            {
+            }
+
+            LazyUpdate(const LazyUpdate&) = delete;
+            LazyUpdate& operator=(const LazyUpdate&) = delete;
+
+            [[nodiscard]] std::string_view getRaw() const { return m_raw; }
+
+            [[nodiscard]] TLId getUpdateId() const
+            {
+                return JsonObjectView::toInteger<TLId>(require(m_update, "update_id"));
+            }
+
+            [[nodiscard]] bool hasMessage() const { return m_update.contains("message"); }
+            [[nodiscard]] bool hasEditedMessage() const { return m_update.contains("edited_message"); }
+
+            [[nodiscard]] TLId getMessageId() const
+            {
+                return JsonObjectView::toInteger<TLId>(require(getMessageView(), "message_id"));
+            }
+
+            [[nodiscard]] TLId getChatId() const
+            {
+                return JsonObjectView::toInteger<TLId>(require(getChatView(), "id"));
+            }
+
+            [[nodiscard]] TLOptionalString getText() const
+            {
+                if (auto text = getMessageView().find("text"); text.has_value())
+                    return JsonObjectView::toString(*text);
+
+                return std::nullopt;
+            }
+
+            [[nodiscard]] bool hasEntities() const { return getMessageView().contains("entities"); }
+
+            /**
+             * @fn getChat
+             * @brief decode only chat of message
+             */
+            [[nodiscard]] const ChatPtr& getChat() const
+            {
+                if (!m_materializedChat)
+                {
+                    if (m_materializedMessage)
+                        m_materializedChat = m_materializedMessage->chat;
+                    else
+                        nlohmann::adl_serializer<ChatPtr>::from_json(LazyUpdate::parse(require(getMessageView(), "chat")), m_materializedChat);
+                }
+
+                return m_materializedChat;
+            }
+
+            /**
+             * @fn getMessage
+             * @brief decode whole message (the same object graph as eager parser produces)
+             */
+            [[nodiscard]] const MessagePtr& getMessage() const
+            {
+                if (!m_materializedMessage)
+                    nlohmann::adl_serializer<MessagePtr>::from_json(LazyUpdate::parse(require(m_update, "message")), m_materializedMessage);
+
+                return m_materializedMessage;
+            }
+
+            /**
+             * @fn materialize
+             * @brief decode whole update by eager parser
+             */
+            [[nodiscard]] UpdatePtr materialize() const
+            {
+                UpdatePtr update = nullptr;
+                nlohmann::adl_serializer<UpdatePtr>::from_json(LazyUpdate::parse(m_raw), update);
+
+                return update;
+            }
+
+        private:
+            const JsonObjectView& getMessageView() const
+            {
+                if (!m_message.has_value())
+                    m_message.emplace(require(m_update, "message"));
+
+                return *m_message;
+            }
+
+            const JsonObjectView& getChatView() const
+            {
+                if (!m_chat.has_value())
+                    m_chat.emplace(require(getMessageView(), "chat"));
+
+                return *m_chat;
+            }
+
+            static std::string_view require(const JsonObjectView& view, std::string_view key)
+            {
+                auto value = view.find(key);
+                if (!value.has_value())
+                    throw std::runtime_error(fmt::format("[LazyUpdate] field {} is missing", key));
+
+                return *value;
+            }
+
+            static nlohmann::json parse(std::string_view json)
+            {
+                return nlohmann::json::parse(json.begin(), json.end());
+            }
+        };
+
+        using LazyUpdatePtr     = std::shared_ptr<LazyUpdate>;
+        using LazyUpdatesList   = std::vector<LazyUpdatePtr>;
+    }
+
+namespace reactor {
+    namespace telegram {
+        class ITelergamMessageProcessor {
+        public:
+            virtual ~ITelergamMessageProcessor() noexcept = default;
+
+            virtual void onMessage(const telegram::MessagePtr& message, const telegram::ServerPtr& server) = 0;
+            virtual void onBotCommands(const telegram::MessagePtr& message, const telegram::BotCommandsList& commands, const telegram::ServerPtr& server) = 0;
+            virtual void onMessageEdited(const telegram::MessagePtr& message, const telegram::ServerPtr& server) {}
+
+            /**
+             * @fn onLazyMessage
+             * @brief called instead of onMessage when lazy updates are enabled and message has no bot commands.
+             *        Override it to work with lazy view directly (by default whole message is decoded and passed to onMessage)
+             */
+            virtual void onLazyMessage(const telegram::LazyUpdatePtr& update, const telegram::ServerPtr& server)
+            {
+                onMessage(update->getMessage(), server);
+            }
+        };
+
+        struct TLAPI
+        {
+            static constexpr const char* DefaultBaseUrl = "https://api.telegram.org"; ///< Could be changed by TLPollEngine::setApiBaseUrl
+            static constexpr const char* getUpdates = "getUpdates";
+            static constexpr const char* sendMessage = "sendMessage";
+            static constexpr const char* getMe = "getMe";
+            static constexpr const char* setChatTitle = "setChatTitle";
+            static constexpr const char* sendVideo = "sendVideo";
+        };
+
+        class TLPollEngine
+        {
+            static constexpr const uint32_t UpdatesLimit = 256; ///< Max 256 updates per request
+            static constexpr const uint32_t AwaitTimeout = 15; ///< Wait 15 seconds and sendMessage response
+            static constexpr const int PollInterval = 100; ///< Max time (in milliseconds) to wait for network activity per loop
+            static constexpr const size_t MinConcurrentRequests = 2; ///< Long-poll and at least one outcoming request
+            static constexpr const std::chrono::milliseconds MinPollRetryDelay { 500 }; ///< Delay after first failed getUpdates, doubled by every next failure
+            static constexpr const std::chrono::milliseconds MaxPollRetryDelay { 30000 };
+
+            friend class Server;
+            friend class ServerHost;
+
+            class cURLMultiDriver;
+
+            /**
+             * @class ResponseBuffer
+             * @brief Growable buffer for response body.
+             *        Buffers are pooled by cURLRuntime, so capacity from previous responses is reused.
+             *        When server sends Content-Length buffer is pre-sized once before first chunk arrived.
+             *        Bodies with Content-Encoding gzip/deflate are inflated on the fly (see CompressionPolicy),
+             *        buffer always holds decoded body.
+             */
+            class ResponseBuffer
+            {
+            public:
+                /**
+                 * @struct Timings
+                 * @brief phases of transfer, filled by cURLMultiDriver when transfer is completed
+                 */
+                struct Timings
+                {
+                    std::chrono::microseconds waiting { 0 };        ///< Request is sent .. first byte of response (long-poll wait for getUpdates)
+                    std::chrono::microseconds downloading { 0 };    ///< First .. last byte of response
+                    std::chrono::microseconds total { 0 };          ///< Request is enqueued .. completed (includes wait for free transfer slot)
+                };
+
+            private:
+                static constexpr const size_t MinimalCapacity = 4096;
+
+                std::string m_data {};
+                size_t m_allocationsCount { 0 };
+                size_t m_copiesCount { 0 };
+                std::unique_ptr<ContentDecoder> m_decoder {};  ///< Kept between responses of pooled buffer
+                bool m_isEncoded { false };
+                size_t m_contentLength { 0 };
+                size_t m_wireBytes { 0 };
+                Timings m_timings {};
+
+            public:
+                void reserve(size_t size)
+                {
+                    if (size <= m_data.capacity())
+                        return;
+
+                    m_data.reserve(size);
+                    ++m_allocationsCount;
+                }
+
+                void append(const char* data, size_t size)
+                {
+                    const size_t requiredSize = m_data.size() + size;
+
+                    if (requiredSize > m_data.capacity())
+                        reserve(std::max({ requiredSize, m_data.capacity() * 2, ResponseBuffer::MinimalCapacity }));
+
+                    m_data.append(data, size);
+                }
+
+                void clear()
+                {
+                    m_data.clear(); //capacity is kept
+                    m_allocationsCount = 0;
+                    m_copiesCount = 0;
+                    m_isEncoded = false;
+                    m_contentLength = 0;
+                    m_wireBytes = 0;
+                    m_timings = Timings {};
+                }
+
+                /**
+                 * @fn receive
+                 * @brief pass next piece of body (as it came from network) to sink(const char* data, size_t size) decoded
+                 * @throws std::runtime_error when encoded body is corrupted
+                 */
+                template <typename _Sink>
+                void receive(const char* data, size_t size, _Sink&& sink)
+                {
+                    m_wireBytes += size;
+
+                    if (m_isEncoded)
+                        m_decoder->decode(data, size, sink);
+                    else
+                        sink(data, size);
+                }
+
+                /**
+                 * @fn toString
+                 * @brief copy content into new string. Prefer view() when possible, every copy is counted
+                 */
+                std::string toString()
+                {
+                    ++m_copiesCount;
+                    return m_data;
+                }
+
+                [[nodiscard]] std::string_view view() const { return m_data; }
+                [[nodiscard]] size_t size() const { return m_data.size(); }
+                [[nodiscard]] size_t capacity() const { return m_data.capacity(); }
+                [[nodiscard]] size_t getAllocationsCount() const { return m_allocationsCount; } ///< Allocations made for current response
+                [[nodiscard]] size_t getCopiesCount() const { return m_copiesCount; } ///< Full copies of current response
+                [[nodiscard]] bool isEncoded() const { return m_isEncoded; }
+                [[nodiscard]] size_t getWireBytes() const { return m_wireBytes; } ///< Body bytes received from network (compressed when encoded)
+                [[nodiscard]] size_t getDecodedBytes() const { return m_isEncoded ? m_decoder->getOutputBytes() : m_wireBytes; }
+                [[nodiscard]] std::chrono::nanoseconds getDecodingTime() const { return m_isEncoded ? m_decoder->getDecodingTime() : std::chrono::nanoseconds { 0 }; }
+                [[nodiscard]] const Timings& getTimings() const { return m_timings; }
+                void setTimings(const Timings& timings) { m_timings = timings; }
+
+                static size_t onWrite(void* contents, size_t size, size_t nmemb, void* userp)
+                {
+                    const size_t realSize = size * nmemb;
+                    auto buffer = reinterpret_cast<ResponseBuffer*>(userp);
+
+                    try
+                    {
+                        buffer->receive(reinterpret_cast<const char*>(contents), realSize, [buffer](const char* data, size_t dataSize) {
+                            buffer->append(data, dataSize);
+                        });
+                    }
+                    catch (const std::exception& error)
+                    {
+                        spdlog::error("[ResponseBuffer::onWrite] {}", error.what());
+                        return 0; // abort transfer
+                    }
+
+                    return realSize;
+                }
+
+                static size_t onHeader(char* header, size_t size, size_t nitems, void* userp)
+                {
+                    static constexpr std::string_view StatusLine = "http/";
+                    static constexpr std::string_view ContentLength = "content-length:";
+                    static constexpr std::string_view ContentEncoding = "content-encoding:";
+
+                    const size_t realSize = size * nitems;
+                    const std::string_view line { header, realSize };
+                    auto buffer = reinterpret_cast<ResponseBuffer*>(userp);
+
+                    const auto startsWith = [&line](std::string_view prefix) {
+                        return line.size() > prefix.size() && std::equal(prefix.begin(), prefix.end(), line.begin(), [](char a, char b) {
+                            return a == std::tolower(static_cast<unsigned char>(b));
+                        });
+                    };
+
+                    try
+                    {
+                        if (startsWith(StatusLine))
+                        {
+                            // headers of new response (after redirect, 100-continue or proxy CONNECT)
+                            buffer->m_isEncoded = false;
+                            buffer->m_contentLength = 0;
+                        }
+                        else if (startsWith(ContentLength))
+                        {
+                            buffer->m_contentLength = std::strtoull(line.data() + ContentLength.size(), nullptr, 10);
+                        }
+                        else if (startsWith(ContentEncoding))
+                        {
+                            const auto value = line.substr(ContentEncoding.size());
+                            if (value.find("gzip") != std::string_view::npos || value.find("deflate") != std::string_view::npos)
+                                buffer->beginDecoding();
+                        }
+                        else if (line == "\r\n" && !buffer->m_isEncoded && buffer->m_contentLength > 0)
+                        {
+                            // size of encoded body says nothing about decoded one. Content-Length is only a hint: it is capped,
+                            // bigger body grows buffer as it arrives
+                            buffer->reserve(std::min(buffer->m_contentLength, cURLRuntime::MaxPooledResponseBufferCapacity));
+                        }
+                    }
+                    catch (const std::exception& error)
+                    {
+                        spdlog::error("[ResponseBuffer::onHeader] {}", error.what());
+                        return 0; // abort transfer
+                    }
+
+                    return realSize;
+                }
+
+            private:
+                void beginDecoding()
+                {
+                    if (!m_decoder)
+                        m_decoder = std::make_unique<ContentDecoder>();
+
+                    m_decoder->reset();
+                    m_isEncoded = true;
+                }
+            };
+
+            /**
+             * @class CompressionPolicy
+             * @brief Which API methods ask for compressed responses (Accept-Encoding: gzip, deflate).
+             *        Responses are decoded by ResponseBuffer (cURL decoding is disabled), so bytes on wire and time of decoding are known.
+             *        Compression is enabled for every method by default, method could be excluded by name (e.g. "sendMessage").
+             */
+            class CompressionPolicy
+            {
+                bool m_isEnabled { true };
+                std::unordered_map<std::string, bool> m_methods {};
+
+            public:
+                static constexpr const char* AcceptedEncodings = "gzip, deflate";
+
+                void setEnabled(bool isEnabled)
+                {
+                    m_isEnabled = isEnabled;
+                }
+
+                void setEnabled(const std::string& method, bool isEnabled)
+                {
+                    m_methods[method] = isEnabled;
+                }
+
+                /**
+                 * @fn isEnabledFor
+                 * @param url API request url (method name is taken from last segment of path)
+                 */
+                [[nodiscard]] bool isEnabledFor(std::string_view url) const
+                {
+                    if (m_methods.empty())
+                        return m_isEnabled;
+
+                    std::string_view method = url.substr(0, url.find('?'));
+                    method = method.substr(method.rfind('/') + 1);
+
+                    const auto iter = m_methods.find(std::string(method));
+                    return iter != m_methods.end() ? iter->second : m_isEnabled;
+                }
+
+                void apply(CURL* handle, std::string_view url) const
+                {
+                    if (!isEnabledFor(url))
+                        return;
+
+                    curl_easy_setopt(handle, CURLOPT_ACCEPT_ENCODING, CompressionPolicy::AcceptedEncodings);
+                    curl_easy_setopt(handle, CURLOPT_HTTP_CONTENT_DECODING, 0L);
+                }
+            };
+
+            /**
+             * @class cURLRuntime
+             * @brief Process-wide transport runtime.
+             *        Initializes cURL once, owns share object (DNS cache, TLS session IDs and connection cache)
+             *        and pool of warm easy handles. All drivers must take their handles from here.
+             *        Every handle verifies peer and host name. When cURL is built with OpenSSL certificate authorities
+             *        are loaded once per process (TlsTrustStore) instead of parsing CA bundle on every handshake,
+             *        and TLS sessions are resumed across handles through share object.
+             */
+            class cURLRuntime
+            {
+                static constexpr const size_t MaxPooledHandles = 16;
+                static constexpr const size_t MaxPooledResponseBuffers = 16;
+                static constexpr const long KeepAliveIdle = 60; ///< Seconds before first TCP keep-alive probe
+                static constexpr const long KeepAliveInterval = 30; ///< Seconds between TCP keep-alive probes
+
+                CURLSH* m_share { nullptr };
+                std::mutex m_shareLocks[CURL_LOCK_DATA_LAST];
+                std::mutex m_poolLock;
+                std::vector<CURL*> m_handlesPool;
+                std::vector<ResponseBuffer> m_responseBuffersPool;
+                TlsTrustStore m_trustStore {};
+                bool m_isSharedTrustStore { false };   ///< false when TLS backend of cURL is not OpenSSL we are linked with
+                std::mutex m_caLock;                    ///< Guards m_caFile and m_caPath
+                std::string m_caFile {};
+                std::string m_caPath {};
+
+                cURLRuntime()
+                {
+                    curl_global_init(CURL_GLOBAL_DEFAULT);
+
+                    m_share = curl_share_init();
+                    curl_share_setopt(m_share, CURLSHOPT_LOCKFUNC, cURLRuntime::onLockShare);
+                    curl_share_setopt(m_share, CURLSHOPT_UNLOCKFUNC, cURLRuntime::onUnlockShare);
+                    curl_share_setopt(m_share, CURLSHOPT_USERDATA, this);
+                    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+                    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+                    curl_share_setopt(m_share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+
+                    m_handlesPool.reserve(cURLRuntime::MaxPooledHandles);
+                    m_responseBuffersPool.reserve(cURLRuntime::MaxPooledResponseBuffers);
+
+                    const curl_version_info_data* info = curl_version_info(CURLVERSION_NOW);
+                    m_isSharedTrustStore = isLinkedOpenSsl(info->ssl_version);
+
+                    if (m_isSharedTrustStore)
+                    {
+                        try
+                        {
+                            loadTrustStore(info->cainfo ? info->cainfo : "", info->capath ? info->capath : "");
+                        }
+                        catch (const std::exception& error)
+                        {
+                            // cURL will look for its default bundle on every handshake (and fail verification if there is none)
+                            spdlog::warn("[cURLRuntime] {}", error.what());
+                            m_isSharedTrustStore = false;
+                        }
+                    }
+                }
+
+            public:
+                static constexpr const size_t MaxPooledResponseBufferCapacity = 4 * 1024 * 1024; ///< Bigger buffers are released instead of pooling, also caps Content-Length hint
+
+                cURLRuntime(const cURLRuntime&) = delete;
+                cURLRuntime& operator=(const cURLRuntime&) = delete;
+
+                /**
+                 * @fn getInstance
+                 * @note runtime is never destroyed: detached poll threads could still be inside of cURL while static objects
+                 *       are destroyed, so pooled handles, share object and curl_global_cleanup are left to process exit
+                 */
+                static cURLRuntime& getInstance()
+                {
+                    static cURLRuntime* runtime = new cURLRuntime();
+                    return *runtime;
+                }
+
+                /**
+                 * @fn setCertificateAuthorities
+                 * @brief trust given PEM bundle and/or hashed directory instead of system ones
+                 * @note could be called from any thread at any time: new connections verify peers by new authorities,
+                 *       connections which are already established (or being established) keep previous ones
+                 * @throws std::runtime_error when certificate authorities could not be loaded (previous ones are kept)
+                 */
+                void setCertificateAuthorities(const std::string& caFile, const std::string& caPath = std::string())
+                {
+                    if (m_isSharedTrustStore)
+                        loadTrustStore(caFile, caPath);
+
+                    {
+                        std::lock_guard<std::mutex> guard { m_caLock };
+
+                        m_caFile = caFile;
+                        m_caPath = caPath;
+                    }
+
+                    std::lock_guard<std::mutex> guard { m_poolLock };
+
+                    for (CURL* handle : m_handlesPool)
+                        applyDefaults(handle);
+                }
+
+                [[nodiscard]] bool isSharedTrustStore() const { return m_isSharedTrustStore; }
+
+                /**
+                 * @fn acquireHandle
+                 * @brief take warm handle from pool (or create new one). Handle already attached to shared caches
+                 */
+                CURL* acquireHandle()
+                {
+                    CURL* handle = nullptr;
+
+                    {
+                        std::lock_guard<std::mutex> guard { m_poolLock };
+
+                        if (!m_handlesPool.empty())
+                        {
+                            handle = m_handlesPool.back();
+                            m_handlesPool.pop_back();
+                        }
+                    }
+
+                    if (!handle)
+                    {
+                        handle = curl_easy_init();
+                        applyDefaults(handle);
+                    }
+
+                    return handle;
+                }
+
+                /**
+                 * @fn releaseHandle
+                 * @brief reset options of handle and return it to pool. Live connections and caches are kept
+                 */
+                void releaseHandle(CURL* handle)
+                {
+                    if (!handle)
+                        return;
+
+                    resetHandle(handle);
+
+                    std::lock_guard<std::mutex> guard { m_poolLock };
+
+                    if (m_handlesPool.size() < cURLRuntime::MaxPooledHandles)
+                        m_handlesPool.push_back(handle);
+                    else
+                        curl_easy_cleanup(handle);
+                }
+
+                /**
+                 * @fn acquireResponseBuffer
+                 * @brief take empty response buffer (with capacity from previous responses when available)
+                 */
+                ResponseBuffer acquireResponseBuffer()
+                {
+                    std::lock_guard<std::mutex> guard { m_poolLock };
+
+                    if (m_responseBuffersPool.empty())
+                        return ResponseBuffer {};
+
+                    ResponseBuffer buffer = std::move(m_responseBuffersPool.back());
+                    m_responseBuffersPool.pop_back();
+
+                    return buffer;
+                }
+
+                void releaseResponseBuffer(ResponseBuffer&& buffer)
+                {
+                    if (buffer.capacity() > cURLRuntime::MaxPooledResponseBufferCapacity)
+                        return;
+
+                    buffer.clear();
+
+                    std::lock_guard<std::mutex> guard { m_poolLock };
+
+                    if (m_responseBuffersPool.size() < cURLRuntime::MaxPooledResponseBuffers)
+                        m_responseBuffersPool.push_back(std::move(buffer));
+                }
+
+                /**
+                 * @fn resetHandle
+                 * @brief curl_easy_reset drops all options (share object included), so we must restore our defaults
+                 */
+                void resetHandle(CURL* handle)
+                {
+                    curl_easy_reset(handle);
+                    applyDefaults(handle);
+                }
+
+            private:
+                void applyDefaults(CURL* handle)
+                {
+                    curl_easy_setopt(handle, CURLOPT_SHARE, m_share);
+                    curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+                    curl_easy_setopt(handle, CURLOPT_TCP_KEEPALIVE, 1L);
+                    curl_easy_setopt(handle, CURLOPT_TCP_KEEPIDLE, cURLRuntime::KeepAliveIdle);
+                    curl_easy_setopt(handle, CURLOPT_TCP_KEEPINTVL, cURLRuntime::KeepAliveInterval);
+                    curl_easy_setopt(handle, CURLOPT_DNS_CACHE_TIMEOUT, -1L); //DNS entries are shared, keep them forever
+                    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 1L);
+                    curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 2L);
+                    curl_easy_setopt(handle, CURLOPT_SSL_SESSIONID_CACHE, 1L);
+
+                    if (m_isSharedTrustStore)
+                    {
+                        // nothing to load per handshake: store is attached in onSslContext
+                        curl_easy_setopt(handle, CURLOPT_CAINFO, nullptr);
+                        curl_easy_setopt(handle, CURLOPT_CAPATH, nullptr);
+                        curl_easy_setopt(handle, CURLOPT_SSL_CTX_FUNCTION, cURLRuntime::onSslContext);
+                        curl_easy_setopt(handle, CURLOPT_SSL_CTX_DATA, this);
+                    }
+                    else
+                    {
+                        std::lock_guard<std::mutex> guard { m_caLock };
+
+                        if (!m_caFile.empty())
+                            curl_easy_setopt(handle, CURLOPT_CAINFO, m_caFile.c_str());
+
+                        if (!m_caPath.empty())
+                            curl_easy_setopt(handle, CURLOPT_CAPATH, m_caPath.c_str());
+                    }
+                }
+
+                void loadTrustStore(const std::string& caFile, const std::string& caPath)
+                {
+                    const auto startedAt = std::chrono::steady_clock::now();
+                    m_trustStore.load(caFile, caPath);
+                    const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startedAt).count();
+
+                    spdlog::info("[cURLRuntime::loadTrustStore] {} certificate authorities loaded from '{}' / '{}' in {:.1f} ms",
+                                 m_trustStore.getCertificatesCount(), caFile, caPath, elapsed);
+                }
+
+                /**
+                 * @fn isLinkedOpenSsl
+                 * @brief store could be shared with contexts of cURL only when cURL uses the same OpenSSL as we do:
+                 *        SSL_CTX of other build (or of other TLS library) must never be touched by our X509_STORE functions
+                 */
+                static bool isLinkedOpenSsl(const char* sslVersion)
+                {
+                    static constexpr std::string_view Prefix = "OpenSSL/";
+
+                    if (!sslVersion || std::string_view(sslVersion).substr(0, Prefix.size()) != Prefix)
+                        return false;
+
+                    unsigned major = 0, minor = 0, patch = 0;
+                    if (std::sscanf(sslVersion + Prefix.size(), "%u.%u.%u", &major, &minor, &patch) != 3)
+                        return false;
+
+                    // both 1.x (MNNFFPPS) and 3.x (MNN00PP0) keep major, minor and patch (fix) in the same bits
+                    const unsigned long linkedVersion = OpenSSL_version_num();
+                    const bool isSameVersion = major == ((linkedVersion >> 28) & 0xF) && minor == ((linkedVersion >> 20) & 0xFF) && patch == ((linkedVersion >> 4) & 0xFF);
+
+                    if (!isSameVersion)
+                        spdlog::warn("[cURLRuntime] cURL uses {} but {} is linked, certificate authorities are not shared", sslVersion, OpenSSL_version(OPENSSL_VERSION));
+
+                    return isSameVersion;
+                }
+
+                static CURLcode onSslContext(CURL*, void* sslContext, void* userp)
+                {
+                    reinterpret_cast<cURLRuntime*>(userp)->m_trustStore.attachTo(static_cast<SSL_CTX*>(sslContext));
+                    return CURLE_OK;
+                }
+
+                static void onLockShare(CURL*, curl_lock_data data, curl_lock_access, void* userp)
+                {
+                    reinterpret_cast<cURLRuntime*>(userp)->m_shareLocks[data].lock();
+                }
+
+                static void onUnlockShare(CURL*, curl_lock_data data, void* userp)
+                {
+                    reinterpret_cast<cURLRuntime*>(userp)->m_shareLocks[data].unlock();
+                }
+            };
+
+            class cURLDriver
+            {
+                friend class cURLMultiDriver;
+
+                CURL* m_curlInstance { nullptr };
+
+                std::string m_proxyURI;
+                CompressionPolicy m_compression {};
+            public:
+                using URL = std::string;
+                using Parameters = std::unordered_map<std::string, std::string>;
+
+                /**
+                 * @struct ParametersWriter
+                 * @brief adapter to write generated request structs into Parameters (used by multipart requests)
+                 */
+                struct ParametersWriter
+                {
+                    Parameters& parameters;
+
+                    void add(std::string_view key, std::string_view value)
+                    {
+                        parameters.emplace(key, value);
+                    }
+
+                    template <typename _T, typename = std::enable_if_t<std::is_integral_v<_T>>>
+                    void add(std::string_view key, _T value)
+                    {
+                        parameters.emplace(key, std::to_string(value));
+                    }
+                };
+
+                cURLDriver()
+                {
+                    m_curlInstance = cURLRuntime::getInstance().acquireHandle();
+                }
+
+                ~cURLDriver()
+                {
+                    if (m_curlInstance)
+                    {
+                        cURLRuntime::getInstance().releaseHandle(m_curlInstance);
+                        m_curlInstance = nullptr;
+                    }
+                }
+
+                void setProxy(const std::string& proxyURI)
+                {
+                    m_proxyURI = proxyURI;
+                }
+
+                [[nodiscard]] CompressionPolicy& getCompressionPolicy() { return m_compression; }
+
+                std::string performHttpRequestWithResultAsString(const URL& url, const Parameters& parameters)
+                {
+                    auto buffer = cURLRuntime::getInstance().acquireResponseBuffer();
+                    performHttpRequest(url, parameters, buffer);
+
+                    std::string response = buffer.toString();
+                    cURLRuntime::getInstance().releaseResponseBuffer(std::move(buffer));
+
+                    return response;
+                }
+
+                std::string performHttpRequestWithAttachedFile(const URL& url, const Parameters& parameters, const std::string& localFilePath)
+                {
+                    curl_httppost* formPost = nullptr;
+                    curl_httppost* formEnd  = nullptr;
+
+                    /**
+                     * @note Cover this code with some 'pretty' abstraction layer.
+                     * @todo Remove hardcoded tag 'video'. This function must support any type of contents!
+                     */
+                    curl_formadd(&formPost, &formEnd, CURLFORM_COPYNAME, "video", CURLFORM_CONTENTTYPE, "video/mpeg", CURLFORM_FILE, localFilePath.c_str(), CURLFORM_END);
+
+                    for (const auto& [key, value] : parameters)
+                    {
+                        curl_formadd(&formPost, &formEnd, CURLFORM_COPYNAME, key.c_str(), CURLFORM_COPYCONTENTS, value.c_str(), CURLFORM_END);
+                    }
+
+                    curl_easy_setopt(m_curlInstance, CURLOPT_HTTPPOST, formPost);
+
+                    return performHttpRequestWithResultAsString(url, {});
+                }
+
+                nlohmann::json performHttpRequestWithResultAsJson(const URL& url, const Parameters& parameters)
+                {
+                    auto buffer = cURLRuntime::getInstance().acquireResponseBuffer();
+                    performHttpRequest(url, parameters, buffer);
+
+                    const auto view = buffer.view();
+                    auto result = nlohmann::json::parse(view.begin(), view.end()); // parse in place, without copy
+                    cURLRuntime::getInstance().releaseResponseBuffer(std::move(buffer));
+
+                    return result;
+                }
+
+                void performHttpRequestWithoutResponse(const URL& url, const Parameters& parameters)
+                {
+                    if (!m_proxyURI.empty())
+                        curl_easy_setopt(m_curlInstance, CURLOPT_PROXY, m_proxyURI.c_str());
+
+                    TLPollEngine::cURLDriver::simpleHttpsRequest(m_curlInstance, url, parameters);
+                }
+
+                /**
+                 * @struct ConnectionTimings
+                 * @brief phases of connection establishment in milliseconds (reported by cURL)
+                 */
+                struct ConnectionTimings
+                {
+                    double nameLookup { 0.0 };
+                    double connect { 0.0 };         ///< TCP connect (and proxy) after name lookup
+                    double tlsHandshake { 0.0 };
+                };
+
+                /**
+                 * @fn preconnect
+                 * @brief resolve host of url and perform TLS handshake without request. Address and TLS session are kept
+                 *        in shared caches of cURLRuntime, so next connections to the host skip DNS and resume TLS session
+                 * @throws std::runtime_error when connection could not be established
+                 */
+                ConnectionTimings preconnect(const URL& url)
+                {
+                    CURL* engine = cURLRuntime::getInstance().acquireHandle(); // connect-only connection can't be reused, so own handle is used
+
+                    if (!m_proxyURI.empty())
+                        curl_easy_setopt(engine, CURLOPT_PROXY, m_proxyURI.c_str());
+
+                    curl_easy_setopt(engine, CURLOPT_CONNECTTIMEOUT, cURLDriver::ConnectionTimeout);
+                    curl_easy_setopt(engine, CURLOPT_URL, url.c_str());
+                    curl_easy_setopt(engine, CURLOPT_CONNECT_ONLY, 1L);
+
+                    const CURLcode result = curl_easy_perform(engine);
+
+                    curl_off_t nameLookupTime = 0;
+                    curl_off_t connectTime = 0;
+                    curl_off_t tlsHandshakeTime = 0;
+                    curl_easy_getinfo(engine, CURLINFO_NAMELOOKUP_TIME_T, &nameLookupTime);
+                    curl_easy_getinfo(engine, CURLINFO_CONNECT_TIME_T, &connectTime);
+                    curl_easy_getinfo(engine, CURLINFO_APPCONNECT_TIME_T, &tlsHandshakeTime);
+
+                    cURLRuntime::getInstance().releaseHandle(engine);
+
+                    if (result != CURLE_OK)
+                        throw std::runtime_error(fmt::format("[cURLDriver::preconnect] unable to connect to {}: {}", url, curl_easy_strerror(result)));
+
+                    // cURL reports time from start of transfer, phases are measured from end of previous one
+                    ConnectionTimings timings {};
+                    timings.nameLookup = static_cast<double>(nameLookupTime) / 1000.0;
+                    timings.connect = static_cast<double>(connectTime - nameLookupTime) / 1000.0;
+                    timings.tlsHandshake = tlsHandshakeTime > 0 ? static_cast<double>(tlsHandshakeTime - connectTime) / 1000.0 : 0.0;
+
+                    return timings;
+                }
+
+            protected:
+                void performHttpRequest(const URL& url, const Parameters& parameters, ResponseBuffer& buffer)
+                {
+                    if (!m_proxyURI.empty())
+                        curl_easy_setopt(m_curlInstance, CURLOPT_PROXY, m_proxyURI.c_str());
+
+                    m_compression.apply(m_curlInstance, url);
+
+                    TLPollEngine::cURLDriver::httpsRequest(m_curlInstance, url, parameters, buffer);
+                }
+
+                static constexpr const size_t ConnectionTimeout = 5; //5 seconds, after that time we will throw telegram::exceptions::DeadWall exception
+
+                static std::string mapToParamsString(const Parameters& parameters)
+                {
+                    if (parameters.empty())
+                        return "";
+
+                    std::string result = "?";
+
+                    for (const auto& [key, value] : parameters)
+                    {
+                        char* escaped_key   = curl_easy_escape(nullptr, key.c_str(), key.length());
+                        char* escaped_value = curl_easy_escape(nullptr, value.c_str(), value.length());
+
+                        result += fmt::format("{}={}&", escaped_key, escaped_value);
+
+                        // Free chunks (that memory was allocated by cURL, we must free it here)
+                        curl_free(escaped_key);
+                        curl_free(escaped_value);
+                    }
+
+                    result.pop_back();  //remove last & character
+
+                    return result;
+                }
+
+                static void httpsRequest(CURL* engine, const URL& url, const Parameters& parameters, ResponseBuffer& buffer)
+                {
+                    const auto paramsString = cURLDriver::mapToParamsString(parameters);
+
+                    curl_easy_setopt(engine, CURLOPT_CONNECTTIMEOUT, cURLDriver::ConnectionTimeout);
+                    curl_easy_setopt(engine, CURLOPT_URL, (url + paramsString).c_str());
+                    curl_easy_setopt(engine, CURLOPT_WRITEFUNCTION, ResponseBuffer::onWrite);
+                    curl_easy_setopt(engine, CURLOPT_WRITEDATA, (void *)&buffer);
+                    curl_easy_setopt(engine, CURLOPT_HEADERFUNCTION, ResponseBuffer::onHeader);
+                    curl_easy_setopt(engine, CURLOPT_HEADERDATA, (void *)&buffer);
+                    curl_easy_setopt(engine, CURLOPT_USERAGENT, "libcurl-agent/1.0"); // Maybe we should use here tag from configs?
+
+                    spdlog::info("[cURLDriver::httpsRequest] perform GET request with await result to {}", (url + paramsString).c_str());
+
+                    auto result = curl_easy_perform(engine);
+
+                    if (result != CURLE_OK)
+                    {
+                        if (result == CURLE_OPERATION_TIMEOUTED)
+                            throw telegram::exceptions::DeadWall();
+
+                        throw std::runtime_error("[with-response] Failed to get response from url " + url);
+                    }
+
+                    spdlog::info("[cURLDriver::httpsRequest] response \"{}\"", buffer.view());
+
+                    cURLRuntime::getInstance().resetHandle(engine);
+                }
+
+                static void simpleHttpsRequest(CURL* engine, const URL& url, const Parameters& parameters)
+                {
+                    const auto paramsString = cURLDriver::mapToParamsString(parameters);
+
+                    curl_easy_setopt(engine, CURLOPT_CONNECTTIMEOUT, cURLDriver::ConnectionTimeout);
+                    curl_easy_setopt(engine, CURLOPT_URL, (url + paramsString).c_str());
+                    curl_easy_setopt(engine, CURLOPT_USERAGENT, "libcurl-agent/1.0");
+
+                    spdlog::info("[cURLDriver::simpleHttpsRequest] perform GET request to {}", (url + paramsString).c_str());
+
+                    auto result = curl_easy_perform(engine);
+                    cURLRuntime::getInstance().resetHandle(engine);
+
+                    if (result != CURLE_OK)
+                    {
+                        if (result == CURLE_OPERATION_TIMEOUTED)
+                            throw telegram::exceptions::DeadWall();
+
+                        throw std::runtime_error("[simple] Failed to get response from url " + url);
+                    }
+                }
+            };
+
+            /**
+             * @class RequestBody
+             * @brief Serializer of API call parameters.
+             *        Parameters are escaped and written straight into (reusable) buffer without temporary strings.
+             *        In QueryString mode buffer contains "?key=value&..." suffix for URL, in other modes it's a POST body.
+             */
+            class RequestBody
+            {
+            public:
+                enum class Mode
+                {
+                    QueryString,
+                    FormUrlEncoded,     ///< application/x-www-form-urlencoded POST body
+                    Json                ///< application/json POST body
+                };
+
+            private:
+                Mode m_mode { Mode::Json };
+                std::string m_buffer {};
+                bool m_isFinished { false };
+
+            public:
+                RequestBody() = default;
+
+                RequestBody(Mode mode, std::string&& buffer)
+                    : m_mode(mode)
+                    , m_buffer(std::move(buffer))
+                {
+                    m_buffer.clear();
+                }
+
+                [[nodiscard]] Mode getMode() const { return m_mode; }
+                [[nodiscard]] bool isPost() const { return m_mode != Mode::QueryString; }
+
+                RequestBody& add(std::string_view key, std::string_view value)
+                {
+                    writeKey(key);
+
+                    if (m_mode == Mode::Json)
+                    {
+                        m_buffer.push_back('"');
+                        writeJsonEscaped(value);
+                        m_buffer.push_back('"');
+                    }
+                    else
+                    {
+                        writeUrlEscaped(value);
+                    }
+
+                    return *this;
+                }
+
+                template <typename _T, typename = std::enable_if_t<std::is_integral_v<_T>>>
+                RequestBody& add(std::string_view key, _T value)
+                {
+                    writeKey(key);
+                    fmt::format_to(std::back_inserter(m_buffer), "{}", value);
+
+                    return *this;
+                }
+
+                /**
+                 * @fn finish
+                 * @brief close serialized object. Must be called once after all parameters were added
+                 */
+                const std::string& finish()
+                {
+                    if (!m_isFinished && m_mode == Mode::Json)
+                    {
+                        if (m_buffer.empty())
+                            m_buffer.push_back('{');
+
+                        m_buffer.push_back('}');
+                    }
+
+                    m_isFinished = true;
+                    return m_buffer;
+                }
+
+                [[nodiscard]] const std::string& data() const { return m_buffer; }
+
+                /**
+                 * @fn release
+                 * @brief take buffer back (for reuse), body becomes empty
+                 */
+                std::string release()
+                {
+                    m_isFinished = false;
+                    return std::move(m_buffer);
+                }
+
+            private:
+                void writeKey(std::string_view key)
+                {
+                    if (m_mode == Mode::Json)
+                    {
+                        m_buffer.push_back(m_buffer.empty() ? '{' : ',');
+                        m_buffer.push_back('"');
+                        writeJsonEscaped(key);
+                        m_buffer.append("\":");
+                    }
+                    else
+                    {
+                        if (m_mode == Mode::QueryString)
+                            m_buffer.push_back(m_buffer.empty() ? '?' : '&');
+                        else if (!m_buffer.empty())
+                            m_buffer.push_back('&');
+
+                        writeUrlEscaped(key);
+                        m_buffer.push_back('=');
+                    }
+                }
+
+                void writeJsonEscaped(std::string_view value)
+                {
+                    static constexpr const char* HexDigits = "0123456789abcdef";
+
+                    for (const char ch : value)
+                    {
+                        switch (ch)
+                        {
+                            case '"':  m_buffer.append("\\\""); break;
+                            case '\\': m_buffer.append("\\\\"); break;
+                            case '\n': m_buffer.append("\\n"); break;
+                            case '\r': m_buffer.append("\\r"); break;
+                            case '\t': m_buffer.append("\\t"); break;
+                            default:
+                                if (static_cast<unsigned char>(ch) < 0x20)
+                                {
+                                    m_buffer.append("\\u00");
+                                    m_buffer.push_back(HexDigits[(ch >> 4) & 0xF]);
+                                    m_buffer.push_back(HexDigits[ch & 0xF]);
+                                }
+                                else
+                                {
+                                    m_buffer.push_back(ch); //UTF-8 sequences are passed as is
+                                }
+                        }
+                    }
+                }
+
+                void writeUrlEscaped(std::string_view value)
+                {
+                    static constexpr const char* HexDigits = "0123456789ABCDEF";
+
+                    for (const char ch : value)
+                    {
+                        const auto code = static_cast<unsigned char>(ch);
+
+                        if (std::isalnum(code) || ch == '-' || ch == '_' || ch == '.' || ch == '~')
+                        {
+                            m_buffer.push_back(ch);
+                        }
+                        else
+                        {
+                            m_buffer.push_back('%');
+                            m_buffer.push_back(HexDigits[code >> 4]);
+                            m_buffer.push_back(HexDigits[code & 0xF]);
+                        }
+                    }
+                }
+            };
+
+            /**
+             * @class UpdatesStreamParser
+             * @brief Incremental splitter of getUpdates response.
+             *        Bytes are fed as they arrive from network. Every element of "result" array is passed to
+             *        OnElement callback as soon as its object closes (raw JSON of single update).
+             *        Everything outside of the result array (the envelope: "ok", "error_code", ...) is kept
+             *        and could be parsed by finish() when response is completed.
+             */
+            class UpdatesStreamParser
+            {
+            public:
+                using OnElement = std::function<void(std::string_view)>;
+
+            private:
+                static constexpr const size_t ResultArrayDepth = 2;
+
+                OnElement m_onElement;
+                std::string m_envelope {};
+                std::string m_element {};           ///< Used only when element splitted between several chunks
+                std::string m_lastString {};
+                std::string m_currentKey {};
+                size_t m_depth { 0 };
+                size_t m_elementsCount { 0 };
+                bool m_isInString { false };
+                bool m_isEscaped { false };
+                bool m_isInResultArray { false };
+                bool m_isInElement { false };
+
+            public:
+                explicit UpdatesStreamParser(OnElement onElement)
+                    : m_onElement(std::move(onElement))
+                {
+                }
+
+                void feed(std::string_view chunk)
+                {
+                    size_t elementBegin = m_isInElement ? 0 : std::string_view::npos;
+
+                    for (size_t i = 0; i < chunk.size(); ++i)
+                    {
+                        const char ch = chunk[i];
+
+                        if (m_isInString)
+                        {
+                            if (m_isEscaped)
+                                m_isEscaped = false;
+                            else if (ch == '\\')
+                                m_isEscaped = true;
+                            else if (ch == '"')
+                                m_isInString = false;
+                            else if (m_depth == 1)
+                                m_lastString.push_back(ch);
+
+                            if (!m_isInElement)
+                                m_envelope.push_back(ch);
+
+                            continue;
+                        }
+
+                        switch (ch)
+                        {
+                            case '"':
+                                m_isInString = true;
+
+                                if (m_depth == 1)
+                                    m_lastString.clear();
+                                break;
+                            case ':':
+                                if (m_depth == 1)
+                                    m_currentKey = m_lastString;
+                                break;
+                            case '{':
+                            case '[':
+                                if (m_isInResultArray && m_depth == UpdatesStreamParser::ResultArrayDepth)
+                                {
+                                    m_isInElement = true;
+                                    elementBegin = i;
+                                }
+
+                                ++m_depth;
+
+                                if (ch == '[' && m_depth == UpdatesStreamParser::ResultArrayDepth && m_currentKey == "result")
+                                    m_isInResultArray = true;
+                                break;
+                            case '}':
+                            case ']':
+                                --m_depth;
+
+                                if (m_isInElement && m_depth == UpdatesStreamParser::ResultArrayDepth)
+                                {
+                                    emitElement(chunk.substr(elementBegin, i + 1 - elementBegin));
+                                    elementBegin = std::string_view::npos;
+                                    continue;
+                                }
+
+                                if (m_isInResultArray && m_depth < UpdatesStreamParser::ResultArrayDepth)
+                                    m_isInResultArray = false;
+                                break;
+                            case ',':
+                                if (m_isInResultArray && m_depth == UpdatesStreamParser::ResultArrayDepth)
+                                    continue; // separator between elements is not a part of envelope
+                                break;
+                            default:
+                                break;
+                        }
+
+                        if (!m_isInElement)
+                            m_envelope.push_back(ch);
+                    }
+
+                    if (m_isInElement)
+                        m_element.append(chunk.substr(elementBegin));
+                }
+
+                /**
+                 * @fn finish
+                 * @brief parse envelope of response (result array is empty here, all elements were passed to OnElement)
+                 */
+                nlohmann::json finish() const
+                {
+                    return nlohmann::json::parse(m_envelope);
+                }
+
+                [[nodiscard]] size_t getElementsCount() const { return m_elementsCount; }
+
+            private:
+                void emitElement(std::string_view tail)
+                {
+                    m_isInElement = false;
+                    ++m_elementsCount;
+
+                    if (m_element.empty())
+                    {
+                        m_onElement(tail); // whole element is inside current chunk, pass it without copy
+                        return;
+                    }
+
+                    m_element.append(tail);
+                    m_onElement(m_element);
+                    m_element.clear();
+                }
+            };
+
+            /**
+             * @class MethodLatencies
+             * @brief Latency histogram per TLAPI method (method is taken from request url), histogram is created on first request of method.
+             *        Recorded on loop thread, snapshots could be taken from any thread
+             */
+            class MethodLatencies
+            {
+                mutable std::mutex m_lock {};
+                std::map<std::string, std::unique_ptr<LatencyHistogram>, std::less<>> m_histograms {};
+
+            public:
+                using Snapshots = std::vector<std::pair<std::string, LatencyHistogram::Snapshot>>;
+
+                void record(std::string_view url, std::chrono::microseconds latency)
+                {
+                    const auto method = getMethodName(url);
+
+                    std::lock_guard<std::mutex> guard { m_lock };
+
+                    auto iter = m_histograms.find(method);
+                    if (iter == std::end(m_histograms))
+                        iter = m_histograms.emplace(std::string(method), std::make_unique<LatencyHistogram>()).first;
+
+                    iter->second->record(latency);
+                }
+
+                [[nodiscard]] Snapshots getSnapshots() const
+                {
+                    std::lock_guard<std::mutex> guard { m_lock };
+
+                    Snapshots snapshots {};
+                    snapshots.reserve(m_histograms.size());
+
+                    for (const auto& [method, histogram] : m_histograms)
+                        snapshots.emplace_back(method, histogram->getSnapshot());
+
+                    return snapshots;
+                }
+
+                /**
+                 * @fn getMethodName
+                 * @brief ".../bot<token>/sendMessage?chat_id=1" -> "sendMessage"
+                 */
+                static std::string_view getMethodName(std::string_view url)
+                {
+                    url = url.substr(0, url.find('?'));
+
+                    const size_t position = url.rfind('/');
+                    return position == std::string_view::npos ? url : url.substr(position + 1);
+                }
+            };
+
+            /**
+             * @class cURLMultiDriver
+             * @brief Asynchronous transport based on curl_multi.
+             *        Every request is registered as separate transfer and all transfers are driven together by poll(),
+             *        so long-poll and outcoming requests are in flight at the same time.
+             *        Completion callbacks are invoked from poll() (on the engine thread).
+             */
+            class cURLMultiDriver
+            {
+            public:
+                using URL = cURLDriver::URL;
+                using Parameters = cURLDriver::Parameters;
+                using OnCompleted = std::function<void(CURLcode, const ResponseBuffer&)>;
+                using OnData = std::function<void(std::string_view)>;
+                using OrderingKey = uint64_t;   ///< Requests with the same key are sent one by one in order of enqueue
+
+                static constexpr const OrderingKey NoOrdering = 0;
+                static constexpr const size_t DefaultMaxConcurrentRequests = 8;
+                static constexpr const size_t DefaultMaxHostConnections = 2; ///< Used only in HTTP/2 mode, all streams are multiplexed over these connections
+                static constexpr const size_t MaxPooledBodyBuffers = 32;
+
+                enum class HttpVersion
+                {
+                    Http1,                  ///< HTTP/1.1, one request per connection at a time
+                    Http2,                  ///< HTTP/2 over TLS (negotiated by ALPN, fallback to HTTP/1.1 when server does not agree)
+                    Http2PriorKnowledge     ///< HTTP/2 without negotiation (useful for local cleartext h2 servers)
+                };
+
+                struct Statistics
+                {
+                    uint64_t completedRequests { 0 };
+                    uint64_t failedRequests { 0 };
+                    uint64_t http2Requests { 0 };       ///< Requests completed as HTTP/2 streams
+                    uint64_t http1Requests { 0 };       ///< Requests completed over HTTP/1.x (include fallbacks when h2 was requested)
+                    uint64_t http1Fallbacks { 0 };      ///< Requests where h2 was requested but HTTP/1.x was negotiated
+                    uint64_t responseBufferAllocations { 0 };   ///< Total allocations made by response buffers
+                    uint64_t responseBufferCopies { 0 };        ///< Total full copies of response bodies
+                    uint64_t compressedResponses { 0 };         ///< Responses with Content-Encoding gzip/deflate
+                    uint64_t wireBytes { 0 };                   ///< Body bytes received from network
+                    uint64_t decodedBytes { 0 };                ///< Body bytes after decoding
+                    uint64_t decodingTime { 0 };                ///< Nanoseconds spent in inflate
+                };
+
+            private:
+                struct Transfer
+                {
+                    CURL* handle { nullptr };
+                    uint64_t requestId { 0 };       ///< Sequential number of request, identifies transfer in logs
+                    OrderingKey orderingKey { NoOrdering };
+                    bool isHttp2Requested { false };
+                    URL url;
+                    RequestBody body;
+                    curl_mime* mimePost { nullptr };
+                    ResponseBuffer buffer;
+                    OnCompleted onCompleted;
+                    OnData onData;                  ///< When set, response is streamed here instead of buffer
+                    std::exception_ptr streamError;
+                    std::chrono::steady_clock::time_point enqueuedAt { std::chrono::steady_clock::now() };
+
+                    ~Transfer()
+                    {
+                        if (handle)
+                            cURLRuntime::getInstance().releaseHandle(handle);
+
+                        if (mimePost)
+                            curl_mime_free(mimePost);
+
+                        cURLRuntime::getInstance().releaseResponseBuffer(std::move(buffer));
+                    }
+                };
+
+                using TransferPtr = std::unique_ptr<Transfer>;
+
+                CURLM* m_multiInstance { nullptr };
+                std::string m_proxyURI;
+                size_t m_maxConcurrentRequests { DefaultMaxConcurrentRequests };
+                size_t m_maxHostConnections { DefaultMaxHostConnections };
+                HttpVersion m_httpVersion { HttpVersion::Http1 };
+                bool m_isHttp1Fallback { false };   ///< h2 was requested but server negotiated HTTP/1.1, HTTP/1.1 limits are in effect
+                uint64_t m_lastRequestId { 0 };
+                RequestBody::Mode m_requestBodyMode { RequestBody::Mode::Json };
+                std::vector<std::string> m_bodyBuffersPool;
+                curl_slist* m_jsonHeaders { nullptr };
+                curl_slist* m_formHeaders { nullptr };
+                Statistics m_statistics {};
+                MethodLatencies m_methodLatencies {};
+                CompressionPolicy m_compression {};
+                std::queue<TransferPtr> m_pendingTransfers;
+                std::unordered_map<OrderingKey, std::queue<TransferPtr>> m_orderedTransfers;  ///< Keys with transfer in flight, later transfers of key wait here
+                size_t m_waitingOrderedTransfers { 0 };
+                std::unordered_map<CURL*, TransferPtr> m_activeTransfers;
+
+            public:
+                cURLMultiDriver()
+                {
+                    cURLRuntime::getInstance(); //make sure that cURL initialized
+                    m_multiInstance = curl_multi_init();
+                    applyConnectionLimits();
+
+                    // Empty "Expect:" disables "100-continue" round-trip which cURL adds for large POST bodies
+                    m_jsonHeaders = curl_slist_append(m_jsonHeaders, "Content-Type: application/json");
+                    m_jsonHeaders = curl_slist_append(m_jsonHeaders, "Expect:");
+                    m_formHeaders = curl_slist_append(m_formHeaders, "Content-Type: application/x-www-form-urlencoded");
+                    m_formHeaders = curl_slist_append(m_formHeaders, "Expect:");
+                }
+
+                ~cURLMultiDriver()
+                {
+                    for (auto& [handle, transfer] : m_activeTransfers)
+                        curl_multi_remove_handle(m_multiInstance, handle);
+
+                    m_activeTransfers.clear();
+
+                    if (m_multiInstance)
+                    {
+                        curl_multi_cleanup(m_multiInstance);
+                        m_multiInstance = nullptr;
+                    }
+
+                    curl_slist_free_all(m_jsonHeaders);
+                    curl_slist_free_all(m_formHeaders);
+                }
+
+                void setProxy(const std::string& proxyURI)
+                {
+                    m_proxyURI = proxyURI;
+                }
+
+                [[nodiscard]] CompressionPolicy& getCompressionPolicy() { return m_compression; }
+
+                void setMaxConcurrentRequests(size_t maxConcurrentRequests)
+                {
+                    m_maxConcurrentRequests = std::max<size_t>(maxConcurrentRequests, 1);
+                    applyConnectionLimits();
+                }
+
+                /**
+                 * @fn setHttpVersion
+                 * @brief in HTTP/2 modes all requests to the same host are multiplexed as streams over
+                 *        at most maxHostConnections connections. Affects only requests enqueued after this call
+                 * @note when server answers h2 request over HTTP/1.1 the driver switches to HTTP/1.1 limits
+                 *       (up to maxConcurrentRequests connections, no multiplexing) until next call of setHttpVersion
+                 */
+                void setHttpVersion(HttpVersion version, size_t maxHostConnections = DefaultMaxHostConnections)
+                {
+                    m_httpVersion = version;
+                    m_maxHostConnections = std::max<size_t>(maxHostConnections, 1);
+                    m_isHttp1Fallback = false;
+
+                    applyConnectionLimits();
+                }
+
+                /**
+                 * @fn setRequestBodyMode
+                 * @brief how parameters of API calls will be passed: as URL query string or as POST body (json/urlencoded)
+                 */
+                void setRequestBodyMode(RequestBody::Mode mode)
+                {
+                    m_requestBodyMode = mode;
+                }
+
+                [[nodiscard]] RequestBody::Mode getRequestBodyMode() const { return m_requestBodyMode; }
+
+                /**
+                 * @fn createRequestBody
+                 * @brief create empty body in current mode. Buffer is taken from pool of already allocated buffers
+                 */
+                RequestBody createRequestBody()
+                {
+                    std::string buffer {};
+
+                    if (!m_bodyBuffersPool.empty())
+                    {
+                        buffer = std::move(m_bodyBuffersPool.back());
+                        m_bodyBuffersPool.pop_back();
+                    }
+
+                    return RequestBody { m_requestBodyMode, std::move(buffer) };
+                }
+
+                [[nodiscard]] HttpVersion getHttpVersion() const { return m_httpVersion; }
+                [[nodiscard]] bool isHttp1Fallback() const { return m_isHttp1Fallback; }
+                [[nodiscard]] const Statistics& getStatistics() const { return m_statistics; }
+                [[nodiscard]] MethodLatencies::Snapshots getMethodLatencies() const { return m_methodLatencies.getSnapshots(); }
+
+                [[nodiscard]] size_t getActiveRequestsCount() const { return m_activeTransfers.size(); }
+                [[nodiscard]] size_t getPendingRequestsCount() const { return m_pendingTransfers.size() + m_waitingOrderedTransfers; }
+                [[nodiscard]] bool isIdle() const { return m_activeTransfers.empty() && m_pendingTransfers.empty() && m_orderedTransfers.empty(); }
+
+                /**
+                 * @fn makeOrderingKey
+                 * @brief key of requests of one bot (identified by method url prefix) to one chat
+                 * @note collision of keys never reorders requests, it only makes them wait for each other
+                 */
+                [[nodiscard]] static OrderingKey makeOrderingKey(std::string_view apiUrl, int64_t chatId)
+                {
+                    const OrderingKey key = std::hash<std::string_view>{}(apiUrl) * 31 + static_cast<OrderingKey>(chatId);
+                    return key == NoOrdering ? 1 : key;
+                }
+
+                /**
+                 * @fn performHttpRequestAsync
+                 * @brief register GET request. onCompleted (could be empty) will be called from poll() when request finished
+                 */
+                void performHttpRequestAsync(const URL& url, const Parameters& parameters, OnCompleted onCompleted = nullptr)
+                {
+                    auto transfer = createTransfer(url, parameters, std::move(onCompleted));
+
+                    if (spdlog::should_log(spdlog::level::debug))
+                        spdlog::debug("[cURLMultiDriver::performHttpRequestAsync] enqueue GET request to {}", redactUrl(transfer->url));
+
+                    enqueue(std::move(transfer));
+                }
+
+                /**
+                 * @fn performApiRequestAsync
+                 * @brief register API call. Parameters are passed by body created via createRequestBody
+                 * @note when onData passed response body is not buffered, every received chunk is passed to onData
+                 *       directly from cURL write callback. Exception from onData aborts transfer: it is logged and
+                 *       onCompleted gets CURLE_WRITE_ERROR
+                 * @note requests with the same orderingKey (see makeOrderingKey) are not in flight together:
+                 *       the next one is started only when previous one is completed
+                 */
+                void performApiRequestAsync(const URL& url, RequestBody&& body, OnCompleted onCompleted = nullptr, OnData onData = nullptr, OrderingKey orderingKey = NoOrdering)
+                {
+                    auto transfer = createTransfer(url, {}, std::move(onCompleted));
+                    transfer->body = std::move(body);
+                    transfer->orderingKey = orderingKey;
+
+                    if (onData)
+                    {
+                        transfer->onData = std::move(onData);
+                        curl_easy_setopt(transfer->handle, CURLOPT_WRITEFUNCTION, cURLMultiDriver::onStreamWrite);
+                        curl_easy_setopt(transfer->handle, CURLOPT_WRITEDATA, (void *)transfer.get());
+                    }
+
+                    const std::string& data = transfer->body.finish();
+
+                    if (transfer->body.isPost())
+                    {
+                        curl_easy_setopt(transfer->handle, CURLOPT_POSTFIELDS, data.data()); // no copy here, body lives until transfer completed
+                        curl_easy_setopt(transfer->handle, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(data.size()));
+                        curl_easy_setopt(transfer->handle, CURLOPT_HTTPHEADER, transfer->body.getMode() == RequestBody::Mode::Json ? m_jsonHeaders : m_formHeaders);
+
+                        if (spdlog::should_log(spdlog::level::debug))
+                            spdlog::debug("[cURLMultiDriver::performApiRequestAsync] enqueue POST request to {} (body {} bytes)", redactUrl(transfer->url), data.size());
+                    }
+                    else
+                    {
+                        transfer->url += data;
+                        curl_easy_setopt(transfer->handle, CURLOPT_URL, transfer->url.c_str());
+
+                        if (spdlog::should_log(spdlog::level::debug))
+                            spdlog::debug("[cURLMultiDriver::performApiRequestAsync] enqueue GET request to {}", redactUrl(transfer->url));
+                    }
+
+                    enqueue(std::move(transfer));
+                }
+
+                void performHttpRequestWithAttachedFileAsync(const URL& url, const Parameters& parameters, const std::string& localFilePath, OnCompleted onCompleted = nullptr, OrderingKey orderingKey = NoOrdering)
+                {
+                    auto transfer = createTransfer(url, {}, std::move(onCompleted));
+                    transfer->orderingKey = orderingKey;
+
+                    transfer->mimePost = curl_mime_init(transfer->handle);
+
+                    /**
+                     * @todo Remove hardcoded tag 'video'. This function must support any type of contents!
+                     */
+                    curl_mimepart* filePart = curl_mime_addpart(transfer->mimePost);
+                    curl_mime_name(filePart, "video");
+                    curl_mime_type(filePart, "video/mpeg");
+                    curl_mime_filedata(filePart, localFilePath.c_str());
+
+                    for (const auto& [key, value] : parameters)
+                    {
+                        curl_mimepart* part = curl_mime_addpart(transfer->mimePost);
+                        curl_mime_name(part, key.c_str());
+                        curl_mime_data(part, value.c_str(), CURL_ZERO_TERMINATED);
+                    }
+
+                    curl_easy_setopt(transfer->handle, CURLOPT_MIMEPOST, transfer->mimePost);
+
+                    if (spdlog::should_log(spdlog::level::debug))
+                        spdlog::debug("[cURLMultiDriver::performHttpRequestWithAttachedFileAsync] enqueue POST request to {} with file {}", redactUrl(transfer->url), localFilePath);
+
+                    enqueue(std::move(transfer));
+                }
+
+                /**
+                 * @fn warmUpConnectionAsync
+                 * @brief open connection to host of url by HEAD request without payload.
+                 *        When request completed connection stays in cache and is reused by next requests to the host
+                 */
+                void warmUpConnectionAsync(const URL& url, OnCompleted onCompleted = nullptr)
+                {
+                    auto transfer = createTransfer(url, {}, std::move(onCompleted));
+                    curl_easy_setopt(transfer->handle, CURLOPT_NOBODY, 1L);
+
+                    if (spdlog::should_log(spdlog::level::debug))
+                        spdlog::debug("[cURLMultiDriver::warmUpConnectionAsync] enqueue HEAD request to {}", redactUrl(transfer->url));
+
+                    enqueue(std::move(transfer));
+                }
+
+                /**
+                 * @fn poll
+                 * @brief drive all active transfers and wait for network activity no longer than timeoutMs
+                 * @note completion callbacks are invoked from here. Exceptions from callbacks are passed to the caller
+                 */
+                void poll(int timeoutMs)
+                {
+                    startPendingTransfers();
+
+                    int runningHandles = 0;
+                    curl_multi_perform(m_multiInstance, &runningHandles);
+
+                    processCompletedTransfers();
+                    startPendingTransfers();
+
+                    curl_multi_poll(m_multiInstance, nullptr, 0, timeoutMs, nullptr);
+                }
+
+                /**
+                 * @fn wakeup
+                 * @brief interrupt waiting inside of poll() (the only method of driver which could be called from other thread)
+                 */
+                void wakeup()
+                {
+                    curl_multi_wakeup(m_multiInstance);
+                }
+
+            private:
+                TransferPtr createTransfer(const URL& url, const Parameters& parameters, OnCompleted onCompleted)
+                {
+                    auto transfer = std::make_unique<Transfer>();
+                    transfer->handle = cURLRuntime::getInstance().acquireHandle();
+                    transfer->url = url + cURLDriver::mapToParamsString(parameters);
+                    transfer->buffer = cURLRuntime::getInstance().acquireResponseBuffer();
+                    transfer->onCompleted = std::move(onCompleted);
+
+                    CURL* engine = transfer->handle;
+
+                    if (!m_proxyURI.empty())
+                        curl_easy_setopt(engine, CURLOPT_PROXY, m_proxyURI.c_str());
+
+                    curl_easy_setopt(engine, CURLOPT_CONNECTTIMEOUT, cURLDriver::ConnectionTimeout);
+                    curl_easy_setopt(engine, CURLOPT_URL, transfer->url.c_str());
+                    curl_easy_setopt(engine, CURLOPT_WRITEFUNCTION, ResponseBuffer::onWrite);
+                    curl_easy_setopt(engine, CURLOPT_WRITEDATA, (void *)&transfer->buffer);
+                    curl_easy_setopt(engine, CURLOPT_HEADERFUNCTION, ResponseBuffer::onHeader);
+                    curl_easy_setopt(engine, CURLOPT_HEADERDATA, (void *)&transfer->buffer);
+                    curl_easy_setopt(engine, CURLOPT_USERAGENT, "libcurl-agent/1.0");
+                    curl_easy_setopt(engine, CURLOPT_PRIVATE, transfer.get());
+
+                    m_compression.apply(engine, transfer->url);
+
+                    transfer->requestId = ++m_lastRequestId;
+
+                    if (isMultiplexing())
+                    {
+                        transfer->isHttp2Requested = true;
+
+                        curl_easy_setopt(engine, CURLOPT_HTTP_VERSION, m_httpVersion == HttpVersion::Http2 ? CURL_HTTP_VERSION_2TLS : CURL_HTTP_VERSION_2_PRIOR_KNOWLEDGE);
+                        curl_easy_setopt(engine, CURLOPT_PIPEWAIT, 1L); //prefer to wait for existing connection and multiplex over it
+                    }
+
+                    return transfer;
+                }
+
+                static size_t onStreamWrite(void* contents, size_t size, size_t nmemb, void* userp)
+                {
+                    const size_t realSize = size * nmemb;
+                    auto transfer = reinterpret_cast<Transfer*>(userp);
+
+                    try
+                    {
+                        transfer->buffer.receive(reinterpret_cast<const char*>(contents), realSize, [transfer](const char* data, size_t dataSize) {
+                            transfer->onData(std::string_view { data, dataSize });
+                        });
+                    }
+                    catch (...)
+                    {
+                        transfer->streamError = std::current_exception();
+                        return 0; // abort transfer
+                    }
+
+                    return realSize;
+                }
+
+                void recycleRequestBody(RequestBody& body)
+                {
+                    if (m_bodyBuffersPool.size() < cURLMultiDriver::MaxPooledBodyBuffers)
+                        m_bodyBuffersPool.push_back(body.release());
+                }
+
+                [[nodiscard]] bool isMultiplexing() const
+                {
+                    return m_httpVersion != HttpVersion::Http1 && !m_isHttp1Fallback;
+                }
+
+                void applyConnectionLimits()
+                {
+                    curl_multi_setopt(m_multiInstance, CURLMOPT_PIPELINING, isMultiplexing() ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+
+                    if (!isMultiplexing())
+                    {
+                        curl_multi_setopt(m_multiInstance, CURLMOPT_MAX_HOST_CONNECTIONS, 0L);
+                        curl_multi_setopt(m_multiInstance, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(m_maxConcurrentRequests));
+                    }
+                    else
+                    {
+                        curl_multi_setopt(m_multiInstance, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(m_maxHostConnections));
+                        curl_multi_setopt(m_multiInstance, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(m_maxHostConnections));
+                        curl_multi_setopt(m_multiInstance, CURLMOPT_MAX_CONCURRENT_STREAMS, static_cast<long>(m_maxConcurrentRequests));
+                    }
+                }
+
+                static ResponseBuffer::Timings measureTimings(const Transfer& transfer)
+                {
+                    curl_off_t preTransferTime = 0;
+                    curl_off_t startTransferTime = 0;
+                    curl_off_t totalTime = 0;
+
+                    curl_easy_getinfo(transfer.handle, CURLINFO_PRETRANSFER_TIME_T, &preTransferTime);
+                    curl_easy_getinfo(transfer.handle, CURLINFO_STARTTRANSFER_TIME_T, &startTransferTime);
+                    curl_easy_getinfo(transfer.handle, CURLINFO_TOTAL_TIME_T, &totalTime);
+
+                    ResponseBuffer::Timings timings {};
+                    timings.waiting = std::chrono::microseconds(std::max<curl_off_t>(startTransferTime - preTransferTime, 0));
+                    timings.downloading = std::chrono::microseconds(std::max<curl_off_t>(totalTime - startTransferTime, 0));
+                    timings.total = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - transfer.enqueuedAt);
+
+                    return timings;
+                }
+
+                void trackCompletion(const Transfer& transfer, CURLcode result)
+                {
+                    ++m_statistics.completedRequests;
+                    m_methodLatencies.record(transfer.url, transfer.buffer.getTimings().total);
+
+                    if (result != CURLE_OK)
+                    {
+                        ++m_statistics.failedRequests;
+                        return;
+                    }
+
+                    const ResponseBuffer& buffer = transfer.buffer;
+
+                    m_statistics.wireBytes += buffer.getWireBytes();
+                    m_statistics.decodedBytes += buffer.getDecodedBytes();
+
+                    if (buffer.isEncoded())
+                    {
+                        const auto decodingTime = buffer.getDecodingTime();
+
+                        ++m_statistics.compressedResponses;
+                        m_statistics.decodingTime += decodingTime.count();
+
+                        if (spdlog::should_log(spdlog::level::debug))
+                        {
+                            spdlog::debug("[cURLMultiDriver::poll] {}: {} bytes on wire, {} decoded, inflate {:.1f} us", redactUrl(transfer.url),
+                                          buffer.getWireBytes(), buffer.getDecodedBytes(), std::chrono::duration<double, std::micro>(decodingTime).count());
+                        }
+                    }
+
+                    long negotiatedVersion = CURL_HTTP_VERSION_NONE;
+                    curl_easy_getinfo(transfer.handle, CURLINFO_HTTP_VERSION, &negotiatedVersion);
+
+                    if (negotiatedVersion == CURL_HTTP_VERSION_2_0)
+                    {
+                        ++m_statistics.http2Requests;
+                        spdlog::debug("[cURLMultiDriver::poll] request {} completed over HTTP/2", transfer.requestId);
+                        return;
+                    }
+
+                    ++m_statistics.http1Requests;
+
+                    if (!transfer.isHttp2Requested)
+                        return;
+
+                    ++m_statistics.http1Fallbacks;
+
+                    if (!m_isHttp1Fallback && m_httpVersion != HttpVersion::Http1)
+                    {
+                        // limits of h2 (few connections with many streams) would serialize HTTP/1.1 requests over maxHostConnections
+                        m_isHttp1Fallback = true;
+                        applyConnectionLimits();
+
+                        spdlog::warn("[cURLMultiDriver::poll] server does not agree on h2, fallback to HTTP/1.1 (request {}), up to {} connections",
+                                     transfer.requestId, m_maxConcurrentRequests);
+                    }
+                }
+
+                void enqueue(TransferPtr&& transfer)
+                {
+                    if (transfer->orderingKey != NoOrdering)
+                    {
+                        auto [iter, isFirst] = m_orderedTransfers.try_emplace(transfer->orderingKey);
+
+                        if (!isFirst)
+                        {
+                            // previous request of the key is in flight or pending
+                            iter->second.push(std::move(transfer));
+                            ++m_waitingOrderedTransfers;
+                            return;
+                        }
+                    }
+
+                    m_pendingTransfers.push(std::move(transfer));
+                    startPendingTransfers();
+                }
+
+                /**
+                 * @fn releaseOrderingKey
+                 * @brief request of key is completed: make the next request of key pending or forget key
+                 */
+                void releaseOrderingKey(OrderingKey orderingKey)
+                {
+                    if (orderingKey == NoOrdering)
+                        return;
+
+                    auto iter = m_orderedTransfers.find(orderingKey);
+                    if (iter == std::end(m_orderedTransfers))
+                        return;
+
+                    if (iter->second.empty())
+                    {
+                        m_orderedTransfers.erase(iter);
+                        return;
+                    }
+
+                    m_pendingTransfers.push(std::move(iter->second.front()));
+                    iter->second.pop();
+                    --m_waitingOrderedTransfers;
+                }
+
+                void startPendingTransfers()
+                {
+                    while (!m_pendingTransfers.empty() && m_activeTransfers.size() < m_maxConcurrentRequests)
+                    {
+                        auto transfer = std::move(m_pendingTransfers.front());
+                        m_pendingTransfers.pop();
+
+                        CURL* handle = transfer->handle;
+                        curl_multi_add_handle(m_multiInstance, handle);
+                        m_activeTransfers.emplace(handle, std::move(transfer));
+                    }
+                }
+
+                void processCompletedTransfers()
+                {
+                    int messagesInQueue = 0;
+
+                    while (CURLMsg* message = curl_multi_info_read(m_multiInstance, &messagesInQueue))
+                    {
+                        if (message->msg != CURLMSG_DONE)
+                            continue;
+
+                        CURL* handle = message->easy_handle;
+                        const CURLcode result = message->data.result;
+
+                        curl_multi_remove_handle(m_multiInstance, handle);
+
+                        auto iter = m_activeTransfers.find(handle);
+                        if (iter == std::end(m_activeTransfers))
+                            continue;
+
+                        TransferPtr transfer = std::move(iter->second);
+                        m_activeTransfers.erase(iter);
+                        releaseOrderingKey(transfer->orderingKey);
+
+                        transfer->buffer.setTimings(measureTimings(*transfer));
+                        trackCompletion(*transfer, result);
+                        recycleRequestBody(transfer->body);
+
+                        m_statistics.responseBufferAllocations += transfer->buffer.getAllocationsCount();
+                        m_statistics.responseBufferCopies += transfer->buffer.getCopiesCount();
+
+                        if (transfer->streamError)
+                            spdlog::error("[cURLMultiDriver::poll] stream of {} failed: {}", redactUrl(transfer->url), describeException(transfer->streamError));
+                        else if (result != CURLE_OK)
+                            spdlog::error("[cURLMultiDriver::poll] request to {} failed: {}", redactUrl(transfer->url), curl_easy_strerror(result));
+
+                        // failed stream is completed as write error, so owner of request always resets its state
+                        if (transfer->onCompleted)
+                            transfer->onCompleted(transfer->streamError ? CURLE_WRITE_ERROR : result, transfer->buffer);
+                    }
+                }
+
+                /**
+                 * @fn redactUrl
+                 * @return url with token of bot replaced by placeholder, urls are logged but token must not be
+                 */
+                static std::string redactUrl(std::string_view url)
+                {
+                    const size_t tokenBegin = url.find("/bot");
+                    if (tokenBegin == std::string_view::npos)
+                        return std::string(url);
+
+                    const size_t tokenEnd = url.find('/', tokenBegin + 4);
+                    return fmt::format("{}<token>{}", url.substr(0, tokenBegin + 4), tokenEnd == std::string_view::npos ? std::string_view {} : url.substr(tokenEnd));
+                }
+
+                static std::string describeException(const std::exception_ptr& error)
+                {
+                    try
+                    {
+                        std::rethrow_exception(error);
+                    }
+                    catch (const std::exception& exception)
+                    {
+                        return exception.what();
+                    }
+                    catch (...)
+                    {
+                        return "unknown exception";
+                    }
+                }
+            };
+
+            class TLOutcomingAction
+            {
+            public:
+                std::chrono::steady_clock::time_point enqueuedAt {};
+
+                virtual ~TLOutcomingAction() noexcept = default;
+
+                /**
+                 * @fn onAction
+                 * @brief enqueue request of action, onCompleted must be passed to the driver as completion of that request
+                 */
+                virtual void onAction(const std::shared_ptr<cURLMultiDriver>& driver, cURLMultiDriver::OnCompleted onCompleted) = 0;
+            };
+
+            void pushAction(const std::shared_ptr<TLOutcomingAction>& action)
+            {
+                action->enqueuedAt = std::chrono::steady_clock::now();
+                m_actionsQueue.push(action);
+            }
+
+            /**
+             * @note actions keep only ids of chats and messages: objects of batch could be allocated in batch arena,
+             *       which is released before network thread sends actions (pipelined mode)
+             * @note actions of one chat are sent in order: request is started only when previous request to the chat is completed
+             */
+            class TLSendMessage : public TLOutcomingAction
+            {
+                TLId m_chatId;
+                std::string m_text;
+                std::string m_apiUrl;
+            public:
+                TLSendMessage(const telegram::ChatPtr& chat, const std::string& text, const std::string& apiUrl)
+                    : m_chatId(chat->id)
+                    , m_text(text)
+                    , m_apiUrl(apiUrl)
+                {
+                }
+
+                void onAction(const std::shared_ptr<cURLMultiDriver>& driver, cURLMultiDriver::OnCompleted onCompleted) override
+                {
+                    auto sendMessageApiUrl = fmt::format("{}/{}", m_apiUrl, TLAPI::sendMessage);
+
+                    telegram::SendMessageRequest request {};
+                    request.chat_id = m_chatId;
+                    request.text = m_text;
+
+                    auto body = driver->createRequestBody();
+                    request.writeTo(body);
+
+                    driver->performApiRequestAsync(sendMessageApiUrl, std::move(body), std::move(onCompleted), nullptr, cURLMultiDriver::makeOrderingKey(m_apiUrl, m_chatId));
+                }
+            };
+
+            class TLReplyMessage : public TLOutcomingAction
+            {
+                TLId m_chatId;
+                TLId m_messageId;
+                std::string m_replyText;
+                std::string m_apiUrl;
+
+            public:
+                TLReplyMessage(const telegram::ChatPtr& chat, const telegram::MessagePtr& replyMessage, const std::string& replyText, const std::string& apiUrl)
+                    : m_chatId(chat->id)
+                    , m_messageId(replyMessage->message_id)
+                    , m_replyText(replyText)
+                    , m_apiUrl(apiUrl)
+                {
+                }
+
+                void onAction(const std::shared_ptr<cURLMultiDriver>& driver, cURLMultiDriver::OnCompleted onCompleted) override
+                {
+                    auto sendMessageApiUrl = fmt::format("{}/{}", m_apiUrl, TLAPI::sendMessage);
+
+                    telegram::SendMessageRequest request {};
+                    request.chat_id = m_chatId;
+                    request.text = m_replyText;
+                    request.reply_to_message_id = m_messageId;
+
+                    auto body = driver->createRequestBody();
+                    request.writeTo(body);
+
+                    driver->performApiRequestAsync(sendMessageApiUrl, std::move(body), std::move(onCompleted), nullptr, cURLMultiDriver::makeOrderingKey(m_apiUrl, m_chatId));
+                }
+            };
+
+            class TLSetChatTitle : public TLOutcomingAction
+            {
+                TLId m_chatId;
+                std::string m_title;
+                std::string m_apiUrl;
+            public:
+                TLSetChatTitle(const telegram::ChatPtr& chat, const std::string& title, const std::string& apiUrl)
+                    : m_chatId(chat->id)
+                    , m_title(title)
+                    , m_apiUrl(apiUrl)
+                {
+                }
+
+                void onAction(const std::shared_ptr<cURLMultiDriver>& driver, cURLMultiDriver::OnCompleted onCompleted) override
+                {
+                    auto sendMessageApiUrl = fmt::format("{}/{}", m_apiUrl, TLAPI::setChatTitle);
+
+                    telegram::SetChatTitleRequest request {};
+                    request.chat_id = m_chatId;
+                    request.title = m_title;
+
+                    auto body = driver->createRequestBody();
+                    request.writeTo(body);
+
+                    driver->performApiRequestAsync(sendMessageApiUrl, std::move(body), std::move(onCompleted), nullptr, cURLMultiDriver::makeOrderingKey(m_apiUrl, m_chatId));
+                }
+            };
+
+            class TLSendVideo : public TLOutcomingAction
+            {
+                TLId m_chatId;
+                std::string m_filePath;
+                std::string m_apiUrl;
+            public:
+                TLSendVideo(const telegram::ChatPtr& chat, const std::string& filePath, const std::string& apiUrl)
+                    : m_chatId(chat->id)
+                    , m_filePath(filePath)
+                    , m_apiUrl(apiUrl)
+                {
+                }
+
+                void onAction(const std::shared_ptr<cURLMultiDriver>& driver, cURLMultiDriver::OnCompleted onCompleted) override
+                {
+                    auto sendMessageApiUrl = fmt::format("{}/{}", m_apiUrl, TLAPI::sendVideo);
+
+                    telegram::SendVideoRequest request {};
+                    request.chat_id = m_chatId;
+
+                    cURLDriver::Parameters parameters {};
+                    cURLDriver::ParametersWriter writer { parameters };
+                    request.writeTo(writer);
+
+                    spdlog::info("[TLSendVideo::onAction] try to send video from file {}", m_filePath);
+                    driver->performHttpRequestWithAttachedFileAsync(sendMessageApiUrl, parameters, m_filePath, [onCompleted = std::move(onCompleted)](CURLcode result, const ResponseBuffer& response) {
+                        spdlog::info("[TLSendVideo::onAction] response {}", response.view());
+                        onCompleted(result, response);
+                    }, cURLMultiDriver::makeOrderingKey(m_apiUrl, m_chatId));
+                }
+            };
+
+            /**
+             * @class BatchArena
+             * @brief Monotonic memory of one getUpdates batch.
+             *        All TL objects of batch are allocated here and freed at once when batch is processed.
+             *        When batch does not fit into arena, arena grows up to size of that batch, so next batches
+             *        of same size are processed without heap allocations.
+             */
+            class BatchArena
+            {
+                /**
+                 * @class UpstreamResource
+                 * @brief Heap resource which counts bytes requested by arena after initial buffer is exhausted
+                 */
+                class UpstreamResource : public std::pmr::memory_resource
+                {
+                    size_t m_allocatedBytes { 0 };
+
+                public:
+                    [[nodiscard]] size_t getAllocatedBytes() const { return m_allocatedBytes; }
+                    void resetAllocatedBytes() { m_allocatedBytes = 0; }
+
+                private:
+                    void* do_allocate(size_t bytes, size_t alignment) override
+                    {
+                        m_allocatedBytes += bytes;
+                        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+                    }
+
+                    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override
+                    {
+                        std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+                    }
+
+                    [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+                    {
+                        return this == &other;
+                    }
+                };
+
+                UpstreamResource m_upstream {};
+                std::unique_ptr<std::byte[]> m_buffer { nullptr };
+                size_t m_bufferSize { 0 };
+                std::optional<std::pmr::monotonic_buffer_resource> m_resource {};
+
+            public:
+                static constexpr size_t InitialSize = 64 * 1024;
+                static constexpr size_t MaxSize = 16 * 1024 * 1024; ///< Arena never keeps more memory than that between batches
+
+                BatchArena()
+                {
+                    reset(InitialSize);
+                }
+
+                std::pmr::memory_resource* getResource()
+                {
+                    return &(*m_resource);
+                }
+
+                [[nodiscard]] size_t getCapacity() const { return m_bufferSize; }
+
+                /**
+                 * @fn release
+                 * @brief free all objects of batch at once
+                 * @note all objects allocated from arena must be destroyed before this call
+                 */
+                void release()
+                {
+                    const size_t overflowBytes = m_upstream.getAllocatedBytes();
+
+                    m_resource->release();
+                    m_upstream.resetAllocatedBytes();
+
+                    if (overflowBytes > 0 && m_bufferSize < MaxSize)
+                        reset(std::min(MaxSize, m_bufferSize + overflowBytes));
+                }
+
+            private:
+                void reset(size_t bufferSize)
+                {
+                    m_resource.reset();
+                    m_buffer = std::make_unique<std::byte[]>(bufferSize);
+                    m_bufferSize = bufferSize;
+                    m_resource.emplace(m_buffer.get(), m_bufferSize, &m_upstream);
+                }
+            };
+
+            /**
+             * @class ParsingResources
+             * @brief Memory and threads used to parse batches: batch arena, parsing pool and arenas of its workers.
+             *        Engines hosted by one ServerHost share single instance, because their batches are parsed one by one on loop thread
+             */
+            class ParsingResources
+            {
+                std::unique_ptr<BatchArena> m_batchArena { nullptr };
+                std::unique_ptr<WorkerPool> m_pool { nullptr };
+                std::vector<std::unique_ptr<BatchArena>> m_workerArenas {}; ///< Arena per worker of parsing pool (when arena is enabled)
+                size_t m_minParallelBatchSize { 0 };
+                bool m_isWorkerArenasEnabled { true };
+
+            public:
+                void setArenaEnabled(bool isEnabled)
+                {
+                    m_batchArena = isEnabled ? std::make_unique<BatchArena>() : nullptr;
+                    resetWorkerArenas();
+                }
+
+                [[nodiscard]] bool isArenaEnabled() const { return m_batchArena != nullptr; }
+
+                /**
+                 * @fn setParallelParsing
+                 * @brief create parsing pool with threadsCount workers (0 disables parallel parsing)
+                 */
+                void setParallelParsing(size_t threadsCount, size_t minBatchSize)
+                {
+                    m_pool = threadsCount > 0 ? std::make_unique<WorkerPool>(threadsCount) : nullptr;
+                    m_minParallelBatchSize = minBatchSize;
+                    resetWorkerArenas();
+                }
+
+                /**
+                 * @fn setWorkerArenasEnabled
+                 * @note in pipelined mode workers parse into heap: worker arenas are shared by all batches,
+                 *       so they could not be released while earlier batch is still dispatched
+                 */
+                void setWorkerArenasEnabled(bool isEnabled)
+                {
+                    m_isWorkerArenasEnabled = isEnabled;
+                    resetWorkerArenas();
+                }
+
+                [[nodiscard]] WorkerPool* getPool() const { return m_pool.get(); }
+                [[nodiscard]] size_t getMinParallelBatchSize() const { return m_minParallelBatchSize; }
+
+                /**
+                 * @fn getResource
+                 * @return arena of thread with slot (0 is poll thread) or nullptr when objects are allocated from heap
+                 */
+                std::pmr::memory_resource* getResource(size_t slot)
+                {
+                    if (slot == 0)
+                        return m_batchArena ? m_batchArena->getResource() : nullptr;
+
+                    return slot <= m_workerArenas.size() ? m_workerArenas[slot - 1]->getResource() : nullptr;
+                }
+
+                void release()
+                {
+                    if (m_batchArena)
+                        m_batchArena->release();
+
+                    for (auto& arena : m_workerArenas)
+                        arena->release();
+                }
+
+            private:
+                void resetWorkerArenas()
+                {
+                    m_workerArenas.clear();
+
+                    if (!m_batchArena || !m_pool || !m_isWorkerArenasEnabled)
+                        return;
+
+                    for (size_t slot = 1; slot < m_pool->getSlotsCount(); ++slot)
+                        m_workerArenas.push_back(std::make_unique<BatchArena>());
+                }
+            };
+
+            /**
+             * @class UpdatesQuarantine
+             * @brief Dead-letter file for updates which could not be parsed.
+             *        Every quarantined update is appended as single JSON line: {"time", "update_id", "error", "raw"}
+             */
+            class UpdatesQuarantine
+            {
+                std::string m_path { DefaultPath };
+                std::ofstream m_file {};
+                std::atomic<uint64_t> m_count { 0 };
+
+            public:
+                static constexpr const char* DefaultPath = "updates.quarantine.jsonl";
+
+                void setPath(const std::string& path)
+                {
+                    m_path = path;
+                    m_file.close();
+                }
+
+                void put(std::string_view rawUpdate, TLOptional<TLId> updateId, const std::exception& error)
+                {
+                    ++m_count;
+
+                    spdlog::error("[UpdatesQuarantine::put] update {} quarantined: {}", updateId ? std::to_string(*updateId) : std::string("(unknown id)"), error.what());
+
+                    nlohmann::json record = {
+                        { "time", static_cast<int64_t>(std::time(nullptr)) },
+                        { "update_id", updateId ? nlohmann::json(*updateId) : nlohmann::json(nullptr) },
+                        { "error", error.what() },
+                        { "raw", std::string(rawUpdate) }
+                    };
+
+                    if (!m_file.is_open())
+                        m_file.open(m_path, std::ios::app);
+
+                    // raw update could contain broken UTF-8, so invalid bytes are replaced instead of throwing
+                    m_file << record.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << std::endl;
+
+                    if (!m_file)
+                        spdlog::error("[UpdatesQuarantine::put] unable to write dead-letter file {}", m_path);
+                }
+
+                [[nodiscard]] uint64_t getCount() const { return m_count; }
+
+                /**
+                 * @fn findUpdateId
+                 * @brief try to read update_id of update which could not be parsed (only top level of object is scanned)
+                 */
+                static TLOptional<TLId> findUpdateId(std::string_view rawUpdate)
+                {
+                    try
+                    {
+                        const JsonObjectView update { rawUpdate };
+
+                        if (const auto value = update.find("update_id"))
+                            return JsonObjectView::toInteger<TLId>(*value);
+                    }
+                    catch (const std::exception&)
+                    {
+                    }
+
+                    return std::nullopt;
+                }
+            };
+
+            /**
+             * @class ParsingScope
+             * @brief Selects batch arena and identity maps of engine (when enabled) for parsers on current thread.
+             *        Workers of parallel parsing (slot > 0) use own arenas, because arena is not thread-safe
+             */
+            class ParsingScope
+            {
+                std::optional<telegram::TLMemoryScope> m_memoryScope {};
+                std::optional<telegram::TLIdentityScope> m_identityScope {};
+
+            public:
+                explicit ParsingScope(TLPollEngine& engine, size_t slot = 0)
+                    : ParsingScope(engine, engine.m_parsing->getResource(slot))
+                {
+                }
+
+                ParsingScope(TLPollEngine& engine, std::pmr::memory_resource* arenaResource)
+                {
+                    if (arenaResource)
+                        m_memoryScope.emplace(arenaResource);
+
+                    if (engine.m_identityMaps)
+                        m_identityScope.emplace(engine.m_identityMaps.get());
+                }
+            };
+
+            /**
+             * @struct PipelinedBatch
+             * @brief Batch of updates passed from network thread to dispatch thread in pipelined mode.
+             *        Batch owns its arena (when arena is enabled), arena is returned to network thread after dispatch
+             */
+            struct PipelinedBatch
+            {
+                std::unique_ptr<BatchArena> arena;  ///< Declared first: objects of batch are destroyed before their memory
+                UpdatesList updates;
+                LazyUpdatesList lazyUpdates {};
+
+                explicit PipelinedBatch(std::unique_ptr<BatchArena> batchArena)
+                    : arena(std::move(batchArena))
+                    , updates(arena ? arena->getResource() : std::pmr::get_default_resource())
+                {
+                }
+            };
+
+            using PipelinedBatchPtr = std::unique_ptr<PipelinedBatch>;
+
+            /**
+             * @class Pipeline
+             * @brief Queues between stages of pipelined mode:
+             *        network thread (getUpdates, parsing, outcoming actions) -> batches -> dispatch thread (handlers),
+             *        dispatch thread -> actions, free arenas -> network thread.
+             *        Network thread is waked up by cURLMultiDriver::wakeup, dispatch thread waits for signal()
+             */
+            class Pipeline
+            {
+            public:
+                static constexpr size_t DefaultDepth = 4;               ///< Max batches parsed but not dispatched yet
+                static constexpr size_t ActionsCapacity = 1024;
+
+                const size_t depth;                                     ///< Requested depth (capacity of batches is rounded up to power of two)
+                SpscQueue<PipelinedBatchPtr> batches;
+                SpscQueue<std::shared_ptr<TLOutcomingAction>> actions { ActionsCapacity };
+                SpscQueue<std::unique_ptr<BatchArena>> freeArenas;
+                std::unique_ptr<BatchArena> spareArena { nullptr };    ///< Arena of empty batch, kept by network thread
+                std::thread dispatchThread {};
+
+            private:
+                std::mutex m_signalMutex {};
+                std::condition_variable m_signal {};
+
+            public:
+                /**
+                 * @throws std::invalid_argument when depth is zero
+                 */
+                explicit Pipeline(size_t depth)
+                    : depth(depth)
+                    , batches(depth)
+                    , freeArenas(depth + 1)
+                {
+                    if (depth == 0)
+                        throw std::invalid_argument("[Pipeline] depth must be at least 1");
+                }
+
+                /**
+                 * @fn isFull
+                 * @return true when depth batches wait for dispatch (polling is paused)
+                 */
+                [[nodiscard]] bool isFull() const { return batches.size() >= depth; }
+
+                /**
+                 * @fn signal
+                 * @brief wake up dispatch thread (new batch arrived or actions queue has free space)
+                 */
+                void signal()
+                {
+                    {
+                        // taken only to order this call with check of predicate inside of wait()
+                        std::lock_guard<std::mutex> lock { m_signalMutex };
+                    }
+
+                    m_signal.notify_one();
+                }
+
+                template <typename _Predicate>
+                void wait(_Predicate&& predicate)
+                {
+                    std::unique_lock<std::mutex> lock { m_signalMutex };
+                    m_signal.wait_for(lock, std::chrono::milliseconds(TLPollEngine::PollInterval), std::forward<_Predicate>(predicate));
+                }
+            };
+
+            /**
+             * @class PollController
+             * @brief Chooses limit and timeout of next getUpdates from observed load: arrival rate of updates (EWMA),
+             *        backlog of handlers and depth of outcoming queue. Idle bot polls with small batches and short timeout,
+             *        saturated bot takes full batches with long timeout. Pinned values are never tuned.
+             */
+            class PollController
+            {
+            public:
+                static constexpr uint32_t ApiMaxLimit = 100;   ///< Bot API returns at most 100 updates per getUpdates
+
+                struct Config
+                {
+                    uint32_t minLimit { 8 };
+                    uint32_t maxLimit { ApiMaxLimit };
+                    uint32_t minTimeout { 5 };
+                    uint32_t maxTimeout { TLPollEngine::AwaitTimeout };
+                    size_t maxBacklog { 64 };                   ///< Batches waiting for handlers + outcoming requests which mean saturation
+                    TLOptional<uint32_t> pinnedLimit {};
+                    TLOptional<uint32_t> pinnedTimeout {};
+                };
+
+                struct Metrics
+                {
+                    uint32_t limit { 0 };
+                    uint32_t timeout { 0 };
+                    double arrivalRate { 0.0 };                 ///< Updates per second (EWMA)
+                    size_t backlog { 0 };
+                    uint64_t polls { 0 };
+                    uint64_t idlePolls { 0 };                   ///< Polls which returned nothing
+                    uint64_t saturatedPolls { 0 };              ///< Polls which returned full batch or found backlog above limit
+                };
+
+            private:
+                static constexpr double RateSmoothing = 0.25;
+                static constexpr double BatchWindow = 1.0;     ///< Partial batch is sized to take updates of that many seconds
+
+                Config m_config {};
+                Metrics m_metrics {};
+                size_t m_receivedUpdates { 0 };
+                std::optional<std::chrono::steady_clock::time_point> m_lastPollAt {};
+
+            public:
+                PollController()
+                {
+                    setConfig(Config {});
+                }
+
+                void setConfig(const Config& config)
+                {
+                    if (config.minLimit == 0 || config.minLimit > config.maxLimit || config.minTimeout > config.maxTimeout)
+                        throw std::invalid_argument("[PollController::setConfig] bad bounds of limit or timeout");
+
+                    m_config = config;
+                    m_metrics.limit = config.pinnedLimit.value_or(config.maxLimit);
+                    m_metrics.timeout = config.pinnedTimeout.value_or(config.maxTimeout);
+                }
+
+                [[nodiscard]] const Config& getConfig() const { return m_config; }
+                [[nodiscard]] const Metrics& getMetrics() const { return m_metrics; }
+                [[nodiscard]] uint32_t getLimit() const { return m_metrics.limit; }
+                [[nodiscard]] uint32_t getTimeout() const { return m_metrics.timeout; }
+
+                void onUpdatesReceived(size_t updatesCount)
+                {
+                    m_receivedUpdates += updatesCount;
+                }
+
+                /**
+                 * @fn onPoll
+                 * @brief account previous poll (updates received since last call) and choose parameters of next one
+                 */
+                void onPoll(size_t backlog)
+                {
+                    const auto now = std::chrono::steady_clock::now();
+                    const auto lastPollAt = std::exchange(m_lastPollAt, now);
+                    const size_t received = std::exchange(m_receivedUpdates, 0);
+
+                    m_metrics.backlog = backlog;
+
+                    if (!lastPollAt)
+                        return;
+
+                    const double elapsed = std::max(0.001, std::chrono::duration<double>(now - *lastPollAt).count());
+                    const double rate = static_cast<double>(received) / elapsed;
+
+                    m_metrics.arrivalRate = m_metrics.polls == 0 ? rate : m_metrics.arrivalRate + RateSmoothing * (rate - m_metrics.arrivalRate);
+                    ++m_metrics.polls;
+
+                    uint32_t limit = m_metrics.limit;
+                    uint32_t timeout = m_metrics.timeout;
+
+                    // batch is full when it reached limit or cap of API (larger limit is never filled)
+                    if (received >= std::min(limit, ApiMaxLimit) || backlog >= m_config.maxBacklog)
+                    {
+                        ++m_metrics.saturatedPolls;
+                        limit = limit * 2;
+                        timeout = m_config.maxTimeout;
+                    }
+                    else if (received == 0)
+                    {
+                        ++m_metrics.idlePolls;
+                        limit = limit / 2;
+                        timeout = timeout - (timeout - std::min(timeout, m_config.minTimeout) + 1) / 2;
+                    }
+                    else
+                    {
+                        const double demand = std::max(static_cast<double>(received), m_metrics.arrivalRate * BatchWindow);
+                        limit = roundUpToPowerOfTwo(static_cast<uint32_t>(std::min(demand * 2.0, static_cast<double>(m_config.maxLimit))));
+                        timeout = timeout + (std::max(timeout, m_config.maxTimeout) - timeout + 1) / 2;
+                    }
+
+                    limit = std::clamp(limit, m_config.minLimit, m_config.maxLimit);
+                    timeout = std::clamp(timeout, m_config.minTimeout, m_config.maxTimeout);
+
+                    limit = m_config.pinnedLimit.value_or(limit);
+                    timeout = m_config.pinnedTimeout.value_or(timeout);
+
+                    if (limit != m_metrics.limit || timeout != m_metrics.timeout)
+                        spdlog::debug("[PollController::onPoll] limit {} -> {}, timeout {} -> {} (rate {:.1f}/s, backlog {})", m_metrics.limit, limit, m_metrics.timeout, timeout, m_metrics.arrivalRate, backlog);
+
+                    m_metrics.limit = limit;
+                    m_metrics.timeout = timeout;
+                }
+
+            private:
+                static uint32_t roundUpToPowerOfTwo(uint32_t value)
+                {
+                    uint32_t result = 1;
+
+                    while (result < value)
+                        result <<= 1;
+
+                    return result;
+                }
+            };
+
+            std::shared_ptr<cURLDriver> m_curlDriver { nullptr };
+            std::shared_ptr<cURLMultiDriver> m_multiDriver { nullptr };
+            bool m_isSharedTransport { false };  ///< Drivers are owned by ServerHost (see checkOwnTransport)
+            std::unique_ptr<telegram::TLIdentityMaps> m_identityMaps { nullptr };
+            std::shared_ptr<ParsingResources> m_parsing { std::make_shared<ParsingResources>() };
+            std::unique_ptr<Pipeline> m_pipeline { nullptr };
+            PollController m_pollController {};
+            UpdatesQuarantine m_quarantine {};
+            std::queue<std::shared_ptr<TLOutcomingAction>> m_actionsQueue {};
+        public:
+            using OnEventCallback = std::function<void(const UpdatesList&)>;
+            using OnLazyEventCallback = std::function<void(const LazyUpdatesList&)>;
+            using HttpVersion = cURLMultiDriver::HttpVersion;
+            using RequestBodyMode = RequestBody::Mode;
+            using Runtime = cURLRuntime;
+            using Transport = cURLMultiDriver; ///< Could be driven without engine (tests and tools)
+            using PollConfig = PollController::Config;
+            using Poller = PollController;      ///< Could be driven without engine (tests)
+            using MethodLatencySnapshots = MethodLatencies::Snapshots;
+
+            /**
+             * @fn setCertificateAuthorities
+             * @brief trust given CA bundle and/or directory instead of system ones (for all engines of process)
+             */
+            static void setCertificateAuthorities(const std::string& caFile, const std::string& caPath = std::string())
+            {
+                cURLRuntime::getInstance().setCertificateAuthorities(caFile, caPath);
+            }
+
+            /**
+             * @struct StartupTimings
+             * @brief breakdown of fast startup in milliseconds from start() (phases of connection are durations)
+             */
+            struct StartupTimings
+            {
+                double nameLookup { 0.0 };
+                double connect { 0.0 };
+                double tlsHandshake { 0.0 };
+                double preconnect { 0.0 };              ///< Host resolved and first TLS session established
+                double warmUp { 0.0 };                  ///< All warm connections are opened
+                double tokenCheck { 0.0 };              ///< getMe response received
+                double ready { 0.0 };                   ///< start() returned, first long-poll is in flight since preconnect
+                TLOptional<double> firstUpdate {};      ///< First update received
+            };
+
+            static constexpr size_t DefaultWarmConnections = 2;
+
+            struct Statistics
+            {
+                uint64_t polls { 0 };                   ///< getUpdates requests sent
+                uint64_t receivedUpdates { 0 };
+                uint64_t quarantinedUpdates { 0 };
+                uint64_t sentActions { 0 };             ///< Outcoming actions passed to transport
+                TLId lastUpdateId { 0 };
+            };
+
+            /**
+             * @struct LatencyMetrics
+             * @brief where time of bot is spent: histograms of pipeline stages (latencies of requests per method are kept by transport)
+             */
+            struct LatencyMetrics
+            {
+                LatencyHistogram longPollWait {};   ///< getUpdates is sent .. first byte of response (Telegram holds request until updates are available)
+                LatencyHistogram download {};       ///< First .. last byte of getUpdates response
+                LatencyHistogram parse {};          ///< Batch is parsed (single update in streaming mode)
+                LatencyHistogram dispatch {};       ///< Update is dispatched: command extraction and handlers
+                LatencyHistogram handler {};        ///< Single call of message processor
+                LatencyHistogram actionQueue {};    ///< Outcoming action is queued by handler .. passed to transport
+            };
+
+            static constexpr std::chrono::seconds DefaultLatencyReportInterval { 60 };
+
+            explicit TLPollEngine(const std::string& telegramToken, const std::string& proxy)
+                : m_token(telegramToken)
+                , m_curlDriver(std::make_shared<cURLDriver>())
+                , m_multiDriver(std::make_shared<cURLMultiDriver>())
+            {
+                if (!proxy.empty())
+                {
+                    m_curlDriver->setProxy(proxy);
+                    m_multiDriver->setProxy(proxy);
+                }
+            }
+
+            /**
+             * @brief engine on shared transport (used by ServerHost): requests of all engines are driven by single
+             *        cURLMultiDriver, so connections to API host are shared. Transport settings must be applied to host
+             */
+            TLPollEngine(const std::string& telegramToken, std::shared_ptr<cURLDriver> curlDriver, std::shared_ptr<cURLMultiDriver> multiDriver)
+                : m_token(telegramToken)
+                , m_curlDriver(std::move(curlDriver))
+                , m_multiDriver(std::move(multiDriver))
+                , m_isSharedTransport(true)
+            {
+            }
+
+            /**
+             * @fn setMaxConcurrentRequests
+             * @brief limit count of requests in flight at the same time (long-poll request included)
+             * @throws std::invalid_argument when limit leaves no room for outcoming requests besides long-poll
+             */
+            void setMaxConcurrentRequests(size_t maxConcurrentRequests)
+            {
+                if (maxConcurrentRequests < MinConcurrentRequests)
+                    throw std::invalid_argument(fmt::format("[TLPollEngine::setMaxConcurrentRequests] at least {} requests are required (long-poll takes one)", MinConcurrentRequests));
+
+                m_multiDriver->setMaxConcurrentRequests(maxConcurrentRequests);
+            }
+
+            /**
+             * @fn setHttpVersion
+             * @brief enable HTTP/2 lane: getUpdates and all outcoming actions are multiplexed as streams over few connections
+             */
+            void setHttpVersion(HttpVersion version, size_t maxHostConnections = cURLMultiDriver::DefaultMaxHostConnections)
+            {
+                m_multiDriver->setHttpVersion(version, maxHostConnections);
+            }
+
+            /**
+             * @fn setRequestBodyMode
+             * @brief choose how parameters of API calls are passed (json POST body by default)
+             */
+            void setRequestBodyMode(RequestBodyMode mode)
+            {
+                m_multiDriver->setRequestBodyMode(mode);
+            }
+
+            /**
+             * @fn setLazyUpdatesCallback
+             * @brief enable lazy updates: raw JSON of every update is indexed and passed to callback without eager decoding
+             *        (callback passed to start() will not be called anymore)
+             */
+            void setLazyUpdatesCallback(const OnLazyEventCallback& callback)
+            {
+                m_lazyUpdatesCallback = callback;
+            }
+
+            /**
+             * @fn setStreamingEnabled
+             * @brief in streaming mode updates are parsed incrementally inside of cURL write callback and
+             *        every update is dispatched as soon as it received (without waiting for whole response)
+             * @note handlers are not called from write callback (inside of curl_multi_perform): parsed updates are queued there
+             *       and dispatched by poll thread when cURL returned (next tick or completion of getUpdates).
+             *       Exception thrown by handler is logged and does not affect the rest of updates.
+             *       Streamed updates are not allocated in batch arena, they outlive write callback
+             */
+            void setStreamingEnabled(bool isEnabled)
+            {
+                m_isStreamingEnabled = isEnabled;
+            }
+
+            /**
+             * @fn setArenaEnabled
+             * @brief allocate all objects of getUpdates batch from monotonic arena which is freed at once after batch is processed.
+             *        Objects passed to callback are valid only until callback returns, use telegram::retain() to keep them longer
+             */
+            void setArenaEnabled(bool isEnabled)
+            {
+                m_parsing->setArenaEnabled(isEnabled);
+            }
+
+            /**
+             * @fn setParallelParsingEnabled
+             * @brief deserialize updates of large getUpdates batches on pool of threads (order of updates is kept).
+             *        Batches smaller than minBatchSize are parsed on poll thread, because cost of wake up is higher than gain.
+             * @note streaming and lazy modes are not affected: updates are parsed one by one there (or not parsed at all)
+             */
+            void setParallelParsingEnabled(bool isEnabled, size_t threadsCount = DefaultParsingThreadsCount(), size_t minBatchSize = DefaultMinParallelBatchSize)
+            {
+                m_parsing->setParallelParsing(isEnabled ? threadsCount : 0, minBatchSize);
+            }
+
+            static constexpr size_t DefaultMinParallelBatchSize = 32;
+
+            static size_t DefaultParsingThreadsCount()
+            {
+                const size_t hardwareThreads = std::thread::hardware_concurrency();
+                return hardwareThreads > 1 ? hardwareThreads - 1 : 1; // poll thread takes part in parsing too
+            }
+
+            /**
+             * @fn setPipelineEnabled
+             * @brief pipelined mode: handlers are executed on separate dispatch thread, so next getUpdates is sent as soon as
+             *        batch is parsed and offset is moved (up to depth batches could wait for dispatch, then polling is paused).
+             *        Outcoming actions are passed back to network thread and sent without waiting for the rest of batch.
+             * @note updates are acknowledged before handlers run. Must be set before start(), can't be combined with streaming mode
+             * @throws std::invalid_argument when depth is zero
+             */
+            void setPipelineEnabled(bool isEnabled, size_t depth = Pipeline::DefaultDepth)
+            {
+                m_pipeline = isEnabled ? std::make_unique<Pipeline>(depth) : nullptr;
+                m_parsing->setWorkerArenasEnabled(!isEnabled);
+            }
+
+            /**
+             * @fn setFastStartupEnabled
+             * @brief startup path for frequent restarts: API host is resolved and TLS session is established once,
+             *        then warmConnections connections are opened, getMe and first long-poll are sent concurrently
+             *        (all through the proxy when it is set). Breakdown is logged and available via getStartupTimings()
+             */
+            void setFastStartupEnabled(bool isEnabled, size_t warmConnections = DefaultWarmConnections)
+            {
+                m_isFastStartupEnabled = isEnabled;
+                m_warmConnections = warmConnections;
+            }
+
+            [[nodiscard]] const StartupTimings& getStartupTimings() const { return m_startupTimings; }
+
+            /**
+             * @fn setApiBaseUrl
+             * @brief send all requests to another Bot API server (local Bot API server, mock server for benchmarks).
+             *        Url is scheme and host without trailing slash, e.g. "http://127.0.0.1:8081"
+             */
+            void setApiBaseUrl(const std::string& baseUrl)
+            {
+                m_apiBaseUrl = baseUrl;
+
+                while (!m_apiBaseUrl.empty() && m_apiBaseUrl.back() == '/')
+                    m_apiBaseUrl.pop_back();
+
+                m_apiUrl = fmt::format("{}/bot{}", m_apiBaseUrl, m_token);
+            }
+
+            [[nodiscard]] const std::string& getApiBaseUrl() const { return m_apiBaseUrl; }
+
+            /**
+             * @fn getApiUrl
+             * @return prefix of method urls of this bot ("<base url>/bot<token>")
+             */
+            [[nodiscard]] const std::string& getApiUrl() const { return m_apiUrl; }
+
+            /**
+             * @fn setCompressionEnabled
+             * @brief ask for gzip/deflate responses for all API methods (enabled by default)
+             * @throws std::logic_error when transport is shared by bots of ServerHost (use ServerHost::setCompressionEnabled)
+             */
+            void setCompressionEnabled(bool isEnabled)
+            {
+                checkOwnTransport("setCompressionEnabled");
+
+                m_curlDriver->getCompressionPolicy().setEnabled(isEnabled);
+                m_multiDriver->getCompressionPolicy().setEnabled(isEnabled);
+            }
+
+            /**
+             * @fn setCompressionEnabled
+             * @brief override compression for one API method (e.g. TLAPI::getUpdates)
+             * @throws std::logic_error when transport is shared by bots of ServerHost (use ServerHost::setCompressionEnabled)
+             */
+            void setCompressionEnabled(const std::string& method, bool isEnabled)
+            {
+                checkOwnTransport("setCompressionEnabled");
+
+                m_curlDriver->getCompressionPolicy().setEnabled(method, isEnabled);
+                m_multiDriver->getCompressionPolicy().setEnabled(method, isEnabled);
+            }
+
+            /**
+             * @fn getTransportStatistics
+             * @brief requests, protocol versions, bytes on wire and decoding time of asynchronous transport
+             */
+            [[nodiscard]] const cURLMultiDriver::Statistics& getTransportStatistics() const
+            {
+                return m_multiDriver->getStatistics();
+            }
+
+            /**
+             * @fn setPollControllerConfig
+             * @brief bounds of adaptive limit/timeout of getUpdates. Set pinnedLimit/pinnedTimeout to use fixed values
+             */
+            void setPollControllerConfig(const PollController::Config& config)
+            {
+                m_pollController.setConfig(config);
+            }
+
+            /**
+             * @fn getPollMetrics
+             * @return current limit/timeout of getUpdates and load observed by controller (read from poll thread only)
+             */
+            [[nodiscard]] const PollController::Metrics& getPollMetrics() const
+            {
+                return m_pollController.getMetrics();
+            }
+
+            /**
+             * @fn replayBatch
+             * @brief process recorded getUpdates response the same way as response received from network
+             *        (parsing mode, arena, identity cache and quarantine are applied). Updates are passed to callback
+             *        instead of OnEventCallback. Used to benchmark parsing on recorded traffic
+             */
+            template <typename _Callback>
+            void replayBatch(std::string_view response, _Callback&& callback)
+            {
+                processBatch([this, &response, &callback]() {
+                    callback(parseUpdatesResponse(response));
+                });
+            }
+
+            /**
+             * @fn replayLazyBatch
+             * @brief same as replayBatch, but response is split into lazy views (as it is done when lazy updates are enabled)
+             */
+            template <typename _Callback>
+            void replayLazyBatch(std::string_view response, _Callback&& callback)
+            {
+                processBatch([this, &response, &callback]() {
+                    callback(parseLazyUpdates(response));
+                });
+            }
+
+            /**
+             * @fn setIdentityCacheEnabled
+             * @brief deduplicate users and chats by id across updates and batches (same id gives same pointer,
+             *        changed objects are published as new copies). Every map keeps at most capacity objects, least recently seen are evicted
+             */
+            void setIdentityCacheEnabled(bool isEnabled, size_t capacity = telegram::TLIdentityMap<telegram::User>::DefaultCapacity)
+            {
+                if (!isEnabled)
+                {
+                    m_identityMaps = nullptr;
+                    return;
+                }
+
+                m_identityMaps = std::make_unique<telegram::TLIdentityMaps>();
+                m_identityMaps->setCapacity(capacity);
+            }
+
+            /**
+             * @fn findChat
+             * @return last known state of chat or nullptr (when chat was not seen or identity cache is disabled)
+             */
+            [[nodiscard]] ChatPtr findChat(TLId chatId) const
+            {
+                return m_identityMaps ? m_identityMaps->chats.find(chatId) : nullptr;
+            }
+
+            /**
+             * @fn findUser
+             * @return last known state of user or nullptr (when user was not seen or identity cache is disabled)
+             */
+            [[nodiscard]] UserPtr findUser(TLId userId) const
+            {
+                return m_identityMaps ? m_identityMaps->users.find(userId) : nullptr;
+            }
+
+            /**
+             * @fn setQuarantinePath
+             * @brief path of dead-letter file for updates which could not be parsed (UpdatesQuarantine::DefaultPath by default)
+             */
+            void setQuarantinePath(const std::string& path)
+            {
+                m_quarantine.setPath(path);
+            }
+
+            /**
+             * @fn getQuarantinedUpdatesCount
+             * @return count of updates which were skipped because they could not be parsed
+             */
+            [[nodiscard]] uint64_t getQuarantinedUpdatesCount() const
+            {
+                return m_quarantine.getCount();
+            }
+
+            void start(const OnEventCallback& callback, bool asDetachedThread = true)
+            {
+                attach(callback);
+
+                std::thread workerThread { std::bind(&TLPollEngine::workerProcedure, this) };
+                if (asDetachedThread)
+                    workerThread.detach();
+                else
+                    workerThread.join();
+            }
+
+            void stop()
+            {
+                m_isDead = true;
+                m_multiDriver->wakeup(); // don't wait for end of poll interval
+            }
+
+            [[nodiscard]] bool isReadyToDestroy() const { return m_isDead; }
+
+            /**
+             * @fn getStatistics
+             * @note counters are updated by poll thread without synchronization, read them from that thread
+             */
+            [[nodiscard]] Statistics getStatistics() const
+            {
+                Statistics statistics = m_statistics;
+                statistics.quarantinedUpdates = m_quarantine.getCount();
+                statistics.lastUpdateId = m_lastUpdateId;
+
+                return statistics;
+            }
+
+            /**
+             * @fn getLatencyMetrics
+             * @brief stage histograms, could be read from any thread while engine is running
+             */
+            [[nodiscard]] const LatencyMetrics& getLatencyMetrics() const { return m_latencies; }
+
+            /**
+             * @fn getMethodLatencies
+             * @brief request latency per TLAPI method (enqueue .. completion) of transport, shared by bots of ServerHost
+             */
+            [[nodiscard]] MethodLatencySnapshots getMethodLatencies() const { return m_multiDriver->getMethodLatencies(); }
+
+            /**
+             * @fn setLatencyReportInterval
+             * @brief period of latency dump into log from loop thread (zero disables periodic dump)
+             */
+            void setLatencyReportInterval(std::chrono::seconds interval)
+            {
+                m_latencyReportInterval = interval;
+            }
+
+            /**
+             * @fn logLatencies
+             * @brief dump stage histograms (and per-method latencies of transport when withTransport is set)
+             */
+            void logLatencies(std::string_view owner = "engine", bool withTransport = true) const
+            {
+                const std::pair<const char*, const LatencyHistogram*> stages[] = {
+                    { "long-poll wait", &m_latencies.longPollWait },
+                    { "download", &m_latencies.download },
+                    { "parse", &m_latencies.parse },
+                    { "dispatch", &m_latencies.dispatch },
+                    { "handler", &m_latencies.handler },
+                    { "action queue", &m_latencies.actionQueue }
+                };
+
+                for (const auto& [stage, histogram] : stages)
+                    logLatency(owner, stage, histogram->getSnapshot());
+
+                if (withTransport)
+                    logMethodLatencies();
+            }
+
+            /**
+             * @fn logMethodLatencies
+             * @brief dump per-method latencies of transport
+             */
+            void logMethodLatencies() const
+            {
+                for (const auto& [method, snapshot] : getMethodLatencies())
+                    logLatency("transport", method, snapshot);
+            }
+
+        private:
+            /**
+             * @fn attach
+             * @brief prepare engine to polling without starting of thread (loop is driven by start() or by ServerHost)
+             * @param isHostedStartup startup phases are driven by ServerHost for all bots at once
+             */
+            void attach(const OnEventCallback& callback, bool isHostedStartup = false)
+            {
+                m_updatesCallback = callback;
+                m_isDead = false;
+
+                if (m_pipeline && m_isStreamingEnabled)
+                    throw std::logic_error("[TLPollEngine::attach] pipelined mode can't be combined with streaming mode");
+
+                if (isHostedStartup)
+                    return;
+
+                if (!m_isFastStartupEnabled)
+                {
+                    checkToken();
+                    return;
+                }
+
+                warmUpTransport(m_warmConnections);
+                beginStartup();
+
+                while (!isStarted())
+                    m_multiDriver->poll(TLPollEngine::PollInterval);
+
+                finishStartup();
+            }
+
+            /**
+             * @fn warmUpTransport
+             * @brief first phase of fast startup: resolve API host, establish TLS session and open warm connections (asynchronously)
+             * @note engines on shared transport warm it up once
+             */
+            void warmUpTransport(size_t warmConnections)
+            {
+                m_startedAt = std::chrono::steady_clock::now();
+                m_startupTimings = {};
+                m_pendingWarmUps = warmConnections;
+
+                const std::string hostUrl = fmt::format("{}/", m_apiBaseUrl);
+
+                try
+                {
+                    const auto timings = m_curlDriver->preconnect(hostUrl);
+                    m_startupTimings.nameLookup = timings.nameLookup;
+                    m_startupTimings.connect = timings.connect;
+                    m_startupTimings.tlsHandshake = timings.tlsHandshake;
+                }
+                catch (const std::exception& error)
+                {
+                    // not fatal: requests below will connect themselves (and report real error)
+                    spdlog::warn("[TLPollEngine::warmUpTransport] {}", error.what());
+                }
+
+                m_startupTimings.preconnect = getStartupTime();
+
+                for (size_t connection = 0; connection < warmConnections; ++connection)
+                {
+                    m_multiDriver->warmUpConnectionAsync(hostUrl, [this](CURLcode, const ResponseBuffer&) {
+                        if (--m_pendingWarmUps == 0)
+                            m_startupTimings.warmUp = getStartupTime();
+                    });
+                }
+            }
+
+            /**
+             * @fn beginStartup
+             * @brief second phase of fast startup: send getMe and first long-poll concurrently
+             */
+            void beginStartup()
+            {
+                if (!m_startedAt)
+                    m_startedAt = std::chrono::steady_clock::now();
+
+                m_isTokenChecked = false;
+
+                spdlog::info("[TLPollEngine::beginStartup] try to check telegram token ...");
+
+                const std::string apiRequestUrl = fmt::format("{}/{}", m_apiUrl, TLAPI::getMe);
+
+                m_multiDriver->performApiRequestAsync(apiRequestUrl, m_multiDriver->createRequestBody(), [this](CURLcode result, const ResponseBuffer& response) {
+                    if (result != CURLE_OK)
+                        throw std::runtime_error(fmt::format("[TLPollEngine::beginStartup] getMe failed: {}", curl_easy_strerror(result)));
+
+                    const auto view = response.view();
+                    onTokenChecked(nlohmann::json::parse(view.begin(), view.end()));
+
+                    m_startupTimings.tokenCheck = getStartupTime();
+                    m_isTokenChecked = true;
+                });
+
+                requestUpdates();
+            }
+
+            [[nodiscard]] bool isStarted() const
+            {
+                return m_isTokenChecked && m_pendingWarmUps == 0;
+            }
+
+            void finishStartup()
+            {
+                m_startupTimings.ready = getStartupTime();
+
+                spdlog::info("[TLPollEngine::finishStartup] ready in {:.1f} ms: dns {:.1f} ms, connect {:.1f} ms, tls {:.1f} ms, preconnect at {:.1f} ms, "
+                             "{} warm connections at {:.1f} ms, getMe at {:.1f} ms",
+                             m_startupTimings.ready, m_startupTimings.nameLookup, m_startupTimings.connect, m_startupTimings.tlsHandshake,
+                             m_startupTimings.preconnect, m_warmConnections, m_startupTimings.warmUp, m_startupTimings.tokenCheck);
+            }
+
+            [[nodiscard]] double getStartupTime() const
+            {
+                return m_startedAt ? std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - *m_startedAt).count() : 0.0;
+            }
+
+            void onFirstUpdateReceived()
+            {
+                if (!m_startedAt || m_startupTimings.firstUpdate)
+                    return;
+
+                m_startupTimings.firstUpdate = getStartupTime();
+                spdlog::info("[TLPollEngine::onFirstUpdateReceived] first update received in {:.1f} ms after start", *m_startupTimings.firstUpdate);
+            }
+
+            /**
+             * @fn tick
+             * @brief STAGE 1 and STAGE 3 of main loop (see workerProcedure): ask for updates when needed and send outcoming actions.
+             *        Network is driven by owner of loop after that
+             */
+            void tick()
+            {
+                dispatchStreamedUpdates();
+
+                if (!m_isAwaitingUpdates && !(m_pipeline && m_pipeline->isFull()) && std::chrono::steady_clock::now() >= m_nextPollAt)
+                    requestUpdates();
+
+                flushActions();
+            }
+
+            void setTopUpdateId(TLId topId)
+            {
+                spdlog::info("[TLPollEngine::setTopUpdateId] change top update ID from {} to {}", m_lastUpdateId, topId);
+                m_lastUpdateId = topId;
+            }
+
+            /**
+             * @fn requestUpdates
+             * @brief enqueue getUpdates long-poll request. Result will be passed to onUpdatesReceived when request finished
+             * @note this method does not marks ready updates as 'read'. You must do that manually via method setTopUpdateId
+             */
+            void requestUpdates()
+            {
+                const std::string apiRequestUrl = fmt::format("{}/{}", m_apiUrl, TLAPI::getUpdates);
+
+                m_pollController.onPoll(getBacklog());
+                ++m_statistics.polls;
+
+                telegram::GetUpdatesRequest request {};
+                request.offset = m_lastUpdateId;
+                request.limit = m_pollController.getLimit();
+                request.timeout = m_pollController.getTimeout();
+
+                auto body = m_multiDriver->createRequestBody();
+                request.writeTo(body);
+
+                m_isAwaitingUpdates = true;
+
+                if (m_isStreamingEnabled)
+                {
+                    requestUpdatesStream(apiRequestUrl, std::move(body));
+                    return;
+                }
+
+                m_multiDriver->performApiRequestAsync(apiRequestUrl, std::move(body), [this](CURLcode result, const ResponseBuffer& response) {
+                    m_isAwaitingUpdates = false;
+                    checkUpdatesTransferResult(result);
+                    recordPollTimings(response.getTimings());
+
+                    spdlog::debug("[TLPollEngine::requestUpdates] got {} bytes, {} allocations, {} copies", response.size(), response.getAllocationsCount(), response.getCopiesCount());
+
+                    const auto view = response.view();
+
+                    if (m_pipeline)
+                    {
+                        enqueueBatch(view);
+                        return;
+                    }
+
+                    processBatch([this, &view]() {
+                        if (m_lazyUpdatesCallback)
+                        {
+                            onLazyUpdatesReceived(parseLazyUpdates(view));
+                            return;
+                        }
+
+                        onUpdatesReceived(parseUpdatesResponse(view));
+                    });
+                });
+            }
+
+            /**
+             * @fn processBatch
+             * @brief parse and process batch of updates inside of batch arena (when arena is enabled).
+             *        Arena is released right after batch, outcoming actions of batch are flushed before it
+             */
+            template <typename _Batch>
+            void processBatch(_Batch&& batch)
+            {
+                try
+                {
+                    ParsingScope parsingScope { *this };
+                    batch();
+                }
+                catch (...)
+                {
+                    m_parsing->release();
+                    throw;
+                }
+
+                m_parsing->release();
+            }
+
+            /**
+             * @fn requestUpdatesStream
+             * @brief streaming version of getUpdates: every update is parsed as soon as its object is received
+             *        and dispatched when curl_multi_perform returned, before the whole response is downloaded
+             */
+            void requestUpdatesStream(const std::string& apiRequestUrl, RequestBody&& body)
+            {
+                auto parser = std::make_shared<UpdatesStreamParser>([this](std::string_view rawUpdate) {
+                    // called inside of curl_multi_perform: update is only queued here (see dispatchStreamedUpdates)
+                    ParsingScope parsingScope { *this, nullptr };
+                    LatencyHistogram::ScopedTimer parseTimer { m_latencies.parse };
+
+                    if (m_lazyUpdatesCallback)
+                    {
+                        if (auto update = parseLazyUpdate(rawUpdate))
+                            m_streamedLazyUpdates.push_back(std::move(update));
+                    }
+                    else if (auto update = parseUpdate(rawUpdate))
+                    {
+                        m_streamedUpdates.push_back(std::move(update));
+                    }
+                });
+
+                m_multiDriver->performApiRequestAsync(apiRequestUrl, std::move(body), [this, parser](CURLcode result, const ResponseBuffer& response) {
+                    m_isAwaitingUpdates = false;
+                    dispatchStreamedUpdates(); // received updates are valid even if transfer failed later
+                    checkUpdatesTransferResult(result);
+                    recordPollTimings(response.getTimings()); // handlers of streamed updates are part of download
+
+                    checkUpdatesEnvelope(*parser);
+
+                    if (parser->getElementsCount() > 0)
+                        spdlog::info("[TLPollEngine::requestUpdatesStream] {} updates were streamed", parser->getElementsCount());
+
+                    processBatch([this]() { flushActions(); });
+                }, [parser](std::string_view chunk) {
+                    parser->feed(chunk);
+                });
+            }
+
+            /**
+             * @fn getBacklog
+             * @return batches waiting for handlers and outcoming requests of this bot which are not completed yet (input of PollController)
+             * @note transport could be shared by many bots (ServerHost), so requests are counted per engine instead of pending requests of transport
+             */
+            [[nodiscard]] size_t getBacklog() const
+            {
+                const size_t queuedActions = m_pipeline ? m_pipeline->batches.size() + m_pipeline->actions.size() : m_actionsQueue.size();
+                return queuedActions + m_actionRequestsInFlight;
+            }
+
+            /**
+             * @fn dispatchStreamedUpdates
+             * @brief run handlers of updates queued by write callback of streamed getUpdates. Must not be called inside of curl_multi_perform
+             */
+            void dispatchStreamedUpdates()
+            {
+                if (m_streamedUpdates.empty() && m_streamedLazyUpdates.empty())
+                    return;
+
+                // queues are taken first: update is dispatched only once even when handler throws something else
+                const std::vector<UpdatePtr> updates = std::exchange(m_streamedUpdates, {});
+                const LazyUpdatesList lazyUpdates = std::exchange(m_streamedLazyUpdates, {});
+
+                ParsingScope parsingScope { *this, nullptr }; // lazy updates are decoded by handlers
+
+                for (const auto& update : updates)
+                {
+                    try
+                    {
+                        onUpdateStreamed(update);
+                    }
+                    catch (const std::exception& exception)
+                    {
+                        spdlog::error("[TLPollEngine::dispatchStreamedUpdates] handler of update {} failed: {}", update->update_id, exception.what());
+                    }
+                }
+
+                for (const auto& update : lazyUpdates)
+                {
+                    try
+                    {
+                        onLazyUpdateStreamed(update);
+                    }
+                    catch (const std::exception& exception)
+                    {
+                        spdlog::error("[TLPollEngine::dispatchStreamedUpdates] handler of update {} failed: {}", update->getUpdateId(), exception.what());
+                    }
+                }
+            }
+
+            void onUpdateStreamed(const UpdatePtr& update)
+            {
+                m_pollController.onUpdatesReceived(1);
+                ++m_statistics.receivedUpdates;
+                onFirstUpdateReceived();
+
+                if (update->update_id >= m_lastUpdateId)
+                    setTopUpdateId(update->update_id + 1);
+
+                UpdatesList updates { telegram::TLMemoryScope::getResource() };
+                updates.push_back(update);
+
+                m_updatesCallback(updates);
+            }
+
+            void onLazyUpdateStreamed(const LazyUpdatePtr& update)
+            {
+                m_pollController.onUpdatesReceived(1);
+                ++m_statistics.receivedUpdates;
+                onFirstUpdateReceived();
+
+                const TLId updateId = update->getUpdateId();
+
+                if (updateId >= m_lastUpdateId)
+                    setTopUpdateId(updateId + 1);
+
+                m_lazyUpdatesCallback(LazyUpdatesList { update });
+            }
+
+            void recordPollTimings(const ResponseBuffer::Timings& timings)
+            {
+                m_latencies.longPollWait.record(timings.waiting);
+                m_latencies.download.record(timings.downloading);
+            }
+
+            /**
+             * @fn reportLatencies
+             * @brief periodic dump of latency histograms (called from loop)
+             */
+            void reportLatencies()
+            {
+                if (m_latencyReportInterval.count() <= 0)
+                    return;
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now - m_lastLatencyReportAt < m_latencyReportInterval)
+                    return;
+
+                m_lastLatencyReportAt = now;
+                logLatencies();
+            }
+
+            static void logLatency(std::string_view owner, std::string_view name, const LatencyHistogram::Snapshot& snapshot)
+            {
+                if (snapshot.count == 0)
+                    return;
+
+                spdlog::info("[TLPollEngine::logLatencies] {} {}: count {}, mean {:.2f} ms, p50 {:.2f} ms, p90 {:.2f} ms, p99 {:.2f} ms, p999 {:.2f} ms, max {:.2f} ms",
+                             owner, name, snapshot.count, snapshot.mean, snapshot.p50, snapshot.p90, snapshot.p99, snapshot.p999, snapshot.max);
+            }
+
+            /**
+             * @fn onPollFailed
+             * @brief delay next getUpdates: failing API (or network) is asked with exponential backoff instead of every loop
+             */
+            /**
+             * @fn checkOwnTransport
+             * @brief settings of shared transport would silently apply to every bot of ServerHost, so they are set on host only
+             */
+            void checkOwnTransport(const char* setting) const
+            {
+                if (m_isSharedTransport)
+                    throw std::logic_error(fmt::format("[TLPollEngine::{}] transport is shared by bots of ServerHost, apply setting to host", setting));
+            }
+
+            void onPollFailed()
+            {
+                ++m_failedPolls;
+
+                const auto delay = std::min(MinPollRetryDelay * (1u << std::min<size_t>(m_failedPolls - 1, 16)), MaxPollRetryDelay);
+                m_nextPollAt = std::chrono::steady_clock::now() + delay;
+
+                spdlog::warn("[TLPollEngine::onPollFailed] getUpdates failed {} times in a row, next attempt in {} ms", m_failedPolls, delay.count());
+            }
+
+            /**
+             * @fn checkUpdatesEnvelope
+             * @brief check "ok" of getUpdates response. Bad token or unknown bot stops engine, other API errors
+             *        and envelopes which are not JSON objects (e.g. HTML page of proxy) delay next poll
+             */
+            void checkUpdatesEnvelope(const UpdatesStreamParser& parser)
+            {
+                nlohmann::json envelope {};
+
+                try
+                {
+                    envelope = parser.finish();
+                }
+                catch (const nlohmann::json::exception& error)
+                {
+                    onPollFailed();
+                    throw std::runtime_error(fmt::format("[getUpdates] unable to parse response: {}", error.what()));
+                }
+
+                if (!envelope.is_object())
+                {
+                    onPollFailed();
+                    throw std::runtime_error("[getUpdates] response is not a JSON object");
+                }
+
+                if (envelope.value("ok", false))
+                {
+                    m_failedPolls = 0;
+                    return;
+                }
+
+                try
+                {
+                    telegram::ErrorHandler::processServerFailureByJsonRepresentation(envelope);
+                }
+                catch (const telegram::exceptions::BadAuthorization& error)
+                {
+                    spdlog::error("[TLPollEngine::checkUpdatesEnvelope] {} Bot is stopped", error.what());
+                    m_isDead = true;
+                    throw;
+                }
+                catch (const telegram::exceptions::BotNotFound& error)
+                {
+                    spdlog::error("[TLPollEngine::checkUpdatesEnvelope] {} Bot is stopped", error.what());
+                    m_isDead = true;
+                    throw;
+                }
+                catch (...)
+                {
+                    onPollFailed();
+                    throw;
+                }
+            }
+
+            void checkUpdatesTransferResult(CURLcode result)
+            {
+                if (result == CURLE_OK)
+                    return;
+
+                onPollFailed();
+
+                if (result == CURLE_OPERATION_TIMEOUTED)
+                    throw telegram::exceptions::DeadWall();
+
+                throw std::runtime_error("[getUpdates] Failed to get response from telegram server");
+            }
+
+            /**
+             * @fn parseUpdate
+             * @return parsed update or nullptr when update was quarantined
+             */
+            UpdatePtr parseUpdate(std::string_view rawUpdate)
+            {
+                UpdatePtr update = nullptr;
+
+                try
+                {
+                    nlohmann::adl_serializer<UpdatePtr>::from_json(nlohmann::json::parse(rawUpdate.begin(), rawUpdate.end()), update);
+                }
+                catch (const std::exception& error)
+                {
+                    quarantineUpdate(rawUpdate, error);
+                    return nullptr;
+                }
+
+                return update;
+            }
+
+            /**
+             * @fn parseLazyUpdate
+             * @return lazy view of update or nullptr when update was quarantined (update_id and top level of object are checked only)
+             */
+            LazyUpdatePtr parseLazyUpdate(std::string_view rawUpdate)
+            {
+                try
+                {
+                    auto update = std::make_shared<LazyUpdate>(rawUpdate);
+                    static_cast<void>(update->getUpdateId()); // update without id can't be acknowledged later
+
+                    return update;
+                }
+                catch (const std::exception& error)
+                {
+                    quarantineUpdate(rawUpdate, error);
+                    return nullptr;
+                }
+            }
+
+            /**
+             * @fn quarantineUpdate
+             * @brief put update into dead-letter file and move offset past it, so it will not be requested again
+             */
+            void quarantineUpdate(std::string_view rawUpdate, const std::exception& error)
+            {
+                const auto updateId = UpdatesQuarantine::findUpdateId(rawUpdate);
+
+                m_quarantine.put(rawUpdate, updateId, error);
+
+                if (updateId && *updateId >= m_lastUpdateId)
+                    setTopUpdateId(*updateId + 1);
+            }
+
+            /**
+             * @fn parseLazyUpdates
+             * @brief split getUpdates response into lazy views (updates are not decoded here)
+             */
+            LazyUpdatesList parseLazyUpdates(std::string_view response)
+            {
+                LatencyHistogram::ScopedTimer parseTimer { m_latencies.parse };
+                LazyUpdatesList result = {};
+
+                UpdatesStreamParser parser { [this, &result](std::string_view rawUpdate) {
+                    if (auto update = parseLazyUpdate(rawUpdate))
+                        result.push_back(std::move(update));
+                } };
+
+                parser.feed(response);
+
+                checkUpdatesEnvelope(parser);
+
+                return result;
+            }
+
+            /**
+             * @fn parseUpdatesResponse
+             * @brief parse raw getUpdates response in parallel (when enabled and batch is large enough) or on current thread.
+             *        Response is split into raw updates first, every update is parsed separately,
+             *        updates which could not be parsed are quarantined with their original bytes
+             */
+            UpdatesList parseUpdatesResponse(std::string_view response)
+            {
+                LatencyHistogram::ScopedTimer parseTimer { m_latencies.parse };
+
+                std::vector<std::string_view> rawUpdates {};
+                rawUpdates.reserve(TLPollEngine::UpdatesLimit);
+
+                UpdatesStreamParser parser { [&rawUpdates](std::string_view rawUpdate) {
+                    rawUpdates.push_back(rawUpdate); // whole response is fed at once, so element is a view into response
+                } };
+
+                parser.feed(response);
+
+                checkUpdatesEnvelope(parser);
+
+                UpdatesList result { telegram::TLMemoryScope::getResource() };
+                result.reserve(rawUpdates.size());
+
+                WorkerPool* parsingPool = m_parsing->getPool();
+                if (!parsingPool || rawUpdates.size() < m_parsing->getMinParallelBatchSize())
+                {
+                    for (const auto& rawUpdate : rawUpdates)
+                    {
+                        if (auto update = parseUpdate(rawUpdate))
+                            result.push_back(std::move(update));
+                    }
+
+                    return result;
+                }
+
+                std::vector<UpdatePtr> updates(rawUpdates.size());
+                std::vector<std::exception_ptr> errors(rawUpdates.size());
+
+                parsingPool->parallelFor(rawUpdates.size(), [this, &rawUpdates, &updates, &errors](size_t index, size_t slot) {
+                    ParsingScope parsingScope { *this, slot };
+
+                    try
+                    {
+                        nlohmann::adl_serializer<UpdatePtr>::from_json(nlohmann::json::parse(rawUpdates[index].begin(), rawUpdates[index].end()), updates[index]);
+                    }
+                    catch (...)
+                    {
+                        errors[index] = std::current_exception();
+                    }
+                });
+
+                // updates are dispatched (and bad ones quarantined) in order of batch
+                for (size_t index = 0; index < rawUpdates.size(); ++index)
+                {
+                    if (!errors[index])
+                    {
+                        result.push_back(std::move(updates[index]));
+                        continue;
+                    }
+
+                    try
+                    {
+                        std::rethrow_exception(errors[index]);
+                    }
+                    catch (const std::exception& error)
+                    {
+                        quarantineUpdate(rawUpdates[index], error);
+                    }
+                }
+
+                return result;
+            }
+
+            /**
+             * @fn checkToken
+             * @brief Just try to retrive information about bot via method getMe
+             * @throws telegram::exceptions::BadAuthorization when unable method getMe failed with error code 401
+             * @throws telegram::exceptions::UnknownError when unable to detect error code (we don't know about passed code)
+             */
+            void checkToken()
+            {
+                spdlog::info("[TLPollEngine::checkToken] try to check telegram token ...");
+
+                const std::string apiRequestUrl = fmt::format("{}/{}", m_apiUrl, TLAPI::getMe);
+
+                onTokenChecked(m_curlDriver->performHttpRequestWithResultAsJson(apiRequestUrl, {}));
+            }
+
+            void onTokenChecked(const nlohmann::json& httpResult)
+            {
+                const bool isOk = httpResult.is_object() && httpResult.value("ok", false);
+                if (!isOk)
+                {
+                    spdlog::critical("[TLPollEngine::checkToken] bad token! Shutdown ...");
+                    telegram::ErrorHandler::processServerFailureByJsonRepresentation(httpResult);
+                }
+                else
+                {
+                    telegram::UserPtr me = nullptr;
+                    nlohmann::adl_serializer<decltype(me)>::from_json(httpResult["result"], me);
+                    spdlog::info("[TLPollEngine::checkToken] correct token! Bot id is {} with name {}", me->id, me->first_name);
+                }
+            }
+
+            void workerProcedure()
+            {
+                /**
+                 * @brief Bot main loop
+                 *        Bot working by 3 stages : Take - Process - Ask
+                 *        First of all bot will take all available updates from telegram server (maximum 256 updates)
+                 *        After all our message processor will try to process all incoming updates.
+                 *        Every process stage could spawn new action, who will be processed on the third stage
+                 *        All stages are driven by cURLMultiDriver, so next long-poll request is not blocked by outcoming actions
+                 *        In pipelined mode STAGE 2 is performed by dispatch thread, this thread only parses batches
+                 */
+                if (m_pipeline)
+                    m_pipeline->dispatchThread = std::thread { &TLPollEngine::dispatchProcedure, this };
+
+                while (!m_isDead)
+                {
+                    /**
+                     * @brief STAGE 1 : ASK TELEGRAM SERVER FOR UPDATES (if we are not waiting for them already and dispatch is not late)
+                     *        STAGE 3 : SEND OUTCOMING ACTIONS FROM BOT
+                     */
+                    try
+                    {
+                        tick();
+                    }
+                    catch (const std::exception& error)
+                    {
+                        spdlog::error("[TLPollEngine::workerProcedure] failed to send requests: {}", error.what());
+                    }
+
+                    /**
+                     * @brief Drive all requests. STAGE 2 is performed from completion of getUpdates request.
+                     *        Failed poll is delayed by onPollFailed, bad token or unknown bot stops this loop
+                     */
+                    try
+                    {
+                        m_multiDriver->poll(TLPollEngine::PollInterval);
+                    }
+                    catch (const std::exception& error)
+                    {
+                        spdlog::error("[TLPollEngine::workerProcedure] {}", error.what());
+                    }
+
+                    reportLatencies();
+                }
+
+                if (m_pipeline && m_pipeline->dispatchThread.joinable())
+                {
+                    m_pipeline->signal();
+                    m_pipeline->dispatchThread.join();
+                }
+            }
+
+            void onUpdatesReceived(const UpdatesList& updatesList)
+            {
+                if (updatesList.empty())
+                    return;
+
+                spdlog::info("[TLPollEngine::onUpdatesReceived] got {} new unprocessed updates from telegram", updatesList.size());
+
+                /**
+                 * @brief STAGE 2 : USE LATEST UPDATE ID AS NEW HISTORY POINTER AND PROCESS UPDATES
+                 */
+                acknowledgeUpdates(updatesList);
+                m_updatesCallback(updatesList);
+
+                flushActions();
+            }
+
+            void onLazyUpdatesReceived(const LazyUpdatesList& updatesList)
+            {
+                if (updatesList.empty())
+                    return;
+
+                spdlog::info("[TLPollEngine::onLazyUpdatesReceived] got {} new unprocessed updates from telegram", updatesList.size());
+
+                acknowledgeUpdates(updatesList);
+                m_lazyUpdatesCallback(updatesList);
+
+                flushActions();
+            }
+
+            /**
+             * @fn acknowledgeUpdates
+             * @brief move offset past the batch: new top update id must be greater by 1 than last top update id (look for crazy docs from tl team)
+             * @note offset could be moved already by quarantined updates of this batch
+             */
+            template <typename _UpdatesList>
+            void acknowledgeUpdates(const _UpdatesList& updatesList)
+            {
+                m_pollController.onUpdatesReceived(updatesList.size());
+                m_statistics.receivedUpdates += updatesList.size();
+
+                if (!updatesList.empty())
+                    onFirstUpdateReceived();
+
+                TLId nextUpdateId = { m_lastUpdateId };
+
+                for (const auto& update : updatesList)
+                {
+                    if constexpr (std::is_same_v<_UpdatesList, LazyUpdatesList>)
+                        nextUpdateId = std::max(nextUpdateId, update->getUpdateId() + 1);
+                    else
+                        nextUpdateId = std::max(nextUpdateId, update->update_id + 1);
+                }
+
+                setTopUpdateId(nextUpdateId);
+            }
+
+            /**
+             * @fn enqueueBatch
+             * @brief network stage of pipelined mode: parse response, move offset and pass batch to dispatch thread.
+             *        Next getUpdates is sent right after this call
+             */
+            void enqueueBatch(std::string_view response)
+            {
+                std::unique_ptr<BatchArena> arena = std::move(m_pipeline->spareArena);
+
+                if (m_parsing->isArenaEnabled() && !arena && !m_pipeline->freeArenas.tryPop(arena))
+                    arena = std::make_unique<BatchArena>();
+
+                auto batch = std::make_unique<PipelinedBatch>(std::move(arena));
+
+                {
+                    ParsingScope parsingScope { *this, batch->arena ? batch->arena->getResource() : nullptr };
+
+                    if (m_lazyUpdatesCallback)
+                    {
+                        batch->lazyUpdates = parseLazyUpdates(response); // every lazy update owns its raw bytes
+                        acknowledgeUpdates(batch->lazyUpdates);
+                    }
+                    else
+                    {
+                        batch->updates = parseUpdatesResponse(response);
+                        acknowledgeUpdates(batch->updates);
+                    }
+                }
+
+                if (batch->updates.empty() && batch->lazyUpdates.empty())
+                {
+                    m_pipeline->spareArena = std::move(batch->arena);
+                    batch.reset();
+
+                    if (m_pipeline->spareArena)
+                        m_pipeline->spareArena->release();
+
+                    return;
+                }
+
+                spdlog::info("[TLPollEngine::enqueueBatch] got {} new unprocessed updates from telegram", batch->updates.size() + batch->lazyUpdates.size());
+
+                // getUpdates is not sent while queue is full, so there is always place for completed one
+                m_pipeline->batches.tryPush(batch);
+                m_pipeline->signal();
+            }
+
+            /**
+             * @fn dispatchProcedure
+             * @brief dispatch stage of pipelined mode: run handlers for every batch and pass their actions to network thread
+             */
+            void dispatchProcedure()
+            {
+                while (!m_isDead)
+                {
+                    PipelinedBatchPtr batch { nullptr };
+
+                    if (!m_pipeline->batches.tryPop(batch))
+                    {
+                        m_pipeline->wait([this]() { return m_isDead || !m_pipeline->batches.empty(); });
+                        continue;
+                    }
+
+                    m_multiDriver->wakeup(); // free place in queue: next getUpdates could be sent
+
+                    if (m_lazyUpdatesCallback)
+                        m_lazyUpdatesCallback(batch->lazyUpdates);
+                    else
+                        m_updatesCallback(batch->updates);
+
+                    auto arena = std::move(batch->arena);
+                    batch.reset();
+
+                    if (arena)
+                    {
+                        arena->release();
+                        m_pipeline->freeArenas.tryPush(arena); // arena is dropped when queue is full
+                    }
+
+                    passActionsToNetwork();
+                }
+            }
+
+            void passActionsToNetwork()
+            {
+                if (m_actionsQueue.empty())
+                    return;
+
+                while (!m_actionsQueue.empty() && !m_isDead)
+                {
+                    if (m_pipeline->actions.tryPush(m_actionsQueue.front()))
+                    {
+                        m_actionsQueue.pop();
+                        continue;
+                    }
+
+                    // network thread is late: let it send queued actions first
+                    m_multiDriver->wakeup();
+                    m_pipeline->wait([this]() { return m_isDead || !m_pipeline->actions.full(); });
+                }
+
+                m_multiDriver->wakeup();
+            }
+
+            void sendAction(TLOutcomingAction& action)
+            {
+                ++m_actionRequestsInFlight;
+                ++m_statistics.sentActions;
+
+                action.onAction(m_multiDriver, [this](CURLcode, const ResponseBuffer&) {
+                    --m_actionRequestsInFlight;
+                });
+            }
+
+            void flushActions()
+            {
+                if (m_pipeline)
+                {
+                    std::shared_ptr<TLOutcomingAction> action { nullptr };
+                    bool isAnyActionSent = false;
+
+                    while (m_pipeline->actions.tryPop(action))
+                    {
+                        m_latencies.actionQueue.recordSince(action->enqueuedAt);
+                        sendAction(*action);
+                        isAnyActionSent = true;
+                    }
+
+                    if (isAnyActionSent)
+                        m_pipeline->signal();
+
+                    return;
+                }
+
+                if (m_actionsQueue.empty())
+                    return;
+
+                spdlog::info("[TLPollEngine::flushActions] processing outcoming actions (total {})", m_actionsQueue.size());
+
+                while (!m_actionsQueue.empty())
+                {
+                    auto action = m_actionsQueue.front();   //take action
+                    m_latencies.actionQueue.recordSince(action->enqueuedAt);
+                    sendAction(*action); //enqueue it
+                    m_actionsQueue.pop(); //remove from queue
+                }
+            }
+
+        private:
+            std::string m_token;
+            std::string m_apiBaseUrl { TLAPI::DefaultBaseUrl };
+            std::string m_apiUrl { fmt::format("{}/bot{}", TLAPI::DefaultBaseUrl, m_token) };   ///< Prefix of method urls
+            std::atomic<bool> m_isDead { false };
+            bool m_isAwaitingUpdates { false };
+            size_t m_failedPolls { 0 };         ///< getUpdates failed in a row
+            std::chrono::steady_clock::time_point m_nextPollAt {};
+            size_t m_actionRequestsInFlight { 0 };
+            bool m_isStreamingEnabled { false };
+            std::vector<UpdatePtr> m_streamedUpdates {};    ///< Parsed by write callback, waiting for dispatchStreamedUpdates
+            LazyUpdatesList m_streamedLazyUpdates {};
+            OnEventCallback m_updatesCallback;
+            OnLazyEventCallback m_lazyUpdatesCallback;
+            TLId m_lastUpdateId { 0 };
+            Statistics m_statistics {};
+            bool m_isFastStartupEnabled { false };
+            bool m_isTokenChecked { false };
+            size_t m_warmConnections { DefaultWarmConnections };
+            size_t m_pendingWarmUps { 0 };
+            StartupTimings m_startupTimings {};
+            std::optional<std::chrono::steady_clock::time_point> m_startedAt {};
+            LatencyMetrics m_latencies {};
+            std::chrono::seconds m_latencyReportInterval { DefaultLatencyReportInterval };
+            std::chrono::steady_clock::time_point m_lastLatencyReportAt { std::chrono::steady_clock::now() };
+        };
+
+        class Server : public std::enable_shared_from_this<Server> {
+            friend class ServerHost;
+
+            TLPollEnginePtr m_pollEngine;
+            ITelergamMessageProcessor* m_messageProcessor { nullptr };
+            std::string m_token;
+        public:
+            Server(const std::string& token, ITelergamMessageProcessor* processor, const std::string& proxy = std::string())
+                : m_pollEngine(std::make_unique<TLPollEngine>(token, proxy))
+                , m_messageProcessor(processor)
+                , m_token(token)
+            {
+                spdlog::info("[Server] start server with token \"{}\"", token);
+
+                if (!proxy.empty())
+                    spdlog::info("[Server] apply proxy {}", proxy);
+            }
+
+            /**
+             * @brief server with prepared poll engine (ServerHost creates engines on shared transport)
+             */
+            Server(const std::string& token, ITelergamMessageProcessor* processor, TLPollEnginePtr pollEngine)
+                : m_pollEngine(std::move(pollEngine))
+                , m_messageProcessor(processor)
+                , m_token(token)
+            {
+            }
+
+            void start(bool asDetached = true)
+            {
+                m_pollEngine->start(std::bind(&Server::onUpdates, this, std::placeholders::_1), asDetached);
+            }
+
+            /**
+             * @fn stop
+             * @brief ask poll loop to finish (start(false) returns after current iteration)
+             */
+            void stop()
+            {
+                m_pollEngine->stop();
+            }
+
+            /**
+             * @fn isStopped
+             * @return true when poll loop is stopped (by stop() or by fatal API error: bad token, unknown bot)
+             */
+            [[nodiscard]] bool isStopped() const { return m_pollEngine->isReadyToDestroy(); }
+
+            void setMaxConcurrentRequests(size_t maxConcurrentRequests)
+            {
+                m_pollEngine->setMaxConcurrentRequests(maxConcurrentRequests);
+            }
+
+            void setHttpVersion(TLPollEngine::HttpVersion version)
+            {
+                m_pollEngine->setHttpVersion(version);
+            }
+
+            void setRequestBodyMode(TLPollEngine::RequestBodyMode mode)
+            {
+                m_pollEngine->setRequestBodyMode(mode);
+            }
+
+            void setStreamingEnabled(bool isEnabled)
+            {
+                m_pollEngine->setStreamingEnabled(isEnabled);
+            }
+
+            /**
+             * @fn setArenaEnabled
+             * @brief objects passed to ITelergamMessageProcessor live only until callback returns (see telegram::retain)
+             */
+            void setArenaEnabled(bool isEnabled)
+            {
+                m_pollEngine->setArenaEnabled(isEnabled);
+            }
+
+            void setIdentityCacheEnabled(bool isEnabled)
+            {
+                m_pollEngine->setIdentityCacheEnabled(isEnabled);
+            }
+
+            void setParallelParsingEnabled(bool isEnabled)
+            {
+                m_pollEngine->setParallelParsingEnabled(isEnabled);
+            }
+
+            void setPollControllerConfig(const TLPollEngine::PollConfig& config)
+            {
+                m_pollEngine->setPollControllerConfig(config);
+            }
+
+            [[nodiscard]] const TLPollEngine::PollController::Metrics& getPollMetrics() const
+            {
+                return m_pollEngine->getPollMetrics();
+            }
+
+            [[nodiscard]] TLPollEngine::Statistics getStatistics() const
+            {
+                return m_pollEngine->getStatistics();
+            }
+
+            [[nodiscard]] const TLPollEngine::cURLMultiDriver::Statistics& getTransportStatistics() const
+            {
+                return m_pollEngine->getTransportStatistics();
+            }
+
+            [[nodiscard]] const TLPollEngine::LatencyMetrics& getLatencyMetrics() const
+            {
+                return m_pollEngine->getLatencyMetrics();
+            }
+
+            [[nodiscard]] TLPollEngine::MethodLatencySnapshots getMethodLatencies() const
+            {
+                return m_pollEngine->getMethodLatencies();
+            }
+
+            void setLatencyReportInterval(std::chrono::seconds interval)
+            {
+                m_pollEngine->setLatencyReportInterval(interval);
+            }
+
+            void logLatencies() const
+            {
+                m_pollEngine->logLatencies();
+            }
+
+            void setFastStartupEnabled(bool isEnabled, size_t warmConnections = TLPollEngine::DefaultWarmConnections)
+            {
+                m_pollEngine->setFastStartupEnabled(isEnabled, warmConnections);
+            }
+
+            [[nodiscard]] const TLPollEngine::StartupTimings& getStartupTimings() const
+            {
+                return m_pollEngine->getStartupTimings();
+            }
+
+            void setCompressionEnabled(bool isEnabled)
+            {
+                m_pollEngine->setCompressionEnabled(isEnabled);
+            }
+
+            void setApiBaseUrl(const std::string& baseUrl)
+            {
+                m_pollEngine->setApiBaseUrl(baseUrl);
+            }
+
+            void setCompressionEnabled(const std::string& method, bool isEnabled)
+            {
+                m_pollEngine->setCompressionEnabled(method, isEnabled);
+            }
+
+            /**
+             * @fn setPipelineEnabled
+             * @brief ITelergamMessageProcessor is called from dispatch thread, updates are acknowledged before processing
+             */
+            void setPipelineEnabled(bool isEnabled)
+            {
+                m_pollEngine->setPipelineEnabled(isEnabled);
+            }
+
+            void setQuarantinePath(const std::string& path)
+            {
+                m_pollEngine->setQuarantinePath(path);
+            }
+
+            [[nodiscard]] uint64_t getQuarantinedUpdatesCount() const
+            {
+                return m_pollEngine->getQuarantinedUpdatesCount();
+            }
+
+            /**
+             * @fn findChat
+             * @brief lookup in local directory of chats seen by bot (requires identity cache), no API calls are made
+             */
+            [[nodiscard]] telegram::ChatPtr findChat(TLId chatId) const
+            {
+                return m_pollEngine->findChat(chatId);
+            }
+
+            [[nodiscard]] telegram::UserPtr findUser(TLId userId) const
+            {
+                return m_pollEngine->findUser(userId);
+            }
+
+            /**
+             * @fn setLazyUpdatesEnabled
+             * @brief decode updates on demand. Messages without bot commands are passed to ITelergamMessageProcessor::onLazyMessage
+             */
+            void setLazyUpdatesEnabled(bool isEnabled)
+            {
+                if (isEnabled)
+                    m_pollEngine->setLazyUpdatesCallback(std::bind(&Server::onLazyUpdates, this, std::placeholders::_1));
+                else
+                    m_pollEngine->setLazyUpdatesCallback(nullptr);
+            }
+
+            void sendMessage(const telegram::ChatPtr& chat, const std::string& message)
+            {
+                m_pollEngine->pushAction(std::make_shared<TLPollEngine::TLSendMessage>(chat, message, m_pollEngine->getApiUrl()));
+            }
+
+            void replyMessage(const telegram::ChatPtr& chat, const telegram::MessagePtr& messageToReply, const std::string& replyText)
+            {
+                m_pollEngine->pushAction(std::make_shared<TLPollEngine::TLReplyMessage>(chat, messageToReply, replyText, m_pollEngine->getApiUrl()));
+            }
+
+            void setChatTitle(const telegram::ChatPtr& chat, const std::string& title)
+            {
+                m_pollEngine->pushAction(std::make_shared<TLPollEngine::TLSetChatTitle>(chat, title, m_pollEngine->getApiUrl()));
+            }
+
+            void sendVideo(const telegram::ChatPtr& chat, const std::string& pathToVideoFile)
+            {
+                m_pollEngine->pushAction(std::make_shared<TLPollEngine::TLSendVideo>(chat, pathToVideoFile, m_pollEngine->getApiUrl()));
+            }
+
+            /**
+             * @fn onUpdates
+             * @brief dispatch batch of updates to message processor (poll engine calls it for every received batch)
+             */
+            void onUpdates(const UpdatesList& updates)
+            {
+                spdlog::info("[Server::onUpdates] got {} updates. Process it!", updates.size());
+
+                for (const auto& update : updates)
+                {
+                    LatencyHistogram::ScopedTimer dispatchTimer { m_pollEngine->m_latencies.dispatch };
+                    processUpdate(update);
+                }
+            }
+
+        private:
+            void attach(bool isHostedStartup = false)
+            {
+                m_pollEngine->attach(std::bind(&Server::onUpdates, this, std::placeholders::_1), isHostedStartup);
+            }
+
+            void onLazyUpdates(const LazyUpdatesList& updates)
+            {
+                spdlog::info("[Server::onLazyUpdates] got {} updates. Process it!", updates.size());
+
+                for (const auto& update : updates)
+                {
+                    LatencyHistogram::ScopedTimer dispatchTimer { m_pollEngine->m_latencies.dispatch };
+                    processLazyUpdate(update);
+                }
+            }
+
+            void processLazyUpdate(const LazyUpdatePtr& update)
+            {
+                /**
+                 * @brief Only plain messages could be processed lazily, everything else requires decoded update
+                 */
+                if (!update->hasMessage() || update->hasEntities())
+                {
+                    processUpdate(update->materialize());
+                    return;
+                }
+
+                LatencyHistogram::ScopedTimer handlerTimer { m_pollEngine->m_latencies.handler };
+                m_messageProcessor->onLazyMessage(update, shared_from_this());
+            }
+
+            void processUpdate(const UpdatePtr& update)
+            {
+                if (update->message.has_value())
+                {
+                    auto message = (*update->message);
+
+                    if (message->entities.has_value())
+                    {
+                        telegram::BotCommandsList commands = {};
+
+                        for (const auto& entity : (*message->entities))
+                        {
+                            if (entity->type == telegram::MessageEntityType::BotCommand)
+                            {
+                                std::string command;
+
+                                // entity covers [offset, offset + length) of text, the end is clamped for malformed entities
+                                const std::string_view text = message->text.has_value() ? std::string_view(*message->text) : std::string_view();
+                                const std::size_t commandEnd = std::min<std::size_t>(text.size(), entity->offset + entity->length);
+
+                                for (std::size_t charId = entity->offset; charId < commandEnd; charId++)
+                                {
+                                    if (text[charId] == '@')
+                                        break; //stop the loop
+                                    else
+                                        command.push_back(text[charId]);
+                                }
+
+                                commands.push_back(telegram::BotCommand { std::move(command), entity->offset, entity->length });
+                            }
+                        }
+
+                        /**
+                         * @brief if we have any bot commands we must process it in other callback
+                         */
+                        if (!commands.empty())
+                        {
+                            spdlog::info("[Server::processUpdate] we have {} bot commands. Process it", commands.size());
+
+                            LatencyHistogram::ScopedTimer handlerTimer { m_pollEngine->m_latencies.handler };
+                            m_messageProcessor->onBotCommands(message, commands, shared_from_this());
+                            return;
+                        }
+                    }
+
+                    spdlog::info("[Server::processUpdate] we haven't any bot commands. Process message in common callback");
+
+                    LatencyHistogram::ScopedTimer handlerTimer { m_pollEngine->m_latencies.handler };
+                    m_messageProcessor->onMessage(message, shared_from_this());
+                }
+
+                if (update->edited_message.has_value())
+                {
+                    auto message = (*update->edited_message);
+
+                    LatencyHistogram::ScopedTimer handlerTimer { m_pollEngine->m_latencies.handler };
+                    m_messageProcessor->onMessageEdited(message, shared_from_this());
+                }
+
+                /**
+                 * @brief here we can process other types of message
+                 */
+            }
+        };
+
+        /**
+         * @class ServerHost
+         * @brief Hosts many bots on one loop thread. Bots share transport (single cURLMultiDriver: connections to API host,
+         *        TLS sessions, DNS) and parsing resources (batch arena, parsing pool). Every bot keeps own offset,
+         *        message processor, outcoming queue and statistics.
+         *        Idle bot costs one pending long-poll request and state of its engine, no threads or cURL stacks are created per bot.
+         * @note with HTTP/1.1 every pending long-poll holds own connection, use HTTP/2 to multiplex all bots over few connections
+         */
+        class ServerHost
+        {
+            std::shared_ptr<TLPollEngine::cURLDriver> m_curlDriver;
+            std::shared_ptr<TLPollEngine::cURLMultiDriver> m_multiDriver;
+            std::shared_ptr<TLPollEngine::ParsingResources> m_parsing;
+            std::vector<ServerPtr> m_servers {};
+            size_t m_maxActionRequests { TLPollEngine::cURLMultiDriver::DefaultMaxConcurrentRequests };
+            std::atomic<bool> m_isDead { true };
+            bool m_isFastStartupEnabled { false };
+            size_t m_warmConnections { TLPollEngine::DefaultWarmConnections };
+            std::string m_apiBaseUrl { TLAPI::DefaultBaseUrl };
+            std::chrono::seconds m_latencyReportInterval { TLPollEngine::DefaultLatencyReportInterval };
+            std::chrono::steady_clock::time_point m_lastLatencyReportAt { std::chrono::steady_clock::now() };
+
+        public:
+            explicit ServerHost(const std::string& proxy = std::string())
+                : m_curlDriver(std::make_shared<TLPollEngine::cURLDriver>())
+                , m_multiDriver(std::make_shared<TLPollEngine::cURLMultiDriver>())
+                , m_parsing(std::make_shared<TLPollEngine::ParsingResources>())
+            {
+                if (!proxy.empty())
+                {
+                    spdlog::info("[ServerHost] apply proxy {}", proxy);
+                    m_curlDriver->setProxy(proxy);
+                    m_multiDriver->setProxy(proxy);
+                }
+            }
+
+            /**
+             * @fn addServer
+             * @brief register bot. Must be called before run(), returned server is configured as usual (except of transport)
+             */
+            ServerPtr addServer(const std::string& token, ITelergamMessageProcessor* processor)
+            {
+                auto engine = std::make_unique<TLPollEngine>(token, m_curlDriver, m_multiDriver);
+                engine->m_parsing = m_parsing;
+                engine->setApiBaseUrl(m_apiBaseUrl);
+
+                auto server = std::make_shared<Server>(token, processor, std::move(engine));
+                m_servers.push_back(server);
+
+                applyConcurrencyLimit();
+
+                spdlog::info("[ServerHost::addServer] bot #{} added", m_servers.size());
+                return server;
+            }
+
+            [[nodiscard]] const std::vector<ServerPtr>& getServers() const { return m_servers; }
+
+            /**
+             * @fn setMaxConcurrentRequests
+             * @brief limit of outcoming requests in flight, long-poll of every bot is allowed in addition to it
+             * @throws std::invalid_argument when limit is zero
+             */
+            void setMaxConcurrentRequests(size_t maxConcurrentRequests)
+            {
+                if (maxConcurrentRequests == 0)
+                    throw std::invalid_argument("[ServerHost::setMaxConcurrentRequests] at least one outcoming request is required");
+
+                m_maxActionRequests = maxConcurrentRequests;
+                applyConcurrencyLimit();
+            }
+
+            void setHttpVersion(TLPollEngine::HttpVersion version)
+            {
+                m_multiDriver->setHttpVersion(version);
+            }
+
+            void setRequestBodyMode(TLPollEngine::RequestBodyMode mode)
+            {
+                m_multiDriver->setRequestBodyMode(mode);
+            }
+
+            /**
+             * @fn setCompressionEnabled
+             * @brief ask for gzip/deflate responses for all API methods of all bots (enabled by default)
+             */
+            void setCompressionEnabled(bool isEnabled)
+            {
+                m_curlDriver->getCompressionPolicy().setEnabled(isEnabled);
+                m_multiDriver->getCompressionPolicy().setEnabled(isEnabled);
+            }
+
+            /**
+             * @fn setCompressionEnabled
+             * @brief override compression for one API method of all bots (e.g. TLAPI::getUpdates)
+             */
+            void setCompressionEnabled(const std::string& method, bool isEnabled)
+            {
+                m_curlDriver->getCompressionPolicy().setEnabled(method, isEnabled);
+                m_multiDriver->getCompressionPolicy().setEnabled(method, isEnabled);
+            }
+
+            /**
+             * @fn setApiBaseUrl
+             * @brief Bot API server of all bots (already added and added later)
+             */
+            void setApiBaseUrl(const std::string& baseUrl)
+            {
+                m_apiBaseUrl = baseUrl;
+
+                for (const auto& server : m_servers)
+                    server->setApiBaseUrl(baseUrl);
+            }
+
+            /**
+             * @fn setArenaEnabled
+             * @brief single arena is used by all bots: batches are parsed and processed one by one on loop thread
+             */
+            void setArenaEnabled(bool isEnabled)
+            {
+                m_parsing->setArenaEnabled(isEnabled);
+            }
+
+            void setParallelParsingEnabled(bool isEnabled, size_t threadsCount = TLPollEngine::DefaultParsingThreadsCount())
+            {
+                m_parsing->setParallelParsing(isEnabled ? threadsCount : 0, TLPollEngine::DefaultMinParallelBatchSize);
+            }
+
+            /**
+             * @fn setFastStartupEnabled
+             * @brief shared transport is warmed up once, then getMe and first long-poll of all bots are sent at once
+             */
+            void setFastStartupEnabled(bool isEnabled, size_t warmConnections = TLPollEngine::DefaultWarmConnections)
+            {
+                m_isFastStartupEnabled = isEnabled;
+                m_warmConnections = warmConnections;
+            }
+
+            void run(bool asDetached = true)
+            {
+                for (const auto& server : m_servers)
+                {
+                    if (server->m_pollEngine->m_pipeline)
+                        throw std::logic_error("[ServerHost::run] pipelined mode is not supported for hosted bots");
+
+                    if (!m_isFastStartupEnabled)
+                        server->attach();
+                }
+
+                if (m_isFastStartupEnabled)
+                    startAll();
+
+                m_isDead = false;
+
+                std::thread loopThread { &ServerHost::loopProcedure, this };
+                if (asDetached)
+                    loopThread.detach();
+                else
+                    loopThread.join();
+            }
+
+            void stop()
+            {
+                m_isDead = true;
+                m_multiDriver->wakeup();
+            }
+
+            /**
+             * @fn logStatistics
+             * @brief print metrics of every bot (call it from loop thread, e.g. from message processor)
+             */
+            void logStatistics() const
+            {
+                for (size_t botIndex = 0; botIndex < m_servers.size(); ++botIndex)
+                {
+                    const auto statistics = m_servers[botIndex]->getStatistics();
+                    const auto& pollMetrics = m_servers[botIndex]->getPollMetrics();
+
+                    spdlog::info("[ServerHost::logStatistics] bot #{}: polls {}, updates {}, quarantined {}, actions {}, offset {}, limit {}, timeout {}, rate {:.1f}/s",
+                                 botIndex + 1, statistics.polls, statistics.receivedUpdates, statistics.quarantinedUpdates, statistics.sentActions,
+                                 statistics.lastUpdateId, pollMetrics.limit, pollMetrics.timeout, pollMetrics.arrivalRate);
+                }
+
+                const auto& transport = m_multiDriver->getStatistics();
+
+                spdlog::info("[ServerHost::logStatistics] transport: requests {}, failed {}, {} bytes on wire, {} decoded, {} compressed responses inflated in {:.1f} ms",
+                             transport.completedRequests, transport.failedRequests, transport.wireBytes, transport.decodedBytes,
+                             transport.compressedResponses, static_cast<double>(transport.decodingTime) / 1e6);
+            }
+
+            /**
+             * @fn setLatencyReportInterval
+             * @brief period of latency dump of all bots from loop thread (zero disables periodic dump)
+             */
+            void setLatencyReportInterval(std::chrono::seconds interval)
+            {
+                m_latencyReportInterval = interval;
+            }
+
+            /**
+             * @fn logLatencies
+             * @brief dump stage histograms of every bot and per-method latencies of shared transport
+             */
+            void logLatencies() const
+            {
+                for (size_t botIndex = 0; botIndex < m_servers.size(); ++botIndex)
+                    m_servers[botIndex]->m_pollEngine->logLatencies(fmt::format("bot #{}", botIndex + 1), false);
+
+                if (!m_servers.empty())
+                    m_servers.front()->m_pollEngine->logMethodLatencies(); // transport is shared
+            }
+
+        private:
+            void reportLatencies()
+            {
+                if (m_latencyReportInterval.count() <= 0)
+                    return;
+
+                const auto now = std::chrono::steady_clock::now();
+                if (now - m_lastLatencyReportAt < m_latencyReportInterval)
+                    return;
+
+                m_lastLatencyReportAt = now;
+                logLatencies();
+            }
+
+            void startAll()
+            {
+                for (const auto& server : m_servers)
+                    server->attach(true);
+
+                if (m_servers.empty())
+                    return;
+
+                auto& firstEngine = *m_servers.front()->m_pollEngine;
+                firstEngine.warmUpTransport(m_warmConnections);
+
+                for (const auto& server : m_servers)
+                    server->m_pollEngine->beginStartup();
+
+                const auto isStarted = [this]() {
+                    return std::all_of(m_servers.begin(), m_servers.end(), [](const ServerPtr& server) { return server->m_pollEngine->isStarted(); });
+                };
+
+                while (!isStarted())
+                    m_multiDriver->poll(TLPollEngine::PollInterval);
+
+                for (const auto& server : m_servers)
+                    server->m_pollEngine->finishStartup();
+            }
+
+            void applyConcurrencyLimit()
+            {
+                m_multiDriver->setMaxConcurrentRequests(m_servers.size() + m_maxActionRequests);
+            }
+
+            void loopProcedure()
+            {
+                while (!m_isDead)
+                {
+                    for (const auto& server : m_servers)
+                    {
+                        if (server->m_pollEngine->isReadyToDestroy())
+                            continue;
+
+                        try
+                        {
+                            server->m_pollEngine->tick();
+                        }
+                        catch (const std::exception& error)
+                        {
+                            spdlog::error("[ServerHost::loopProcedure] bot failed to send requests: {}", error.what());
+                        }
+                    }
+
+                    try
+                    {
+                        m_multiDriver->poll(TLPollEngine::PollInterval);
+                    }
+                    catch (const std::exception& error)
+                    {
+                        // failure of one bot (e.g. timeout of its long-poll) must not stop the rest of bots
+                        spdlog::error("[ServerHost::loopProcedure] {}", error.what());
+                    }
+
+                    reportLatencies();
+                }
+            }
+        };
+
+        inline void telegram::ErrorHandler::processServerFailureByJsonRepresentation(const nlohmann::json& j)
+        {
+            const int errorCode = j.is_object() ? j.value("error_code", 0) : 0;
+
+            if (errorCode == telegram::error_codes::BadAuthorization)
+                throw telegram::exceptions::BadAuthorization();
+
+            if (errorCode == telegram::error_codes::NotFound)
+                throw telegram::exceptions::BotNotFound();
+
+            /**
+             * @brief Process other error codes here
+             */
+
+            throw telegram::exceptions::UnknownError(errorCode);
+        }
+    }
+}
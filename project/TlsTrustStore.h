@@ -0,0 +1,104 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <stdexcept>
+
+#include <openssl/ssl.h>
+#include <openssl/x509.h>
+#include <openssl/x509_vfy.h>
+
+namespace reactor {
+
+    /**
+     * @class TlsTrustStore
+     * @brief Certificate authorities loaded once and shared by every TLS context of process.
+     *        Parsing of CA bundle (~150 certificates) costs more than TLS handshake itself,
+     *        so store is built once and attached to new SSL_CTX by reference (see attachTo).
+     * @note load could be called while other threads attach store to new contexts: store is swapped under lock,
+     *       contexts which already hold previous store keep it alive by own reference.
+     *       Loaded store is never modified, OpenSSL synchronizes concurrent verifications on its own
+     */
+    class TlsTrustStore
+    {
+        mutable std::mutex m_lock;
+        X509_STORE* m_store { nullptr };
+
+    public:
+        TlsTrustStore() = default;
+
+        TlsTrustStore(const TlsTrustStore&) = delete;
+        TlsTrustStore& operator=(const TlsTrustStore&) = delete;
+
+        ~TlsTrustStore()
+        {
+            X509_STORE_free(m_store);
+        }
+
+        /**
+         * @fn load
+         * @brief build store from PEM bundle and/or hashed directory of certificates (any of them could be empty)
+         * @throws std::runtime_error when no location could be loaded
+         */
+        void load(const std::string& caFile, const std::string& caPath)
+        {
+            X509_STORE* store = X509_STORE_new();
+            if (!store)
+                throw std::runtime_error("[TlsTrustStore::load] unable to allocate store");
+
+            const bool isFileLoaded = !caFile.empty() && X509_STORE_load_file(store, caFile.c_str()) == 1;
+            const bool isPathLoaded = !caPath.empty() && X509_STORE_load_path(store, caPath.c_str()) == 1;
+
+            if (!isFileLoaded && !isPathLoaded)
+            {
+                X509_STORE_free(store);
+                throw std::runtime_error("[TlsTrustStore::load] unable to load certificate authorities from '" + caFile + "' / '" + caPath + "'");
+            }
+
+            {
+                std::lock_guard<std::mutex> guard { m_lock };
+                std::swap(m_store, store);
+            }
+
+            X509_STORE_free(store); // previous one, contexts which use it keep own reference
+        }
+
+        [[nodiscard]] bool isLoaded() const
+        {
+            std::lock_guard<std::mutex> guard { m_lock };
+            return m_store != nullptr;
+        }
+
+        /**
+         * @fn getCertificatesCount
+         * @return count of certificates loaded from bundle (directory entries are loaded on demand)
+         */
+        [[nodiscard]] size_t getCertificatesCount() const
+        {
+            std::lock_guard<std::mutex> guard { m_lock };
+
+            if (!m_store)
+                return 0;
+
+            size_t count = 0;
+            STACK_OF(X509_OBJECT)* objects = X509_STORE_get0_objects(m_store);
+
+            for (int index = 0; index < sk_X509_OBJECT_num(objects); ++index)
+                count += X509_OBJECT_get_type(sk_X509_OBJECT_value(objects, index)) == X509_LU_X509 ? 1 : 0;
+
+            return count;
+        }
+
+        /**
+         * @fn attachTo
+         * @brief replace store of SSL_CTX by shared one (reference counted, context doesn't copy certificates)
+         */
+        void attachTo(SSL_CTX* context) const
+        {
+            std::lock_guard<std::mutex> guard { m_lock };
+
+            if (m_store)
+                SSL_CTX_set1_cert_store(context, m_store);
+        }
+    };
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace reactor {
+
+    /**
+     * @class WorkerPool
+     * @brief Fixed set of threads for data-parallel loops.
+     *        parallelFor() splits range of indices between workers and calling thread and returns when every index is processed.
+     * @note parallelFor() is not reentrant: only one loop could run at the same time
+     */
+    class WorkerPool
+    {
+    public:
+        /**
+         * @brief body of loop: index of element and slot of thread which processes it
+         *        (0 is calling thread, 1..getThreadsCount() are workers). Slot could be used to select per-thread state
+         */
+        using Body = std::function<void(size_t index, size_t slot)>;
+
+    private:
+        std::vector<std::thread> m_threads {};
+        std::mutex m_mutex {};
+        std::condition_variable m_jobReady {};
+        std::condition_variable m_jobDone {};
+
+        const Body* m_body { nullptr };
+        size_t m_count { 0 };
+        std::atomic<size_t> m_nextIndex { 0 };
+        size_t m_generation { 0 };
+        size_t m_activeWorkers { 0 };
+        std::exception_ptr m_error { nullptr };
+        bool m_isStopping { false };
+
+    public:
+        explicit WorkerPool(size_t threadsCount)
+        {
+            m_threads.reserve(threadsCount);
+
+            for (size_t slot = 1; slot <= threadsCount; ++slot)
+                m_threads.emplace_back(&WorkerPool::workerProcedure, this, slot);
+        }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        ~WorkerPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                m_isStopping = true;
+            }
+
+            m_jobReady.notify_all();
+
+            for (auto& thread : m_threads)
+                thread.join();
+        }
+
+        [[nodiscard]] size_t getThreadsCount() const { return m_threads.size(); }
+
+        /**
+         * @fn getSlotsCount
+         * @return count of threads which could execute body (workers and calling thread)
+         */
+        [[nodiscard]] size_t getSlotsCount() const { return m_threads.size() + 1; }
+
+        /**
+         * @fn parallelFor
+         * @brief call body for every index in [0, count). Calling thread takes part in processing.
+         * @throws first exception thrown by body (rest of indices are still processed)
+         */
+        void parallelFor(size_t count, const Body& body)
+        {
+            if (count == 0)
+                return;
+
+            {
+                std::lock_guard<std::mutex> lock { m_mutex };
+                m_body = &body;
+                m_count = count;
+                m_nextIndex = 0;
+                m_error = nullptr;
+                m_activeWorkers = m_threads.size();
+                ++m_generation;
+            }
+
+            m_jobReady.notify_all();
+
+            runBody(body, count, 0);
+
+            std::unique_lock<std::mutex> lock { m_mutex };
+            m_jobDone.wait(lock, [this]() { return m_activeWorkers == 0; });
+            m_body = nullptr;
+
+            if (m_error)
+                std::rethrow_exception(m_error);
+        }
+
+    private:
+        void runBody(const Body& body, size_t count, size_t slot)
+        {
+            for (size_t index = m_nextIndex++; index < count; index = m_nextIndex++)
+            {
+                try
+                {
+                    body(index, slot);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock { m_mutex };
+
+                    if (!m_error)
+                        m_error = std::current_exception();
+                }
+            }
+        }
+
+        void workerProcedure(size_t slot)
+        {
+            size_t lastGeneration = 0;
+
+            while (true)
+            {
+                const Body* body = nullptr;
+                size_t count = 0;
+
+                {
+                    std::unique_lock<std::mutex> lock { m_mutex };
+                    m_jobReady.wait(lock, [this, lastGeneration]() { return m_isStopping || m_generation != lastGeneration; });
+
+                    if (m_isStopping)
+                        return;
+
+                    lastGeneration = m_generation;
+                    body = m_body;
+                    count = m_count;
+                }
+
+                runBody(*body, count, slot);
+
+                {
+                    std::lock_guard<std::mutex> lock { m_mutex };
+                    --m_activeWorkers;
+                }
+
+                m_jobDone.notify_one();
+            }
+        }
+    };
+}
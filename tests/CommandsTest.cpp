@@ -0,0 +1,95 @@
+/**
+ * @brief CommandsTest - bot commands extracted by Server::onUpdates from bot_command entities:
+ *        command covers [offset, offset + length) of text, bot name after '@' is dropped, end of malformed entity is clamped to text.
+ */
+#include <TelegramBot.h>
+#include "TestCheck.h"
+
+namespace reactor::tests {
+
+    class RecordingProcessor : public telegram::ITelergamMessageProcessor
+    {
+    public:
+        std::vector<std::vector<std::string>> commands {};
+        size_t messagesCount { 0 };
+
+        void onMessage(const telegram::MessagePtr&, const telegram::ServerPtr&) override
+        {
+            ++messagesCount;
+        }
+
+        void onBotCommands(const telegram::MessagePtr&, const telegram::BotCommandsList& botCommands, const telegram::ServerPtr&) override
+        {
+            auto& names = commands.emplace_back();
+
+            for (const auto& command : botCommands)
+                names.push_back(command.command);
+        }
+    };
+
+    /**
+     * @fn extractCommands
+     * @return commands of single message with given text (could be null) and entities
+     */
+    std::vector<std::string> extractCommands(const nlohmann::json& text, const std::vector<nlohmann::json>& entities)
+    {
+        nlohmann::json message = {
+            { "message_id", 1 },
+            { "date", 1600000000 },
+            { "chat", { { "id", -100500 }, { "type", "supergroup" } } },
+            { "from", { { "id", 1001 }, { "is_bot", false }, { "first_name", "Alice" } } },
+            { "entities", entities }
+        };
+
+        if (!text.is_null())
+            message["text"] = text;
+
+        telegram::UpdatePtr update = nullptr;
+        nlohmann::adl_serializer<telegram::UpdatePtr>::from_json(nlohmann::json { { "update_id", 1 }, { "message", message } }, update);
+
+        telegram::UpdatesList updates {};
+        updates.push_back(update);
+
+        RecordingProcessor processor {};
+        auto server = std::make_shared<telegram::Server>("TEST", &processor);
+        server->onUpdates(updates);
+
+        if (!TL_CHECK_EQUAL(processor.commands.size(), 1u))
+            return {};
+
+        return processor.commands.front();
+    }
+
+    nlohmann::json command(size_t offset, size_t length)
+    {
+        return { { "type", "bot_command" }, { "offset", offset }, { "length", length } };
+    }
+
+    void testCommandsExtraction()
+    {
+        using Commands = std::vector<std::string>;
+
+        TL_CHECK(extractCommands("/start", { command(0, 6) }) == Commands { "/start" });
+        TL_CHECK(extractCommands("/status@ICVReactorBot please", { command(0, 21) }) == Commands { "/status" });
+
+        // command which does not start the message
+        TL_CHECK(extractCommands("hey /deploy now", { command(4, 7) }) == Commands { "/deploy" });
+        TL_CHECK(extractCommands("/a and /bb@bot", { command(0, 2), command(7, 7) }) == (Commands { "/a", "/bb" }));
+
+        // length goes past the end of text
+        TL_CHECK(extractCommands("run /stop", { command(4, 100) }) == Commands { "/stop" });
+        TL_CHECK(extractCommands("run", { command(10, 5) }) == Commands { "" });
+
+        // entities without text (e.g. caption entities of media)
+        TL_CHECK(extractCommands(nullptr, { command(0, 6) }) == Commands { "" });
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::off);
+
+    reactor::tests::testCommandsExtraction();
+
+    return reactor::tests::finish();
+}
@@ -0,0 +1,133 @@
+/**
+ * @brief IdentityMapTest - copy-on-write of TLIdentityMap:
+ *        - unchanged object keeps its pointer, changed one is published as new copy and previous pointer keeps previous state;
+ *        - handler of earlier update of batch does not see values of later update with the same user;
+ *        - objects published by writer thread are read by other threads without torn values.
+ */
+#include <TelegramBot.h>
+#include "TestCheck.h"
+
+#include <atomic>
+#include <thread>
+
+namespace reactor::tests {
+
+    telegram::User makeUser(telegram::TLId id, const std::string& firstName, const std::string& lastName)
+    {
+        telegram::User user {};
+        user.id = id;
+        user.first_name = firstName;
+        user.last_name = telegram::TLString { lastName };
+
+        return user;
+    }
+
+    void testChangedObjectIsCopied()
+    {
+        telegram::TLIdentityMap<telegram::User> users {};
+
+        const auto first = users.merge(makeUser(1, "Alice", "Smith"));
+        TL_CHECK(users.merge(makeUser(1, "Alice", "Smith")) == first);
+
+        const auto renamed = users.merge(makeUser(1, "Alice", "Jones"));
+        TL_CHECK(renamed != first);
+        TL_CHECK(first->last_name == "Smith");
+        TL_CHECK(renamed->last_name == "Jones");
+        TL_CHECK(users.find(1) == renamed);
+
+        const auto statistics = users.getStatistics();
+        TL_CHECK_EQUAL(statistics.misses, 1u);
+        TL_CHECK_EQUAL(statistics.hits, 2u);
+        TL_CHECK_EQUAL(statistics.updates, 1u);
+    }
+
+    telegram::UpdatePtr parseMessage(telegram::TLId updateId, const std::string& firstName)
+    {
+        const nlohmann::json json = {
+            { "update_id", updateId },
+            { "message", {
+                { "message_id", updateId },
+                { "date", 1600000000 },
+                { "chat", { { "id", 1001 }, { "type", "private" } } },
+                { "from", { { "id", 1001 }, { "is_bot", false }, { "first_name", firstName } } },
+                { "text", "hello" }
+            } }
+        };
+
+        telegram::UpdatePtr update = nullptr;
+        nlohmann::adl_serializer<telegram::UpdatePtr>::from_json(json, update);
+
+        return update;
+    }
+
+    void testBatchKeepsStateOfEveryUpdate()
+    {
+        telegram::TLIdentityMaps maps {};
+        telegram::TLIdentityScope scope { &maps };
+
+        // the user was renamed between two messages of one batch
+        const auto before = parseMessage(1, "Alice");
+        const auto after = parseMessage(2, "Alicia");
+
+        const auto& sender = *before->message.value()->from;
+        const auto& renamedSender = *after->message.value()->from;
+
+        TL_CHECK(sender->first_name == "Alice");
+        TL_CHECK(renamedSender->first_name == "Alicia");
+        TL_CHECK(maps.users.find(1001) == renamedSender);
+
+        // chat was not changed and is shared
+        TL_CHECK((*before->message)->chat == (*after->message)->chat);
+    }
+
+    void testConcurrentReaders()
+    {
+        static constexpr size_t Merges = 20000;
+        static constexpr size_t Readers = 3;
+
+        telegram::TLIdentityMap<telegram::User> users {};
+        users.merge(makeUser(1, "A", "A"));
+
+        std::atomic<bool> isDone { false };
+        std::atomic<size_t> tornReads { 0 };
+        std::vector<std::thread> threads {};
+
+        for (size_t index = 0; index < Readers; ++index)
+        {
+            threads.emplace_back([&users, &isDone, &tornReads]() {
+                while (!isDone)
+                {
+                    const auto user = users.find(1);
+
+                    if (user->first_name != *user->last_name)
+                        ++tornReads;
+                }
+            });
+        }
+
+        // long names do not fit into small string buffer
+        const std::string names[] = { std::string(64, 'a'), std::string(128, 'b') };
+
+        for (size_t merge = 0; merge < Merges; ++merge)
+            users.merge(makeUser(1, names[merge % 2], names[merge % 2]));
+
+        isDone = true;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        TL_CHECK_EQUAL(tornReads.load(), 0u);
+        TL_CHECK_EQUAL(users.getStatistics().updates, Merges);
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::off);
+
+    reactor::tests::testChangedObjectIsCopied();
+    reactor::tests::testBatchKeepsStateOfEveryUpdate();
+    reactor::tests::testConcurrentReaders();
+
+    return reactor::tests::finish();
+}
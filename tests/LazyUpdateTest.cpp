@@ -0,0 +1,234 @@
+/**
+ * @brief LazyUpdateTest - lazy views (TLPollEngine::replayLazyBatch) are equivalent to eager adl_serializer<UpdatePtr> path
+ *        (TLPollEngine::replayBatch) on recorded getUpdates response: every accessor of LazyUpdate and every field of objects
+ *        decoded by getChat() / getMessage() / materialize() is compared with the eager object graph.
+ *
+ * Usage: LazyUpdateTest <response.json>
+ */
+#include <TelegramBot.h>
+#include "TestCheck.h"
+
+#include <fstream>
+#include <sstream>
+
+namespace reactor::tests {
+
+    using namespace reactor::telegram;
+
+    bool expect(bool condition, const std::string& path, int line)
+    {
+        return check(condition, path.c_str(), __FILE__, line);
+    }
+
+#define TL_EXPECT_FIELD(field) expect(lhs.field == rhs.field, path + "." #field, __LINE__)
+
+    void checkSame(const ChatPtr& lhs, const ChatPtr& rhs, const std::string& path);
+    void checkSame(const UserPtr& lhs, const UserPtr& rhs, const std::string& path);
+    void checkSame(const MessagePtr& lhs, const MessagePtr& rhs, const std::string& path);
+    void checkSame(const MessageEntityPtr& lhs, const MessageEntityPtr& rhs, const std::string& path);
+    void checkSame(const StickerPtr& lhs, const StickerPtr& rhs, const std::string& path);
+
+    template <typename _Ptr>
+    bool checkPresence(const _Ptr& lhs, const _Ptr& rhs, const std::string& path)
+    {
+        if (!expect((lhs == nullptr) == (rhs == nullptr), path + " presence", __LINE__))
+            return false;
+
+        return lhs != nullptr;
+    }
+
+    template <typename _T, size_t _InlineCapacity>
+    void checkSame(const SmallVector<_T, _InlineCapacity>& lhs, const SmallVector<_T, _InlineCapacity>& rhs, const std::string& path)
+    {
+        if (!expect(lhs.size() == rhs.size(), path + " size", __LINE__))
+            return;
+
+        for (size_t index = 0; index < lhs.size(); ++index)
+            checkSame(lhs[index], rhs[index], fmt::format("{}[{}]", path, index));
+    }
+
+    template <typename _T>
+    void checkSame(const TLOptional<_T>& lhs, const TLOptional<_T>& rhs, const std::string& path)
+    {
+        if (expect(lhs.has_value() == rhs.has_value(), path + " presence", __LINE__) && lhs.has_value())
+            checkSame(*lhs, *rhs, path);
+    }
+
+    void checkSame(const ChatPtr& lhsPtr, const ChatPtr& rhsPtr, const std::string& path)
+    {
+        if (!checkPresence(lhsPtr, rhsPtr, path))
+            return;
+
+        const Chat& lhs = *lhsPtr;
+        const Chat& rhs = *rhsPtr;
+
+        TL_EXPECT_FIELD(id);
+        TL_EXPECT_FIELD(type);
+        TL_EXPECT_FIELD(title);
+        TL_EXPECT_FIELD(user_name);
+        TL_EXPECT_FIELD(first_name);
+        TL_EXPECT_FIELD(last_name);
+    }
+
+    void checkSame(const UserPtr& lhsPtr, const UserPtr& rhsPtr, const std::string& path)
+    {
+        if (!checkPresence(lhsPtr, rhsPtr, path))
+            return;
+
+        const User& lhs = *lhsPtr;
+        const User& rhs = *rhsPtr;
+
+        TL_EXPECT_FIELD(id);
+        TL_EXPECT_FIELD(is_bot);
+        TL_EXPECT_FIELD(first_name);
+        TL_EXPECT_FIELD(last_name);
+        TL_EXPECT_FIELD(username);
+    }
+
+    void checkSame(const MessageEntityPtr& lhsPtr, const MessageEntityPtr& rhsPtr, const std::string& path)
+    {
+        if (!checkPresence(lhsPtr, rhsPtr, path))
+            return;
+
+        const MessageEntity& lhs = *lhsPtr;
+        const MessageEntity& rhs = *rhsPtr;
+
+        TL_EXPECT_FIELD(type);
+        TL_EXPECT_FIELD(offset);
+        TL_EXPECT_FIELD(length);
+        TL_EXPECT_FIELD(url);
+        checkSame(lhs.user, rhs.user, path + ".user");
+    }
+
+    void checkSame(const StickerPtr& lhsPtr, const StickerPtr& rhsPtr, const std::string& path)
+    {
+        if (!checkPresence(lhsPtr, rhsPtr, path))
+            return;
+
+        const Sticker& lhs = *lhsPtr;
+        const Sticker& rhs = *rhsPtr;
+
+        TL_EXPECT_FIELD(file_id);
+        TL_EXPECT_FIELD(width);
+        TL_EXPECT_FIELD(height);
+        TL_EXPECT_FIELD(is_animated);
+        TL_EXPECT_FIELD(emoji);
+        TL_EXPECT_FIELD(set_name);
+    }
+
+    void checkSame(const MessagePtr& lhsPtr, const MessagePtr& rhsPtr, const std::string& path)
+    {
+        if (!checkPresence(lhsPtr, rhsPtr, path))
+            return;
+
+        const Message& lhs = *lhsPtr;
+        const Message& rhs = *rhsPtr;
+
+        TL_EXPECT_FIELD(message_id);
+        TL_EXPECT_FIELD(date);
+        TL_EXPECT_FIELD(text);
+        checkSame(lhs.from, rhs.from, path + ".from");
+        checkSame(lhs.chat, rhs.chat, path + ".chat");
+        checkSame(lhs.forward_from, rhs.forward_from, path + ".forward_from");
+        checkSame(lhs.reply_to_message, rhs.reply_to_message, path + ".reply_to_message");
+        checkSame(lhs.entities, rhs.entities, path + ".entities");
+        checkSame(lhs.sticker, rhs.sticker, path + ".sticker");
+        checkSame(lhs.new_chat_members, rhs.new_chat_members, path + ".new_chat_members");
+        checkSame(lhs.left_chat_member, rhs.left_chat_member, path + ".left_chat_member");
+    }
+
+    void checkSame(const UpdatePtr& lhsPtr, const UpdatePtr& rhsPtr, const std::string& path)
+    {
+        if (!checkPresence(lhsPtr, rhsPtr, path))
+            return;
+
+        const Update& lhs = *lhsPtr;
+        const Update& rhs = *rhsPtr;
+
+        TL_EXPECT_FIELD(update_id);
+        checkSame(lhs.message, rhs.message, path + ".message");
+        checkSame(lhs.edited_message, rhs.edited_message, path + ".edited_message");
+    }
+
+#undef TL_EXPECT_FIELD
+
+    /**
+     * @fn checkLazyUpdate
+     * @brief compare every accessor of lazy view with eager update
+     */
+    void checkLazyUpdate(const LazyUpdatePtr& lazy, const UpdatePtr& eager)
+    {
+        const std::string path = fmt::format("update {}", eager->update_id);
+
+        expect(lazy->getUpdateId() == eager->update_id, path + " getUpdateId", __LINE__);
+        expect(lazy->hasMessage() == eager->message.has_value(), path + " hasMessage", __LINE__);
+        expect(lazy->hasEditedMessage() == eager->edited_message.has_value(), path + " hasEditedMessage", __LINE__);
+
+        if (eager->message.has_value())
+        {
+            const MessagePtr& message = *eager->message;
+
+            expect(lazy->getMessageId() == message->message_id, path + " getMessageId", __LINE__);
+            expect(lazy->getChatId() == message->chat->id, path + " getChatId", __LINE__);
+            expect(lazy->getText() == message->text, path + " getText", __LINE__);
+            expect(lazy->hasEntities() == message->entities.has_value(), path + " hasEntities", __LINE__);
+
+            // chat is decoded alone first, then whole message (it must not depend on order of calls)
+            checkSame(lazy->getChat(), message->chat, path + " getChat()");
+            checkSame(lazy->getMessage(), message, path + " getMessage()");
+        }
+
+        checkSame(lazy->materialize(), eager, path + " materialize()");
+    }
+
+    std::string readFile(const std::string& path)
+    {
+        std::ifstream file { path, std::ios::binary };
+        if (!file)
+            throw std::runtime_error(fmt::format("[LazyUpdateTest] unable to open {}", path));
+
+        std::stringstream content {};
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    void testLazyUpdatesAreEquivalentToEager(const std::string& response)
+    {
+        telegram::TLPollEngine engine { "TEST", {} };
+        engine.setQuarantinePath("LazyUpdateTest.quarantine.jsonl");
+
+        std::vector<UpdatePtr> eagerUpdates {};
+        engine.replayBatch(response, [&eagerUpdates](const UpdatesList& updates) {
+            eagerUpdates.assign(updates.begin(), updates.end());
+        });
+
+        LazyUpdatesList lazyUpdates {};
+        engine.replayLazyBatch(response, [&lazyUpdates](const LazyUpdatesList& updates) {
+            lazyUpdates = updates;
+        });
+
+        TL_CHECK_EQUAL(engine.getQuarantinedUpdatesCount(), 0u);
+        TL_CHECK(!eagerUpdates.empty());
+
+        if (!TL_CHECK_EQUAL(lazyUpdates.size(), eagerUpdates.size()))
+            return;
+
+        for (size_t index = 0; index < eagerUpdates.size(); ++index)
+            checkLazyUpdate(lazyUpdates[index], eagerUpdates[index]);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: LazyUpdateTest <response.json>\n");
+        return EXIT_FAILURE;
+    }
+
+    spdlog::set_level(spdlog::level::off);
+
+    reactor::tests::testLazyUpdatesAreEquivalentToEager(reactor::tests::readFile(argv[1]));
+
+    return reactor::tests::finish();
+}
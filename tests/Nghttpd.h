@@ -0,0 +1,127 @@
+#pragma once
+
+/**
+ * @brief nghttpd (HTTP/2 server of nghttp2) as local h2 stand-in for tests. Path to executable is passed to test by ctest
+ *        when CMake found it, tests skip h2 checks otherwise.
+ */
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <csignal>
+#include <stdexcept>
+
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#include <fmt/format.h>
+
+extern char** environ;
+
+namespace reactor::tests {
+
+    /**
+     * @class Nghttpd
+     * @brief nghttpd process serving static files on free local port: cleartext h2 (prior knowledge only)
+     *        or h2 over TLS (ALPN) when key and certificate are passed
+     */
+    class Nghttpd
+    {
+        static constexpr std::chrono::seconds StartTimeout { 10 };
+
+        pid_t m_pid { -1 };
+        uint16_t m_port { 0 };
+        bool m_isTls { false };
+
+    public:
+        Nghttpd(const std::string& executable, const std::string& htdocs, const std::string& keyFile = std::string(), const std::string& certificateFile = std::string())
+            : m_isTls(!keyFile.empty())
+        {
+            m_port = findFreePort();
+
+            std::vector<std::string> arguments { executable, "-a", "127.0.0.1", "-d", htdocs };
+
+            if (m_isTls)
+            {
+                arguments.insert(arguments.end(), { std::to_string(m_port), keyFile, certificateFile });
+            }
+            else
+            {
+                arguments.insert(arguments.end(), { "--no-tls", std::to_string(m_port) });
+            }
+
+            std::vector<char*> argv {};
+
+            for (auto& argument : arguments)
+                argv.push_back(argument.data());
+
+            argv.push_back(nullptr);
+
+            if (posix_spawn(&m_pid, executable.c_str(), nullptr, nullptr, argv.data(), environ) != 0)
+                throw std::runtime_error(fmt::format("[Nghttpd] unable to start {}", executable));
+
+            waitUntilListening();
+        }
+
+        Nghttpd(const Nghttpd&) = delete;
+        Nghttpd& operator=(const Nghttpd&) = delete;
+
+        ~Nghttpd()
+        {
+            if (m_pid > 0)
+            {
+                ::kill(m_pid, SIGTERM);
+                ::waitpid(m_pid, nullptr, 0);
+            }
+        }
+
+        [[nodiscard]] std::string getBaseUrl() const { return fmt::format("{}://127.0.0.1:{}", m_isTls ? "https" : "http", m_port); }
+
+    private:
+        static uint16_t findFreePort()
+        {
+            const int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+
+            ::bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+            ::getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length);
+            ::close(socket);
+
+            return ntohs(address.sin_port);
+        }
+
+        void waitUntilListening() const
+        {
+            const auto deadline = std::chrono::steady_clock::now() + StartTimeout;
+
+            while (std::chrono::steady_clock::now() < deadline)
+            {
+                const int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+
+                sockaddr_in address {};
+                address.sin_family = AF_INET;
+                address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+                address.sin_port = htons(m_port);
+
+                const bool isConnected = ::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+                ::close(socket);
+
+                if (isConnected)
+                    return;
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            }
+
+            throw std::runtime_error(fmt::format("[Nghttpd] server does not listen on port {}", m_port));
+        }
+    };
+}
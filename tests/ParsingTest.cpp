@@ -0,0 +1,156 @@
+/**
+ * @brief ParsingTest - getUpdates batch parsed on worker pool (TLPollEngine::setParallelParsingEnabled) gives the same result
+ *        as batch parsed on poll thread: same updates in the same order, same count of quarantined updates and same offset.
+ *        Batch contains updates which could not be parsed (wrong type of field, missing required field, missing update_id),
+ *        both modes must put their original bytes into dead-letter file.
+ */
+#include <TelegramBot.h>
+#include "TestCheck.h"
+
+#include <cstdio>
+#include <fstream>
+#include <set>
+
+namespace reactor::tests {
+
+    static constexpr size_t UpdatesCount = 64;
+    static constexpr telegram::TLId FirstUpdateId = 1000;
+
+    /**
+     * @fn makeBatch
+     * @brief getUpdates response with text messages, updates with indices from brokenUpdates could not be parsed
+     */
+    std::string makeBatch(const std::set<size_t>& brokenUpdates)
+    {
+        std::string batch = R"({"ok":true,"result":[)";
+
+        for (size_t index = 0; index < UpdatesCount; ++index)
+        {
+            const telegram::TLId updateId = FirstUpdateId + index;
+
+            if (index > 0)
+                batch += ",";
+
+            if (brokenUpdates.count(index) == 0)
+            {
+                batch += fmt::format(
+                    R"({{"update_id":{},"message":{{"message_id":{},"from":{{"id":{},"is_bot":false,"first_name":"User"}},)"
+                    R"("date":1600000000,"chat":{{"id":-100500,"type":"supergroup","title":"Test"}},"text":"/start message {}")"
+                    R"({}}}}})",
+                    updateId, index, 2000 + index % 7, index, index % 2 ? R"(,"entities":[{"type":"bot_command","offset":0,"length":6}])" : "");
+
+                continue;
+            }
+
+            // spaces and order of keys differ from re-serialized JSON, so dead-letter file must keep original bytes
+            switch (index % 3)
+            {
+                case 0: // wrong type of field
+                    batch += fmt::format(R"({{ "update_id": {}, "message": {{ "message_id": "oops", "date": 1, "chat": {{ "id": 1, "type": "private" }} }} }})", updateId);
+                    break;
+                case 1: // required field is missing
+                    batch += fmt::format(R"({{ "update_id": {}, "message": {{ "message_id": {}, "date": 1 }} }})", updateId, index);
+                    break;
+                default: // update can't be acknowledged by its id
+                    batch += fmt::format(R"({{ "message": {{ "message_id": {}, "date": 1, "chat": {{ "id": 1, "type": "private" }} }} }})", index);
+                    break;
+            }
+        }
+
+        return batch + "]}";
+    }
+
+    struct ParsedBatch
+    {
+        std::vector<telegram::TLId> updateIds {};
+        std::vector<telegram::TLId> chatIds {};
+        std::vector<std::string> texts {};
+        uint64_t quarantinedUpdates { 0 };
+        std::vector<std::string> quarantinedRaw {};     ///< "raw" of every record in dead-letter file
+        telegram::TLId offset { 0 };
+    };
+
+    std::vector<std::string> readQuarantinedRaw(const std::string& quarantinePath)
+    {
+        std::vector<std::string> result {};
+        std::ifstream file { quarantinePath };
+
+        for (std::string line; std::getline(file, line);)
+            result.push_back(nlohmann::json::parse(line)["raw"].get<std::string>());
+
+        return result;
+    }
+
+    ParsedBatch replay(const std::string& batch, bool isParallel, bool isArenaEnabled, const std::string& quarantinePath)
+    {
+        std::remove(quarantinePath.c_str());
+
+        telegram::TLPollEngine engine { "TEST", {} };
+        engine.setQuarantinePath(quarantinePath);
+        engine.setArenaEnabled(isArenaEnabled);
+
+        if (isParallel)
+            engine.setParallelParsingEnabled(true, 2, 0);
+
+        ParsedBatch result {};
+
+        engine.replayBatch(batch, [&result](const telegram::UpdatesList& updates) {
+            for (const auto& update : updates)
+            {
+                result.updateIds.push_back(update->update_id);
+
+                if (!TL_CHECK(update->message.has_value()))
+                    continue;
+
+                const auto& message = *update->message;
+                result.chatIds.push_back(message->chat->id);
+                result.texts.emplace_back(message->text.value_or(telegram::TLString {}));
+            }
+        });
+
+        result.quarantinedUpdates = engine.getQuarantinedUpdatesCount();
+        result.offset = engine.getStatistics().lastUpdateId;
+        result.quarantinedRaw = readQuarantinedRaw(quarantinePath);
+
+        std::remove(quarantinePath.c_str());
+        return result;
+    }
+
+    void testParallelParsingIsEquivalentToSerial()
+    {
+        const std::set<size_t> brokenUpdates { 3, 10, 11, 29, 40, UpdatesCount - 1 };
+        const std::string batch = makeBatch(brokenUpdates);
+
+        const ParsedBatch serial = replay(batch, false, false, "ParsingTest.serial.quarantine.jsonl");
+
+        TL_CHECK_EQUAL(serial.updateIds.size(), UpdatesCount - brokenUpdates.size());
+        TL_CHECK_EQUAL(serial.quarantinedUpdates, brokenUpdates.size());
+        TL_CHECK_EQUAL(serial.offset, FirstUpdateId + UpdatesCount); // the last update is broken, offset is moved past it
+        TL_CHECK(std::is_sorted(serial.updateIds.begin(), serial.updateIds.end()));
+        TL_CHECK_EQUAL(serial.quarantinedRaw.size(), brokenUpdates.size());
+
+        for (const auto& raw : serial.quarantinedRaw)
+            TL_CHECK(batch.find(raw) != std::string::npos);
+
+        for (const bool isArenaEnabled : { false, true })
+        {
+            const ParsedBatch parallel = replay(batch, true, isArenaEnabled, "ParsingTest.parallel.quarantine.jsonl");
+
+            TL_CHECK(parallel.updateIds == serial.updateIds);
+            TL_CHECK(parallel.chatIds == serial.chatIds);
+            TL_CHECK(parallel.texts == serial.texts);
+            TL_CHECK_EQUAL(parallel.quarantinedUpdates, serial.quarantinedUpdates);
+            TL_CHECK(parallel.quarantinedRaw == serial.quarantinedRaw);
+            TL_CHECK_EQUAL(parallel.offset, serial.offset);
+        }
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::off);
+
+    reactor::tests::testParallelParsingIsEquivalentToSerial();
+
+    return reactor::tests::finish();
+}
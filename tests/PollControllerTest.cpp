@@ -0,0 +1,82 @@
+/**
+ * @brief PollControllerTest - limit of getUpdates chosen by PollController:
+ *        - limit is capped by Bot API (100 updates) by default;
+ *        - full batch counts as saturated poll and keeps the largest limit, even when configured limit is above API cap;
+ *        - empty poll halves limit, partial batch and backlog are accounted separately.
+ */
+#include <TelegramBot.h>
+#include "TestCheck.h"
+
+namespace reactor::tests {
+
+    using Poller = telegram::TLPollEngine::Poller;
+
+    /**
+     * @fn poll
+     * @brief account poll which returned given count of updates
+     */
+    void poll(Poller& poller, size_t received, size_t backlog = 0)
+    {
+        poller.onUpdatesReceived(received);
+        poller.onPoll(backlog);
+    }
+
+    void testFullBatchIsSaturated()
+    {
+        Poller poller {};
+        TL_CHECK_EQUAL(poller.getConfig().maxLimit, Poller::ApiMaxLimit);
+        TL_CHECK_EQUAL(poller.getLimit(), Poller::ApiMaxLimit);
+
+        poller.onPoll(0); // the first poll is not accounted
+
+        poll(poller, Poller::ApiMaxLimit);
+        TL_CHECK_EQUAL(poller.getMetrics().saturatedPolls, 1u);
+        TL_CHECK_EQUAL(poller.getLimit(), Poller::ApiMaxLimit);
+        TL_CHECK_EQUAL(poller.getTimeout(), poller.getConfig().maxTimeout);
+    }
+
+    void testLimitAboveApiCap()
+    {
+        Poller::Config config {};
+        config.maxLimit = 256;
+
+        Poller poller {};
+        poller.setConfig(config);
+        poller.onPoll(0);
+
+        // API never returns more than 100 updates, such batch is full
+        poll(poller, Poller::ApiMaxLimit);
+        TL_CHECK_EQUAL(poller.getMetrics().saturatedPolls, 1u);
+        TL_CHECK_EQUAL(poller.getLimit(), 256u);
+    }
+
+    void testIdleAndPartialPolls()
+    {
+        Poller poller {};
+        poller.onPoll(0);
+
+        poll(poller, 0);
+        TL_CHECK_EQUAL(poller.getMetrics().idlePolls, 1u);
+        TL_CHECK_EQUAL(poller.getLimit(), Poller::ApiMaxLimit / 2);
+
+        // limit of partial batch depends on arrival rate (polls of test are microseconds apart), it is only not saturated
+        poll(poller, 3);
+        TL_CHECK_EQUAL(poller.getMetrics().saturatedPolls, 0u);
+        TL_CHECK(poller.getLimit() >= poller.getConfig().minLimit && poller.getLimit() <= Poller::ApiMaxLimit);
+
+        // backlog of handlers saturates bot without updates
+        poll(poller, 0, poller.getConfig().maxBacklog);
+        TL_CHECK_EQUAL(poller.getMetrics().saturatedPolls, 1u);
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::off);
+
+    reactor::tests::testFullBatchIsSaturated();
+    reactor::tests::testLimitAboveApiCap();
+    reactor::tests::testIdleAndPartialPolls();
+
+    return reactor::tests::finish();
+}
@@ -0,0 +1,230 @@
+/**
+ * @brief ServerHostTest - hosted bots against MockBotApiServer:
+ *        - bot which gets fatal API error (401) on getUpdates is stopped, the rest of bots keep polling;
+ *        - failed getUpdates are repeated with backoff instead of every loop iteration, bot recovers when API is back;
+ *        - response which is not JSON (HTML page of proxy) is failed poll too;
+ *        - in streaming mode handler which throws does not lose the rest of streamed updates;
+ *        - compression of shared transport is set on host, per-bot call is rejected instead of changing all bots.
+ */
+#include <TelegramBot.h>
+#include <MockBotApi.h>
+#include "TestCheck.h"
+
+#include <atomic>
+#include <thread>
+
+namespace reactor::tests {
+
+    class CountingProcessor : public telegram::ITelergamMessageProcessor
+    {
+    public:
+        std::atomic<size_t> messagesCount { 0 };
+
+        void onMessage(const telegram::MessagePtr&, const telegram::ServerPtr&) override
+        {
+            ++messagesCount;
+        }
+
+        void onBotCommands(const telegram::MessagePtr&, const telegram::BotCommandsList&, const telegram::ServerPtr&) override
+        {
+        }
+    };
+
+    class ThrowingProcessor : public CountingProcessor
+    {
+    public:
+        void onMessage(const telegram::MessagePtr& message, const telegram::ServerPtr& server) override
+        {
+            CountingProcessor::onMessage(message, server);
+
+            if (messagesCount % 2 == 1)
+                throw std::runtime_error("handler failed");
+        }
+    };
+
+    /**
+     * @fn runFor
+     * @brief run loop of host on own thread for given time
+     */
+    void runFor(telegram::ServerHost& host, std::chrono::milliseconds duration)
+    {
+        std::thread loopThread { [&host]() { host.run(false); } };
+        std::this_thread::sleep_for(duration);
+        host.stop();
+        loopThread.join();
+    }
+
+    size_t countRequests(const mock::MockBotApiServer& server, const std::string& token, const std::string& method)
+    {
+        const auto requests = server.getRecordedRequests();
+
+        return std::count_if(requests.begin(), requests.end(), [&token, &method](const mock::RecordedRequest& request) {
+            return request.token == token && request.method == method;
+        });
+    }
+
+    void testFatalApiErrorStopsBot()
+    {
+        mock::MockBotApiServer server {};
+        server.start();
+        server.startGenerator(50.0, mock::generators::textMessages());
+
+        mock::Fault unauthorized {};
+        unauthorized.errorCode = telegram::error_codes::BadAuthorization;
+        unauthorized.description = "Unauthorized";
+        unauthorized.limit = 1; // token of the first bot which polls is revoked
+        server.setFault("getUpdates", unauthorized);
+
+        CountingProcessor processor {};
+        telegram::ServerHost host {};
+        host.setApiBaseUrl(server.getBaseUrl());
+
+        const std::vector<std::string> tokens { "BOT1", "BOT2" };
+        for (const auto& token : tokens)
+            host.addServer(token, &processor);
+
+        runFor(host, std::chrono::milliseconds(1500));
+        server.stop();
+
+        const auto& servers = host.getServers();
+        const size_t stoppedBots = std::count_if(servers.begin(), servers.end(), [](const telegram::ServerPtr& bot) { return bot->isStopped(); });
+        TL_CHECK_EQUAL(stoppedBots, 1u);
+
+        for (size_t index = 0; index < tokens.size(); ++index)
+        {
+            const size_t polls = countRequests(server, tokens[index], "getUpdates");
+
+            if (servers[index]->isStopped())
+                TL_CHECK_EQUAL(polls, 1u);
+            else
+                TL_CHECK(polls > 1);
+        }
+
+        TL_CHECK(processor.messagesCount > 0);
+    }
+
+    void testFailedPollsAreDelayed()
+    {
+        static constexpr size_t FaultsCount = 3;
+
+        mock::MockBotApiServer server {};
+        server.start();
+        server.generateUpdates(1, mock::generators::textMessages());
+
+        mock::Fault internalError {};
+        internalError.errorCode = 500;
+        internalError.description = "Internal Server Error";
+        internalError.limit = FaultsCount;
+        server.setFault("getUpdates", internalError);
+
+        CountingProcessor processor {};
+        telegram::ServerHost host {};
+        host.setApiBaseUrl(server.getBaseUrl());
+        host.addServer("BOT", &processor);
+
+        // failures at 0, 0.5 and 1.5 seconds, update is received at 3.5 seconds
+        runFor(host, std::chrono::milliseconds(1000));
+        TL_CHECK(countRequests(server, "BOT", "getUpdates") <= 2);
+        TL_CHECK_EQUAL(processor.messagesCount.load(), 0u);
+
+        runFor(host, std::chrono::milliseconds(3500));
+        server.stop();
+
+        const size_t polls = countRequests(server, "BOT", "getUpdates");
+        TL_CHECK(polls >= FaultsCount + 1 && polls <= FaultsCount + 2); // the last one is long-poll after received update
+        TL_CHECK_EQUAL(processor.messagesCount.load(), 1u);
+        TL_CHECK(!host.getServers().front()->isStopped());
+    }
+
+    void testNonJsonResponseIsDelayed()
+    {
+        static constexpr size_t FaultsCount = 2;
+
+        mock::MockBotApiServer server {};
+        server.start();
+        server.generateUpdates(1, mock::generators::textMessages());
+
+        mock::Fault badGateway {};
+        badGateway.errorCode = 502;
+        badGateway.body = "<html><body><h1>502 Bad Gateway</h1></body></html>";
+        badGateway.limit = FaultsCount;
+        server.setFault("getUpdates", badGateway);
+
+        CountingProcessor processor {};
+        telegram::ServerHost host {};
+        host.setApiBaseUrl(server.getBaseUrl());
+        host.addServer("BOT", &processor);
+
+        // failures at 0 and 0.5 seconds, update is received at 1.5 seconds
+        runFor(host, std::chrono::milliseconds(1000));
+        TL_CHECK_EQUAL(countRequests(server, "BOT", "getUpdates"), FaultsCount);
+
+        runFor(host, std::chrono::milliseconds(1500));
+        server.stop();
+
+        TL_CHECK_EQUAL(processor.messagesCount.load(), 1u);
+        TL_CHECK(!host.getServers().front()->isStopped());
+    }
+
+    void testCompressionIsSetOnHost()
+    {
+        CountingProcessor processor {};
+        telegram::ServerHost host {};
+        auto bot = host.addServer("BOT", &processor);
+
+        const auto isRejected = [](auto&& setting) {
+            try
+            {
+                setting();
+            }
+            catch (const std::logic_error&)
+            {
+                return true;
+            }
+
+            return false;
+        };
+
+        TL_CHECK(isRejected([&bot]() { bot->setCompressionEnabled(false); }));
+        TL_CHECK(isRejected([&bot]() { bot->setCompressionEnabled(telegram::TLAPI::getUpdates, false); }));
+        TL_CHECK(!isRejected([&host]() { host.setCompressionEnabled(telegram::TLAPI::getUpdates, false); }));
+
+        // standalone bot owns its transport
+        telegram::Server standalone { "BOT", &processor };
+        TL_CHECK(!isRejected([&standalone]() { standalone.setCompressionEnabled(false); }));
+    }
+
+    void testStreamedHandlerFailureIsIsolated()
+    {
+        static constexpr size_t UpdatesCount = 10;
+
+        mock::MockBotApiServer server {};
+        server.start();
+        server.generateUpdates(UpdatesCount, mock::generators::textMessages());
+
+        ThrowingProcessor processor {};
+        telegram::ServerHost host {};
+        host.setApiBaseUrl(server.getBaseUrl());
+        host.addServer("BOT", &processor)->setStreamingEnabled(true);
+
+        runFor(host, std::chrono::milliseconds(1000));
+        server.stop();
+
+        // every update is dispatched once, failed ones are acknowledged too
+        TL_CHECK_EQUAL(processor.messagesCount.load(), UpdatesCount);
+        TL_CHECK(!host.getServers().front()->isStopped());
+    }
+}
+
+int main()
+{
+    spdlog::set_level(spdlog::level::off);
+
+    reactor::tests::testFatalApiErrorStopsBot();
+    reactor::tests::testFailedPollsAreDelayed();
+    reactor::tests::testNonJsonResponseIsDelayed();
+    reactor::tests::testStreamedHandlerFailureIsIsolated();
+    reactor::tests::testCompressionIsSetOnHost();
+
+    return reactor::tests::finish();
+}
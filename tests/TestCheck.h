@@ -0,0 +1,67 @@
+#pragma once
+
+/**
+ * @brief Minimal checks for test executables registered in ctest.
+ *        Failed check is printed with its location and counted, main returns reactor::tests::finish() as exit code.
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace reactor::tests {
+
+    inline size_t g_passedChecks = 0;
+    inline size_t g_failedChecks = 0;
+
+    inline bool check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (condition)
+        {
+            ++g_passedChecks;
+            return true;
+        }
+
+        ++g_failedChecks;
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        return false;
+    }
+
+    template <typename _T>
+    std::string describe(const _T& value)
+    {
+        if constexpr (std::is_same_v<_T, bool>)
+            return value ? "true" : "false";
+        else if constexpr (std::is_arithmetic_v<_T>)
+            return std::to_string(value);
+        else if constexpr (std::is_convertible_v<const _T&, std::string_view>)
+            return "\"" + std::string(std::string_view(value)) + "\"";
+        else
+            return "(value)";
+    }
+
+    template <typename _Lhs, typename _Rhs>
+    bool checkEqual(const _Lhs& lhs, const _Rhs& rhs, const char* expression, const char* file, int line)
+    {
+        if (lhs == rhs)
+        {
+            ++g_passedChecks;
+            return true;
+        }
+
+        ++g_failedChecks;
+        std::fprintf(stderr, "%s:%d: check failed: %s (%s vs %s)\n", file, line, expression, describe(lhs).c_str(), describe(rhs).c_str());
+        return false;
+    }
+
+    inline int finish()
+    {
+        std::printf("%zu checks passed, %zu failed\n", g_passedChecks, g_failedChecks);
+        return g_failedChecks == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+}
+
+#define TL_CHECK(condition) ::reactor::tests::check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+#define TL_CHECK_EQUAL(lhs, rhs) ::reactor::tests::checkEqual((lhs), (rhs), #lhs " == " #rhs, __FILE__, __LINE__)
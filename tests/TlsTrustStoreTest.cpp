@@ -0,0 +1,207 @@
+/**
+ * @brief TlsTrustStoreTest - custom certificate authorities:
+ *        - TlsTrustStore loads PEM bundle, failed load (missing or broken file) throws and keeps previous store;
+ *        - store is reloaded while other threads attach it to new SSL contexts;
+ *        - TLPollEngine::setCertificateAuthorities against nghttpd over TLS (when its path is passed):
+ *          peer signed by unknown authority is rejected, failed load keeps previous authorities, peer signed by given one is accepted.
+ *
+ * Usage: TlsTrustStoreTest <tls data directory> [<path to nghttpd>]
+ */
+#include <TelegramBot.h>
+#include "TestCheck.h"
+#include "Nghttpd.h"
+
+#include <fstream>
+#include <filesystem>
+
+namespace reactor::tests {
+
+    using Transport = telegram::TLPollEngine::Transport;
+
+    size_t countCertificates(SSL_CTX* context)
+    {
+        size_t count = 0;
+        STACK_OF(X509_OBJECT)* objects = X509_STORE_get0_objects(SSL_CTX_get_cert_store(context));
+
+        for (int index = 0; index < sk_X509_OBJECT_num(objects); ++index)
+            count += X509_OBJECT_get_type(sk_X509_OBJECT_value(objects, index)) == X509_LU_X509 ? 1 : 0;
+
+        return count;
+    }
+
+    template <typename _Function>
+    bool isThrown(_Function&& function)
+    {
+        try
+        {
+            function();
+        }
+        catch (const std::runtime_error&)
+        {
+            return true;
+        }
+
+        return false;
+    }
+
+    void testLoad(const std::filesystem::path& data)
+    {
+        const std::string authority = (data / "ca.pem").string();
+        const std::string notCertificate = (data / "server.key").string();
+
+        TlsTrustStore store {};
+        TL_CHECK(!store.isLoaded());
+
+        store.load(authority, "");
+        TL_CHECK(store.isLoaded());
+        TL_CHECK_EQUAL(store.getCertificatesCount(), 1u);
+
+        // previous store is kept when new one could not be loaded
+        TL_CHECK(isThrown([&store, &data]() { store.load((data / "missing.pem").string(), ""); }));
+        TL_CHECK(isThrown([&store, &notCertificate]() { store.load(notCertificate, ""); }));
+        TL_CHECK(isThrown([&store]() { store.load("", ""); }));
+        TL_CHECK_EQUAL(store.getCertificatesCount(), 1u);
+
+        SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+        store.attachTo(context);
+        TL_CHECK_EQUAL(countCertificates(context), 1u);
+
+        // bundle with both authorities, context keeps store it was attached to
+        const std::filesystem::path bundle = std::filesystem::absolute("TlsTrustStoreTest.bundle.pem");
+        {
+            std::ofstream output { bundle };
+            output << std::ifstream { authority }.rdbuf() << std::ifstream { data / "other-ca.pem" }.rdbuf();
+        }
+
+        store.load(bundle.string(), "");
+        TL_CHECK_EQUAL(store.getCertificatesCount(), 2u);
+        TL_CHECK_EQUAL(countCertificates(context), 1u);
+
+        SSL_CTX_free(context);
+        std::filesystem::remove(bundle);
+    }
+
+    void testReloadWhileAttaching(const std::filesystem::path& data)
+    {
+        static constexpr size_t Reloads = 200;
+        static constexpr size_t AttachingThreads = 4;
+
+        const std::string authorities[] = { (data / "ca.pem").string(), (data / "other-ca.pem").string() };
+
+        TlsTrustStore store {};
+        store.load(authorities[0], "");
+
+        std::atomic<bool> isDone { false };
+        std::atomic<size_t> attachedContexts { 0 };
+        std::atomic<size_t> emptyContexts { 0 };
+        std::vector<std::thread> threads {};
+
+        for (size_t index = 0; index < AttachingThreads; ++index)
+        {
+            threads.emplace_back([&store, &isDone, &attachedContexts, &emptyContexts]() {
+                while (!isDone)
+                {
+                    SSL_CTX* context = SSL_CTX_new(TLS_client_method());
+                    store.attachTo(context);
+
+                    if (countCertificates(context) != 1)
+                        ++emptyContexts;
+
+                    SSL_CTX_free(context);
+                    ++attachedContexts;
+                }
+            });
+        }
+
+        for (size_t reload = 0; reload < Reloads; ++reload)
+            store.load(authorities[reload % 2], "");
+
+        isDone = true;
+
+        for (auto& thread : threads)
+            thread.join();
+
+        TL_CHECK(attachedContexts > 0);
+        TL_CHECK_EQUAL(emptyContexts.load(), 0u);
+        TL_CHECK_EQUAL(store.getCertificatesCount(), 1u);
+    }
+
+    /**
+     * @fn requestOverTls
+     * @return result of single GET request driven by its own transport
+     */
+    CURLcode requestOverTls(const std::string& url, std::string& body)
+    {
+        Transport transport {};
+        transport.setHttpVersion(Transport::HttpVersion::Http2); // nghttpd speaks h2 only
+
+        std::optional<CURLcode> result {};
+        transport.performHttpRequestAsync(url, {}, [&result, &body](CURLcode code, const auto& buffer) {
+            result = code;
+            body = buffer.view();
+        });
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (!result && std::chrono::steady_clock::now() < deadline)
+            transport.poll(10);
+
+        return result.value_or(CURLE_OPERATION_TIMEDOUT);
+    }
+
+    void testCertificateAuthoritiesOfRuntime(const std::filesystem::path& data, const std::string& nghttpd)
+    {
+        static constexpr std::string_view Response = R"({"ok":true,"result":true})";
+
+        const std::filesystem::path htdocs = std::filesystem::absolute("TlsTrustStoreTest.htdocs");
+        std::filesystem::create_directories(htdocs);
+        std::ofstream { htdocs / "getMe" } << Response;
+
+        {
+            Nghttpd server { nghttpd, htdocs.string(), (data / "server.key").string(), (data / "server.pem").string() };
+            const std::string url = server.getBaseUrl() + "/getMe";
+            std::string body {};
+
+            if (!telegram::TLPollEngine::Runtime::getInstance().isSharedTrustStore())
+                std::printf("cURL does not use linked OpenSSL, authorities are passed to cURL by path\n");
+
+            // server certificate is signed by other authority
+            telegram::TLPollEngine::setCertificateAuthorities((data / "other-ca.pem").string());
+            TL_CHECK_EQUAL(requestOverTls(url, body), CURLE_PEER_FAILED_VERIFICATION);
+
+            if (telegram::TLPollEngine::Runtime::getInstance().isSharedTrustStore())
+            {
+                TL_CHECK(isThrown([&data]() { telegram::TLPollEngine::setCertificateAuthorities((data / "missing.pem").string()); }));
+                TL_CHECK_EQUAL(requestOverTls(url, body), CURLE_PEER_FAILED_VERIFICATION);
+            }
+
+            telegram::TLPollEngine::setCertificateAuthorities((data / "ca.pem").string());
+            TL_CHECK_EQUAL(requestOverTls(url, body), CURLE_OK);
+            TL_CHECK(body == Response);
+        }
+
+        std::filesystem::remove_all(htdocs);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: TlsTrustStoreTest <tls data directory> [<path to nghttpd>]\n");
+        return EXIT_FAILURE;
+    }
+
+    spdlog::set_level(spdlog::level::off);
+
+    const std::filesystem::path data = argv[1];
+
+    reactor::tests::testLoad(data);
+    reactor::tests::testReloadWhileAttaching(data);
+
+    if (argc > 2)
+        reactor::tests::testCertificateAuthoritiesOfRuntime(data, argv[2]);
+    else
+        std::printf("nghttpd is not passed, authorities of runtime are not checked\n");
+
+    return reactor::tests::finish();
+}
@@ -0,0 +1,313 @@
+/**
+ * @brief TransportTest - HTTP versions of cURLMultiDriver against local servers:
+ *        - h2 over TLS requested from HTTP/1.1 server (MockBotApiServer): requests are completed over HTTP/1.1, fallback is counted
+ *          and after it requests are not serialized over maxHostConnections of h2 (HTTP/1.1 limits are in effect);
+ *        - requests with the same ordering key (one chat of bot) are sent one by one in order, other keys are not blocked by them;
+ *        - stream which throws in the middle of response is completed as CURLE_WRITE_ERROR instead of escaping from poll();
+ *        - file is uploaded as multipart part next to parameters;
+ *        - h2 with prior knowledge against nghttpd (cleartext h2 server of nghttp2), when its path is passed:
+ *          every request is completed as HTTP/2 stream without fallback.
+ *
+ * Usage: TransportTest [<path to nghttpd>]
+ */
+#include <TelegramBot.h>
+#include <MockBotApi.h>
+#include "TestCheck.h"
+#include "Nghttpd.h"
+
+#include <fstream>
+#include <map>
+#include <filesystem>
+
+namespace reactor::tests {
+
+    using Transport = telegram::TLPollEngine::Transport;
+
+    static constexpr std::chrono::seconds PollTimeout { 10 };
+
+    /**
+     * @fn pollUntil
+     * @return false when condition was not met in PollTimeout
+     */
+    template <typename _Condition>
+    bool pollUntil(Transport& transport, _Condition condition)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + PollTimeout;
+
+        while (!condition())
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+
+            transport.poll(10);
+        }
+
+        return true;
+    }
+
+    void testHttp2FallbackAppliesHttp1Limits()
+    {
+        static constexpr size_t RequestsCount = 6;
+        static constexpr std::chrono::milliseconds Latency { 300 };
+
+        mock::MockBotApiServer server {};
+        server.start();
+        server.setLatency("getMe", Latency);
+
+        Transport transport {};
+        transport.setMaxConcurrentRequests(RequestsCount + 2);
+        transport.setHttpVersion(Transport::HttpVersion::Http2, 1);
+
+        const std::string url = server.getBaseUrl() + "/botTEST/getMe";
+        size_t completed = 0;
+        size_t succeeded = 0;
+
+        const auto onCompleted = [&completed, &succeeded](CURLcode result, const auto& buffer) {
+            ++completed;
+
+            if (result == CURLE_OK && buffer.view().find(R"("ok":true)") != std::string_view::npos)
+                ++succeeded;
+        };
+
+        // server does not speak h2, the first response switches driver to HTTP/1.1
+        transport.performHttpRequestAsync(url, {}, onCompleted);
+        TL_CHECK(pollUntil(transport, [&completed]() { return completed == 1; }));
+        TL_CHECK(transport.isHttp1Fallback());
+        TL_CHECK_EQUAL(transport.getStatistics().http1Fallbacks, 1u);
+
+        for (size_t index = 0; index < RequestsCount; ++index)
+            transport.performHttpRequestAsync(url, {}, onCompleted);
+
+        TL_CHECK(pollUntil(transport, [&completed]() { return completed == RequestsCount + 1; }));
+        TL_CHECK_EQUAL(succeeded, RequestsCount + 1);
+        TL_CHECK_EQUAL(transport.getStatistics().http1Requests, RequestsCount + 1);
+        TL_CHECK_EQUAL(transport.getStatistics().http2Requests, 0u);
+
+        // with single h2 connection requests would arrive one by one every Latency, with HTTP/1.1 limits they are in flight together
+        const auto requests = server.getRecordedRequests();
+        if (TL_CHECK_EQUAL(requests.size(), RequestsCount + 1))
+        {
+            const auto [first, last] = std::minmax_element(requests.begin() + 1, requests.end(), [](const auto& lhs, const auto& rhs) {
+                return lhs.receivedAt < rhs.receivedAt;
+            });
+
+            TL_CHECK(last->receivedAt - first->receivedAt < Latency);
+        }
+
+        // explicit mode change forgets fallback
+        transport.setHttpVersion(Transport::HttpVersion::Http2);
+        TL_CHECK(!transport.isHttp1Fallback());
+
+        server.stop();
+    }
+
+    void testRequestsOfChatAreOrdered()
+    {
+        static constexpr size_t MessagesPerChat = 4;
+        static constexpr std::chrono::milliseconds Latency { 100 };
+        static constexpr std::chrono::milliseconds Tolerance { 20 };
+
+        mock::MockBotApiServer server {};
+        server.start();
+        server.setLatency("sendMessage", Latency);
+
+        Transport transport {};
+        transport.setMaxConcurrentRequests(2 * MessagesPerChat);
+
+        const std::string apiUrl = server.getBaseUrl() + "/botTEST";
+        size_t completed = 0;
+
+        for (size_t index = 0; index < MessagesPerChat; ++index)
+        {
+            for (const int64_t chatId : { 1, 2 })
+            {
+                auto body = transport.createRequestBody();
+                body.add("chat_id", chatId).add("text", std::to_string(index));
+
+                transport.performApiRequestAsync(apiUrl + "/sendMessage", std::move(body), [&completed](CURLcode, const auto&) { ++completed; },
+                                                 nullptr, Transport::makeOrderingKey(apiUrl, chatId));
+            }
+        }
+
+        TL_CHECK_EQUAL(transport.getActiveRequestsCount(), 2u); // the first message of every chat
+        TL_CHECK_EQUAL(transport.getPendingRequestsCount(), 2 * (MessagesPerChat - 1));
+        TL_CHECK(pollUntil(transport, [&completed]() { return completed == 2 * MessagesPerChat; }));
+        TL_CHECK(transport.isIdle());
+
+        std::map<int64_t, std::vector<mock::RecordedRequest>> chats {};
+
+        for (const auto& request : server.getRecordedRequests())
+            chats[request.parameters["chat_id"].get<int64_t>()].push_back(request);
+
+        if (!TL_CHECK_EQUAL(chats.size(), 2u))
+            return;
+
+        for (const auto& [chatId, requests] : chats)
+        {
+            if (!TL_CHECK_EQUAL(requests.size(), MessagesPerChat))
+                continue;
+
+            for (size_t index = 0; index < MessagesPerChat; ++index)
+            {
+                TL_CHECK_EQUAL(requests[index].parameters["text"].get<std::string>(), std::to_string(index));
+
+                // next message is sent only when response to previous one is received
+                if (index > 0)
+                    TL_CHECK(requests[index].receivedAt - requests[index - 1].receivedAt >= Latency - Tolerance);
+            }
+        }
+
+        // chats do not wait for each other
+        const auto firstMessagesGap = chats[1].front().receivedAt - chats[2].front().receivedAt;
+        TL_CHECK(std::chrono::abs(firstMessagesGap) < Latency);
+
+        server.stop();
+    }
+
+    void testFailedStreamIsCompleted()
+    {
+        mock::MockBotApiServer server {};
+        server.start();
+        server.generateUpdates(50, mock::generators::textMessages());
+
+        Transport transport {};
+        const std::string url = server.getBaseUrl() + "/botTEST/getUpdates";
+
+        std::optional<CURLcode> result {};
+        size_t chunks = 0;
+        bool isPollThrown = false;
+
+        const auto onCompleted = [&result](CURLcode code, const auto&) { result = code; };
+        const auto onData = [&chunks](std::string_view) {
+            if (++chunks == 1)
+                throw std::runtime_error("corrupted chunk");
+        };
+
+        transport.performApiRequestAsync(url, transport.createRequestBody(), onCompleted, onData);
+
+        try
+        {
+            TL_CHECK(pollUntil(transport, [&result]() { return result.has_value(); }));
+        }
+        catch (const std::exception&)
+        {
+            isPollThrown = true;
+        }
+
+        TL_CHECK(!isPollThrown);
+        TL_CHECK_EQUAL(chunks, 1u);
+        TL_CHECK(result == CURLE_WRITE_ERROR);
+        TL_CHECK(transport.isIdle());
+
+        // transport is usable after failed stream
+        result.reset();
+        transport.performApiRequestAsync(url, transport.createRequestBody(), onCompleted, [](std::string_view) {});
+        TL_CHECK(pollUntil(transport, [&result]() { return result.has_value(); }));
+        TL_CHECK(result == CURLE_OK);
+
+        server.stop();
+    }
+
+    void testFileUpload()
+    {
+        static constexpr size_t FileSize = 64 * 1024;
+
+        mock::MockBotApiServer server {};
+        server.start();
+
+        const std::filesystem::path file = std::filesystem::absolute("TransportTest.video.mpeg");
+        std::ofstream { file, std::ios::binary } << std::string(FileSize, 'v');
+
+        Transport transport {};
+        std::optional<CURLcode> result {};
+
+        transport.performHttpRequestWithAttachedFileAsync(server.getBaseUrl() + "/botTEST/sendVideo", { { "chat_id", "42" }, { "caption", "clip" } }, file.string(),
+                                                          [&result](CURLcode code, const auto&) { result = code; });
+
+        TL_CHECK(pollUntil(transport, [&result]() { return result.has_value(); }));
+        TL_CHECK(result == CURLE_OK);
+
+        const auto requests = server.getRecordedRequests();
+        if (TL_CHECK_EQUAL(requests.size(), 1u))
+        {
+            const auto& parameters = requests.front().parameters;
+
+            TL_CHECK(parameters.value("chat_id", "") == "42");
+            TL_CHECK(parameters.value("caption", "") == "clip");
+            TL_CHECK(parameters.contains("video") && parameters["video"].value("size", 0u) == FileSize);
+        }
+
+        std::filesystem::remove(file);
+        server.stop();
+    }
+
+    void testHttp2PriorKnowledge(const std::string& nghttpd)
+    {
+        static constexpr size_t RequestsCount = 16;
+        static constexpr std::string_view Response = R"({"ok":true,"result":true})";
+
+        const std::filesystem::path htdocs = std::filesystem::absolute("TransportTest.htdocs");
+        std::filesystem::create_directories(htdocs);
+        std::ofstream { htdocs / "getMe" } << Response;
+
+        {
+            Nghttpd server { nghttpd, htdocs.string() };
+
+            Transport transport {};
+            transport.setHttpVersion(Transport::HttpVersion::Http2PriorKnowledge);
+
+            const std::string url = server.getBaseUrl() + "/getMe";
+            size_t completed = 0;
+            size_t succeeded = 0;
+
+            const auto onCompleted = [&completed, &succeeded](CURLcode result, const auto& buffer) {
+                ++completed;
+
+                if (result == CURLE_OK && buffer.view() == Response)
+                    ++succeeded;
+            };
+
+            transport.performHttpRequestAsync(url, {}, onCompleted);
+            TL_CHECK(pollUntil(transport, [&completed]() { return completed == 1; }));
+
+            // libcurl before 8.0 fails every request which reuses cleartext h2 connection ("Error in the HTTP2 framing layer")
+            const bool isMultiplexingSupported = curl_version_info(CURLVERSION_NOW)->version_num >= 0x080000;
+
+            if (isMultiplexingSupported)
+            {
+                for (size_t index = 1; index < RequestsCount; ++index)
+                    transport.performHttpRequestAsync(url, {}, onCompleted);
+
+                TL_CHECK(pollUntil(transport, [&completed]() { return completed == RequestsCount; }));
+            }
+            else
+            {
+                std::printf("libcurl %s does not reuse h2c connections, only single stream is checked\n", curl_version_info(CURLVERSION_NOW)->version);
+            }
+
+            TL_CHECK_EQUAL(succeeded, completed);
+            TL_CHECK_EQUAL(transport.getStatistics().http2Requests, completed);
+            TL_CHECK_EQUAL(transport.getStatistics().http1Fallbacks, 0u);
+            TL_CHECK(!transport.isHttp1Fallback());
+        }
+
+        std::filesystem::remove_all(htdocs);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    spdlog::set_level(spdlog::level::off);
+
+    reactor::tests::testHttp2FallbackAppliesHttp1Limits();
+    reactor::tests::testRequestsOfChatAreOrdered();
+    reactor::tests::testFailedStreamIsCompleted();
+    reactor::tests::testFileUpload();
+
+    if (argc > 1)
+        reactor::tests::testHttp2PriorKnowledge(argv[1]);
+    else
+        std::printf("nghttpd is not passed, h2 prior knowledge is not checked\n");
+
+    return reactor::tests::finish();
+}
@@ -0,0 +1,1099 @@
+/**
+ * @brief TLCodegen - generator of Telegram Bot API types.
+ *        Reads schema (see schema/BotApi.schema) and emits header with:
+ *          - classes of API types and their *Ptr / list aliases
+ *          - enums of closed string vocabularies with constexpr perfect hash parser
+ *          - bit enums for groups of optional boolean fields (stored as TLFlags)
+ *          - nlohmann::adl_serializer specializations which walk every JSON object once
+ *            and dispatch keys through perfect hash (instead of N separate lookups)
+ *          - request structs for outgoing API methods with serializer into request body
+ *          - retain() overloads which deep copy object graph out of batch arena
+ *          - TLIdentityMaps for types with identity (objects are deduplicated by id while parsing)
+ *
+ * Usage: TLCodegen <schema> <output header>
+ */
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+namespace reactor::codegen {
+
+    struct Field
+    {
+        std::string name;
+        std::string type;
+        bool isOptional { false };
+    };
+
+    struct Constant
+    {
+        std::string name;
+        std::string value;
+    };
+
+    /**
+     * @brief Group of optional boolean keys stored as TLFlags<EnumName> member
+     */
+    struct Flags
+    {
+        std::string member;
+        std::string enumName;
+        std::vector<std::string> keys;
+    };
+
+    struct Type
+    {
+        std::string name;
+        std::vector<Field> fields;
+        std::vector<Constant> constants;
+        bool hasIdentity { false };
+        std::vector<Flags> flags {};
+    };
+
+    struct Enum
+    {
+        std::string name;
+        std::vector<std::string> values;
+    };
+
+    struct List
+    {
+        std::string alias;
+        std::string elementType;
+        size_t inlineCapacity { 0 };
+    };
+
+    struct Method
+    {
+        std::string name;
+        std::vector<Field> fields;
+    };
+
+    struct Schema
+    {
+        std::vector<List> lists;
+        std::vector<Enum> enums;
+        std::vector<Type> types;
+        std::vector<Method> methods;
+
+        [[nodiscard]] const List* findList(const std::string& alias) const
+        {
+            auto iter = std::find_if(lists.begin(), lists.end(), [&alias](const List& list) { return list.alias == alias; });
+            return iter == lists.end() ? nullptr : &(*iter);
+        }
+
+        [[nodiscard]] bool isType(const std::string& name) const
+        {
+            return std::any_of(types.begin(), types.end(), [&name](const Type& type) { return type.name == name; });
+        }
+
+        [[nodiscard]] bool isEnum(const std::string& name) const
+        {
+            return std::any_of(enums.begin(), enums.end(), [&name](const Enum& value) { return value.name == name; });
+        }
+    };
+
+    /**
+     * @class SchemaParser
+     * @brief Line based parser of schema file
+     */
+    class SchemaParser
+    {
+        Schema m_schema;
+        size_t m_lineNumber { 0 };
+
+    public:
+        Schema parse(std::istream& input)
+        {
+            std::string line;
+            Type* currentType = nullptr;
+            Method* currentMethod = nullptr;
+            Enum* currentEnum = nullptr;
+            Flags* currentFlags = nullptr;
+
+            while (std::getline(input, line))
+            {
+                ++m_lineNumber;
+
+                const auto tokens = tokenize(line);
+                if (tokens.empty())
+                    continue;
+
+                const std::string& keyword = tokens[0];
+
+                if (keyword == "end" && currentFlags)
+                {
+                    if (currentFlags->keys.empty() || currentFlags->keys.size() > 32)
+                        fail("flags group must have from 1 to 32 keys");
+
+                    currentFlags = nullptr;
+                }
+                else if (currentFlags)
+                {
+                    if (tokens.size() != 1)
+                        fail("flag must be declared as: <json_key>");
+
+                    currentFlags->keys.push_back(keyword);
+                }
+                else if (keyword == "end")
+                {
+                    if (!currentType && !currentMethod && !currentEnum)
+                        fail("unexpected 'end'");
+
+                    currentType = nullptr;
+                    currentMethod = nullptr;
+                    currentEnum = nullptr;
+                }
+                else if (currentEnum)
+                {
+                    if (tokens.size() != 1)
+                        fail("enum value must be declared as: <value>");
+
+                    currentEnum->values.push_back(keyword);
+                }
+                else if (currentType || currentMethod)
+                {
+                    if (keyword == "const")
+                    {
+                        if (!currentType || tokens.size() != 3)
+                            fail("constant must be declared as: const <Name> \"<value>\" inside of type");
+
+                        currentType->constants.push_back(Constant { tokens[1], tokens[2] });
+                        continue;
+                    }
+
+                    if (keyword == "flags")
+                    {
+                        if (!currentType || tokens.size() != 3)
+                            fail("flags must be declared as: flags <member> <EnumName> ... end inside of type");
+
+                        currentType->flags.push_back(Flags { tokens[1], tokens[2], {} });
+                        currentFlags = &currentType->flags.back();
+                        continue;
+                    }
+
+                    if (tokens.size() < 2 || tokens.size() > 3 || (tokens.size() == 3 && tokens[2] != "optional"))
+                        fail("field must be declared as: <name> <Type> [optional]");
+
+                    Field field { tokens[0], tokens[1], tokens.size() == 3 };
+
+                    if (currentType)
+                        currentType->fields.push_back(field);
+                    else
+                        currentMethod->fields.push_back(field);
+                }
+                else if (keyword == "list" && (tokens.size() == 3 || tokens.size() == 4))
+                {
+                    List list { tokens[1], tokens[2] };
+
+                    if (tokens.size() == 4)
+                    {
+                        char* end = nullptr;
+                        list.inlineCapacity = std::strtoul(tokens[3].c_str(), &end, 10);
+
+                        if (tokens[3].empty() || *end != '\0')
+                            fail("inline capacity of list must be a number");
+                    }
+
+                    m_schema.lists.push_back(list);
+                }
+                else if (keyword == "type" && (tokens.size() == 2 || (tokens.size() == 3 && tokens[2] == "identity")))
+                {
+                    m_schema.types.push_back(Type { tokens[1], {}, {}, tokens.size() == 3 });
+                    currentType = &m_schema.types.back();
+                }
+                else if (keyword == "method" && tokens.size() == 2)
+                {
+                    m_schema.methods.push_back(Method { tokens[1], {} });
+                    currentMethod = &m_schema.methods.back();
+                }
+                else if (keyword == "enum" && tokens.size() == 2)
+                {
+                    m_schema.enums.push_back(Enum { tokens[1], {} });
+                    currentEnum = &m_schema.enums.back();
+                }
+                else
+                {
+                    fail("unknown declaration '" + keyword + "'");
+                }
+            }
+
+            if (currentType || currentMethod || currentEnum || currentFlags)
+                fail("missing 'end' at the end of file");
+
+            validate();
+
+            return m_schema;
+        }
+
+    private:
+        [[noreturn]] void fail(const std::string& message) const
+        {
+            throw std::runtime_error("schema line " + std::to_string(m_lineNumber) + ": " + message);
+        }
+
+        static std::vector<std::string> tokenize(const std::string& line)
+        {
+            std::vector<std::string> tokens;
+            size_t position = 0;
+
+            while (position < line.size())
+            {
+                const char ch = line[position];
+
+                if (ch == '#')
+                    break;
+
+                if (std::isspace(static_cast<unsigned char>(ch)))
+                {
+                    ++position;
+                    continue;
+                }
+
+                if (ch == '"')
+                {
+                    const size_t closing = line.find('"', position + 1);
+                    if (closing == std::string::npos)
+                        throw std::runtime_error("unterminated string in line: " + line);
+
+                    tokens.push_back(line.substr(position + 1, closing - position - 1));
+                    position = closing + 1;
+                    continue;
+                }
+
+                size_t end = position;
+                while (end < line.size() && !std::isspace(static_cast<unsigned char>(line[end])) && line[end] != '#')
+                    ++end;
+
+                tokens.push_back(line.substr(position, end - position));
+                position = end;
+            }
+
+            return tokens;
+        }
+
+        void validate()
+        {
+            static const std::set<std::string> Primitives = { "TLId", "TLDate", "TLString", "bool", "int32_t", "uint32_t" };
+
+            auto checkType = [this](const std::string& owner, const Field& field) {
+                if (Primitives.count(field.type) || m_schema.isType(field.type) || m_schema.isEnum(field.type) || m_schema.findList(field.type))
+                    return;
+
+                throw std::runtime_error("unknown type '" + field.type + "' of field " + owner + "::" + field.name);
+            };
+
+            for (const auto& value : m_schema.enums)
+            {
+                if (value.values.empty())
+                    throw std::runtime_error("enum " + value.name + " has no values");
+            }
+
+            for (const auto& list : m_schema.lists)
+            {
+                if (!m_schema.isType(list.elementType))
+                    throw std::runtime_error("unknown element type '" + list.elementType + "' of list " + list.alias);
+            }
+
+            for (const auto& type : m_schema.types)
+            {
+                for (const auto& field : type.fields)
+                    checkType(type.name, field);
+
+                if (!type.hasIdentity)
+                    continue;
+
+                const bool hasId = std::any_of(type.fields.begin(), type.fields.end(), [](const Field& field) {
+                    return field.name == "id" && field.type == "TLId" && !field.isOptional;
+                });
+
+                if (!hasId)
+                    throw std::runtime_error("type with identity must have required field 'id TLId' (" + type.name + ")");
+
+                // identity objects are compared field by field, nested objects are not supported there
+                for (const auto& field : type.fields)
+                {
+                    if (!Primitives.count(field.type) && !m_schema.isEnum(field.type))
+                        throw std::runtime_error("type with identity could have only primitive and enum fields (" + type.name + "::" + field.name + ")");
+                }
+            }
+
+            for (const auto& method : m_schema.methods)
+            {
+                for (const auto& field : method.fields)
+                {
+                    if (!Primitives.count(field.type) && !m_schema.isEnum(field.type))
+                        throw std::runtime_error("only primitive parameters are supported for methods (" + method.name + "::" + field.name + ")");
+                }
+            }
+        }
+    };
+
+    /**
+     * @class PerfectHash
+     * @brief Search of seed for FNV-1a hash which gives unique slot (hash & mask) for every key.
+     * @note hash() must be the same as reactor::telegram::generated::hashKey emitted into header.
+     */
+    class PerfectHash
+    {
+    public:
+        static constexpr const uint32_t MaxSeed = 1u << 20;
+
+        uint32_t seed { 0 };
+        uint32_t mask { 0 };
+
+        static uint32_t hash(const std::string& key, uint32_t seed)
+        {
+            uint32_t value = 2166136261u ^ seed;
+
+            for (const char ch : key)
+            {
+                value ^= static_cast<uint8_t>(ch);
+                value *= 16777619u;
+            }
+
+            return value ^ (value >> 15);
+        }
+
+        static PerfectHash build(const std::vector<std::string>& keys)
+        {
+            uint32_t tableSize = 1;
+            while (tableSize < keys.size())
+                tableSize <<= 1;
+
+            for (; tableSize <= 1024; tableSize <<= 1)
+            {
+                for (uint32_t seed = 0; seed < PerfectHash::MaxSeed; ++seed)
+                {
+                    std::set<uint32_t> slots;
+
+                    for (const auto& key : keys)
+                    {
+                        if (!slots.insert(hash(key, seed) & (tableSize - 1)).second)
+                            break;
+                    }
+
+                    if (slots.size() == keys.size())
+                        return PerfectHash { seed, tableSize - 1 };
+                }
+            }
+
+            throw std::runtime_error("unable to build perfect hash");
+        }
+    };
+
+    /**
+     * @class HeaderWriter
+     * @brief Emits C++ code from schema
+     */
+    class HeaderWriter
+    {
+        const Schema& m_schema;
+        std::ostringstream m_out;
+
+    public:
+        explicit HeaderWriter(const Schema& schema)
+            : m_schema(schema)
+        {
+        }
+
+        std::string write()
+        {
+            writePrologue();
+            writeDeclarations();
+            writeEnums();
+            writeFlags();
+            writeTypes();
+            writeIdentityMaps();
+            writeRetain();
+            writeRequests();
+            writeSerializerDeclarations();
+            writeSerializerDefinitions();
+
+            return m_out.str();
+        }
+
+    private:
+        static std::string toPascalCase(const std::string& name)
+        {
+            std::string result = name;
+
+            if (!result.empty())
+                result[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(result[0])));
+
+            return result;
+        }
+
+        /**
+         * @brief "bot_command" -> "BotCommand"
+         */
+        static std::string toEnumeratorName(const std::string& value)
+        {
+            std::string result;
+            bool isWordStart = true;
+
+            for (const char ch : value)
+            {
+                if (!std::isalnum(static_cast<unsigned char>(ch)))
+                {
+                    isWordStart = true;
+                    continue;
+                }
+
+                result.push_back(isWordStart ? static_cast<char>(std::toupper(static_cast<unsigned char>(ch))) : ch);
+                isWordStart = false;
+            }
+
+            return result;
+        }
+
+        [[nodiscard]] std::string storageType(const Field& field) const
+        {
+            std::string type = field.type;
+
+            if (m_schema.isType(field.type))
+                type = field.type + "Ptr";
+
+            if (m_schema.isEnum(field.type))
+                type = "TLEnum<" + field.type + ">";
+
+            if (!field.isOptional)
+                return type;
+
+            if (type == "TLString")
+                return "TLOptionalString";
+
+            return "TLOptional<" + type + ">";
+        }
+
+        [[nodiscard]] static bool isScalar(const std::string& type)
+        {
+            return type == "TLId" || type == "TLDate" || type == "bool" || type == "int32_t" || type == "uint32_t";
+        }
+
+        /**
+         * @brief required strings and lists are constructed with allocator of object (optional ones are emplaced by parser)
+         */
+        [[nodiscard]] bool isAllocatorAware(const Field& field) const
+        {
+            return !field.isOptional && (field.type == "TLString" || m_schema.findList(field.type));
+        }
+
+        void writePrologue()
+        {
+            m_out <<
+                "/**\n"
+                " * @brief Generated by TLCodegen from schema/BotApi.schema. DO NOT EDIT.\n"
+                " * @note Header is included by Application.cpp after declaration of base TL aliases\n"
+                " *       (TLId, TLDate, TLString, TLOptional, TLOptionalString, TLAllocator, TLMemoryScope, TLEnum, TLEnumTraits).\n"
+                " *       Objects are allocated from memory resource of TLMemoryScope, strings and lists are std::pmr based.\n"
+                " */\n"
+                "#pragma once\n"
+                "\n"
+                "#include <memory>\n"
+                "#include <string>\n"
+                "#include <cstdint>\n"
+                "#include <stdexcept>\n"
+                "#include <memory_resource>\n"
+                "\n"
+                "#include <SmallVector.h>\n"
+                "#include <string_view>\n"
+                "\n"
+                "#include <nlohmann/json.hpp>\n"
+                "\n"
+                "namespace reactor::telegram::generated {\n"
+                "\n"
+                "    /**\n"
+                "     * @fn hashKey\n"
+                "     * @brief FNV-1a with seed. Seeds for every type are chosen by TLCodegen so (hash & mask) is unique for each known key\n"
+                "     */\n"
+                "    constexpr uint32_t hashKey(std::string_view key, uint32_t seed)\n"
+                "    {\n"
+                "        uint32_t value = 2166136261u ^ seed;\n"
+                "\n"
+                "        for (const char ch : key)\n"
+                "        {\n"
+                "            value ^= static_cast<uint8_t>(ch);\n"
+                "            value *= 16777619u;\n"
+                "        }\n"
+                "\n"
+                "        return value ^ (value >> 15);\n"
+                "    }\n"
+                "\n"
+                "    [[noreturn]] inline void onMissingField(const char* typeName, const char* fieldName)\n"
+                "    {\n"
+                "        throw std::runtime_error(std::string(\"[TLCodegen] required field \") + typeName + \"::\" + fieldName + \" is missing\");\n"
+                "    }\n"
+                "}\n"
+                "\n";
+        }
+
+        void writeDeclarations()
+        {
+            m_out << "namespace reactor::telegram {\n";
+
+            for (const auto& type : m_schema.types)
+                m_out << "        class " << type.name << ";\n";
+
+            m_out << "\n";
+
+            for (const auto& type : m_schema.types)
+                m_out << "        using " << type.name << "Ptr = std::shared_ptr<" << type.name << ">;\n";
+
+            m_out << "\n";
+
+            for (const auto& list : m_schema.lists)
+                m_out << "        using " << list.alias << " = SmallVector<" << list.elementType << "Ptr, " << list.inlineCapacity << ">;\n";
+
+            m_out << "\n";
+        }
+
+        /**
+         * @brief enum class with Unknown = 0 (value is kept as interned string by TLEnum) and TLEnumTraits specialization.
+         *        Parser dispatches value through perfect hash, so recognition costs one hash and one string compare
+         */
+        void writeEnums()
+        {
+            for (const auto& value : m_schema.enums)
+            {
+                const auto hash = PerfectHash::build(value.values);
+
+                m_out << "        enum class " << value.name << " : uint8_t\n"
+                      << "        {\n"
+                      << "            Unknown = 0,\n";
+
+                for (const auto& name : value.values)
+                    m_out << "            " << toEnumeratorName(name) << ",\n";
+
+                m_out << "        };\n"
+                      << "\n"
+                      << "        template <>\n"
+                      << "        struct TLEnumTraits<" << value.name << ">\n"
+                      << "        {\n"
+                      << "            static constexpr const uint32_t Seed = " << hash.seed << "u;\n"
+                      << "            static constexpr const uint32_t Mask = " << hash.mask << "u;\n"
+                      << "\n"
+                      << "            static constexpr " << value.name << " fromString(std::string_view value)\n"
+                      << "            {\n"
+                      << "                switch (generated::hashKey(value, Seed) & Mask)\n"
+                      << "                {\n";
+
+                std::map<uint32_t, std::string> slots;
+                for (const auto& name : value.values)
+                    slots[PerfectHash::hash(name, hash.seed) & hash.mask] = name;
+
+                for (const auto& [slot, name] : slots)
+                {
+                    m_out << "                    case " << slot << ":\n"
+                          << "                        return value == \"" << name << "\" ? " << value.name << "::" << toEnumeratorName(name) << " : " << value.name << "::Unknown;\n";
+                }
+
+                m_out << "                    default:\n"
+                      << "                        return " << value.name << "::Unknown;\n"
+                      << "                }\n"
+                      << "            }\n"
+                      << "\n"
+                      << "            static constexpr std::string_view toString(" << value.name << " value)\n"
+                      << "            {\n"
+                      << "                switch (value)\n"
+                      << "                {\n";
+
+                for (const auto& name : value.values)
+                {
+                    m_out << "                    case " << value.name << "::" << toEnumeratorName(name) << ":\n"
+                          << "                        return \"" << name << "\";\n";
+                }
+
+                m_out << "                    default:\n"
+                      << "                        return {};\n"
+                      << "                }\n"
+                      << "            }\n"
+                      << "        };\n"
+                      << "\n";
+
+                for (const auto& name : value.values)
+                {
+                    m_out << "        static_assert(TLEnumTraits<" << value.name << ">::fromString(\"" << name << "\") == "
+                          << value.name << "::" << toEnumeratorName(name) << ");\n";
+                }
+
+                m_out << "\n";
+            }
+        }
+
+        /**
+         * @brief bit enum for every flags group: value of enumerator is its bit in TLFlags masks
+         */
+        void writeFlags()
+        {
+            for (const auto& type : m_schema.types)
+            {
+                for (const auto& flags : type.flags)
+                {
+                    m_out << "        enum class " << flags.enumName << " : uint32_t\n"
+                          << "        {\n";
+
+                    for (size_t bit = 0; bit < flags.keys.size(); ++bit)
+                        m_out << "            " << toEnumeratorName(flags.keys[bit]) << " = 1u << " << bit << ",\n";
+
+                    m_out << "        };\n\n";
+                }
+            }
+        }
+
+        void writeTypes()
+        {
+            for (const auto& type : m_schema.types)
+            {
+                m_out << "        class " << type.name << "\n"
+                      << "        {\n"
+                      << "        public:\n";
+
+                for (const auto& field : type.fields)
+                {
+                    m_out << "            " << storageType(field) << " " << field.name;
+
+                    if (!field.isOptional && isScalar(field.type))
+                        m_out << " { 0 }";
+
+                    m_out << ";\n";
+                }
+
+                for (const auto& flags : type.flags)
+                    m_out << "            TLFlags<" << flags.enumName << "> " << flags.member << " {};\n";
+
+                if (!type.constants.empty())
+                    m_out << "\n";
+
+                for (const auto& constant : type.constants)
+                    m_out << "            static constexpr const char* " << constant.name << " = \"" << constant.value << "\";\n";
+
+                writeConstructors(type);
+
+                m_out << "        };\n\n";
+            }
+        }
+
+        void writeConstructors(const Type& type)
+        {
+            std::vector<const Field*> allocatorAwareFields;
+            for (const auto& field : type.fields)
+            {
+                if (isAllocatorAware(field))
+                    allocatorAwareFields.push_back(&field);
+            }
+
+            m_out << "\n"
+                  << "            " << type.name << "() = default;\n"
+                  << "\n"
+                  << "            explicit " << type.name << "(const TLAllocator&" << (allocatorAwareFields.empty() ? "" : " allocator") << ")\n";
+
+            for (size_t fieldId = 0; fieldId < allocatorAwareFields.size(); ++fieldId)
+                m_out << "                " << (fieldId == 0 ? ": " : ", ") << allocatorAwareFields[fieldId]->name << "(allocator)\n";
+
+            m_out << "            {\n"
+                  << "            }\n";
+        }
+
+        [[nodiscard]] static std::string toIdentityMapName(const std::string& typeName)
+        {
+            std::string result = typeName + "s";
+            result[0] = static_cast<char>(std::tolower(static_cast<unsigned char>(result[0])));
+
+            return result;
+        }
+
+        /**
+         * @brief isChanged() for every type with identity (used by TLIdentityMap::merge) and TLIdentityMaps
+         */
+        void writeIdentityMaps()
+        {
+            for (const auto& type : m_schema.types)
+            {
+                if (!type.hasIdentity)
+                    continue;
+
+                m_out << "        /**\n"
+                      << "         * @fn isChanged\n"
+                      << "         * @return true when any field of parsed object differs from known one\n"
+                      << "         */\n"
+                      << "        inline bool isChanged(const " << type.name << "& known, const " << type.name << "& parsed)\n"
+                      << "        {\n"
+                      << "            return false";
+
+                for (const auto& field : type.fields)
+                    m_out << "\n                || known." << field.name << " != parsed." << field.name;
+
+                for (const auto& flags : type.flags)
+                    m_out << "\n                || known." << flags.member << " != parsed." << flags.member;
+
+                m_out << ";\n"
+                      << "        }\n"
+                      << "\n";
+            }
+
+            m_out << "        class TLIdentityMaps\n"
+                  << "        {\n"
+                  << "        public:\n";
+
+            for (const auto& type : m_schema.types)
+            {
+                if (type.hasIdentity)
+                    m_out << "            TLIdentityMap<" << type.name << "> " << toIdentityMapName(type.name) << " {};\n";
+            }
+
+            m_out << "\n"
+                  << "            void setCapacity(size_t capacity)\n"
+                  << "            {\n";
+
+            for (const auto& type : m_schema.types)
+            {
+                if (type.hasIdentity)
+                    m_out << "                " << toIdentityMapName(type.name) << ".setCapacity(capacity);\n";
+            }
+
+            m_out << "            }\n"
+                  << "        };\n"
+                  << "\n";
+        }
+
+        void writeRetain()
+        {
+            m_out << "        /**\n"
+                  << "         * @fn retain\n"
+                  << "         * @brief deep copy of object graph into default memory resource.\n"
+                  << "         *        Use it to keep objects which were allocated from batch arena after batch is processed\n"
+                  << "         */\n";
+
+            for (const auto& type : m_schema.types)
+                m_out << "        " << type.name << "Ptr retain(const " << type.name << "Ptr& object);\n";
+
+            m_out << "\n";
+
+            for (const auto& type : m_schema.types)
+            {
+                m_out << "        inline " << type.name << "Ptr retain(const " << type.name << "Ptr& object)\n"
+                      << "        {\n"
+                      << "            if (!object)\n"
+                      << "                return nullptr;\n"
+                      << "\n"
+                      << "            auto result = std::make_shared<" << type.name << ">(*object); // pmr strings and lists are copied into default resource\n";
+
+                bool hasNestedObjects = false;
+
+                for (const auto& field : type.fields)
+                {
+                    const List* list = m_schema.findList(field.type);
+                    if (!m_schema.isType(field.type) && !list)
+                        continue;
+
+                    if (!hasNestedObjects)
+                        m_out << "\n";
+
+                    hasNestedObjects = true;
+
+                    const std::string value = field.isOptional ? "*result->" + field.name : "result->" + field.name;
+                    std::string indent = "            ";
+
+                    if (field.isOptional)
+                    {
+                        m_out << indent << "if (result->" << field.name << ".has_value())\n";
+                        indent += "    ";
+                    }
+
+                    if (list)
+                    {
+                        m_out << indent << "for (auto& item : " << value << ")\n"
+                              << indent << "    item = retain(item);\n";
+                    }
+                    else
+                    {
+                        m_out << indent << value << " = retain(" << value << ");\n";
+                    }
+                }
+
+                m_out << "\n"
+                      << "            return result;\n"
+                      << "        }\n\n";
+            }
+        }
+
+        void writeRequests()
+        {
+            for (const auto& method : m_schema.methods)
+            {
+                const std::string structName = toPascalCase(method.name) + "Request";
+
+                m_out << "        struct " << structName << "\n"
+                      << "        {\n"
+                      << "            static constexpr const char* Method = \"" << method.name << "\";\n";
+
+                if (!method.fields.empty())
+                    m_out << "\n";
+
+                for (const auto& field : method.fields)
+                {
+                    m_out << "            " << storageType(field) << " " << field.name;
+
+                    if (!field.isOptional && isScalar(field.type))
+                        m_out << " { 0 }";
+
+                    m_out << ";\n";
+                }
+
+                m_out << "\n"
+                      << "            template <typename _Body>\n"
+                      << "            void writeTo(" << (method.fields.empty() ? "_Body&" : "_Body& body") << ") const\n"
+                      << "            {\n";
+
+                for (const auto& field : method.fields)
+                {
+                    std::string argument = field.isOptional ? "*" + field.name : field.name;
+
+                    if (m_schema.isEnum(field.type))
+                        argument = field.name + (field.isOptional ? "->toString()" : ".toString()");
+
+                    if (field.isOptional)
+                        m_out << "                if (" << field.name << ".has_value())\n"
+                              << "                    body.add(\"" << field.name << "\", " << argument << ");\n";
+                    else
+                        m_out << "                body.add(\"" << field.name << "\", " << argument << ");\n";
+                }
+
+                m_out << "            }\n"
+                      << "        };\n\n";
+            }
+
+            m_out << "}\n\n";
+        }
+
+        void writeSerializerDeclarations()
+        {
+            m_out << "namespace nlohmann {\n\n";
+
+            for (const auto& type : m_schema.types)
+            {
+                m_out << "    template <>\n"
+                      << "    struct adl_serializer<reactor::telegram::" << type.name << "Ptr>\n"
+                      << "    {\n"
+                      << "        static void from_json(const nlohmann::json& j, reactor::telegram::" << type.name << "Ptr& object);\n"
+                      << "    };\n\n";
+            }
+        }
+
+        void writeFieldAssignment(const Type& type, const Field& field)
+        {
+            // objects with identity are parsed into stack object and merged into identity map later
+            const std::string target = (type.hasIdentity ? "parsed." : "object->") + field.name;
+            const std::string indent = "                        ";
+
+            if (m_schema.isType(field.type))
+            {
+                m_out << indent << "reactor::telegram::" << field.type << "Ptr item = nullptr;\n"
+                      << indent << "nlohmann::adl_serializer<reactor::telegram::" << field.type << "Ptr>::from_json(value, item);\n"
+                      << indent << target << " = std::move(item);\n";
+            }
+            else if (const List* list = m_schema.findList(field.type))
+            {
+                m_out << indent << "if (!value.is_array())\n"
+                      << indent << "    break;\n"
+                      << "\n"
+                      << indent << "reactor::telegram::" << list->alias << " items { allocator };\n"
+                      << indent << "items.reserve(value.size());\n"
+                      << "\n"
+                      << indent << "for (const auto& element : value)\n"
+                      << indent << "{\n"
+                      << indent << "    reactor::telegram::" << list->elementType << "Ptr item = nullptr;\n"
+                      << indent << "    nlohmann::adl_serializer<reactor::telegram::" << list->elementType << "Ptr>::from_json(element, item);\n"
+                      << indent << "    items.push_back(std::move(item));\n"
+                      << indent << "}\n"
+                      << indent << target << " = std::move(items);\n";
+            }
+            else if (m_schema.isEnum(field.type))
+            {
+                m_out << indent << target << " = reactor::telegram::TLEnum<reactor::telegram::" << field.type
+                      << ">::fromString(value.get_ref<const nlohmann::json::string_t&>());\n";
+            }
+            else if (field.type == "TLString")
+            {
+                // assignment keeps allocator of target string, so characters are copied straight into object memory
+                if (field.isOptional)
+                    m_out << indent << target << ".emplace(value.get_ref<const nlohmann::json::string_t&>(), allocator);\n";
+                else
+                    m_out << indent << target << " = value.get_ref<const nlohmann::json::string_t&>();\n";
+            }
+            else
+            {
+                const bool isAlias = field.type.rfind("TL", 0) == 0; // TLId, TLString, ... are declared in reactor::telegram
+                m_out << indent << target << " = value.get<" << (isAlias ? "reactor::telegram::" : "") << field.type << ">();\n";
+            }
+        }
+
+        void writeSerializerDefinitions()
+        {
+            for (const auto& type : m_schema.types)
+            {
+                // keys of fields go first, keys of flags groups follow them
+                std::vector<std::string> keys;
+                std::vector<std::pair<const Flags*, size_t>> flagKeys;
+
+                for (const auto& field : type.fields)
+                    keys.push_back(field.name);
+
+                for (const auto& flags : type.flags)
+                {
+                    for (size_t bit = 0; bit < flags.keys.size(); ++bit)
+                    {
+                        keys.push_back(flags.keys[bit]);
+                        flagKeys.emplace_back(&flags, bit);
+                    }
+                }
+
+                const auto hash = PerfectHash::build(keys);
+
+                std::map<uint32_t, size_t> slots;
+                for (size_t keyId = 0; keyId < keys.size(); ++keyId)
+                    slots[PerfectHash::hash(keys[keyId], hash.seed) & hash.mask] = keyId;
+
+                size_t requiredCount = 0;
+                for (const auto& field : type.fields)
+                    requiredCount += field.isOptional ? 0 : 1;
+
+                m_out << "    inline void adl_serializer<reactor::telegram::" << type.name << "Ptr>::from_json(const nlohmann::json& j, reactor::telegram::" << type.name << "Ptr& object)\n"
+                      << "    {\n"
+                      << "        static constexpr const uint32_t Seed = " << hash.seed << "u;\n"
+                      << "        static constexpr const uint32_t Mask = " << hash.mask << "u;\n"
+                      << "\n"
+                      << "        const reactor::telegram::TLAllocator allocator { reactor::telegram::TLMemoryScope::getResource() };\n";
+
+                if (type.hasIdentity)
+                    m_out << "        reactor::telegram::" << type.name << " parsed { allocator };\n";
+                else
+                    m_out << "        object = std::allocate_shared<reactor::telegram::" << type.name << ">(allocator, allocator);\n";
+
+                if (requiredCount > 0)
+                    m_out << "        uint64_t presentFields = 0;\n";
+
+                m_out << "\n"
+                      << "        for (const auto& [key, value] : j.get_ref<const nlohmann::json::object_t&>())\n"
+                      << "        {\n"
+                      << "            switch (reactor::telegram::generated::hashKey(key, Seed) & Mask)\n"
+                      << "            {\n";
+
+                for (const auto& [slot, keyId] : slots)
+                {
+                    m_out << "                case " << slot << ":\n"
+                          << "                    if (key == \"" << keys[keyId] << "\")\n"
+                          << "                    {\n";
+
+                    if (keyId >= type.fields.size())
+                    {
+                        const auto& [flags, bit] = flagKeys[keyId - type.fields.size()];
+
+                        m_out << "                        " << (type.hasIdentity ? "parsed." : "object->") << flags->member
+                              << ".set(reactor::telegram::" << flags->enumName << "::" << toEnumeratorName(flags->keys[bit]) << ", value.get<bool>());\n"
+                              << "                    }\n"
+                              << "                    break;\n";
+                        continue;
+                    }
+
+                    const size_t fieldId = keyId;
+                    const auto& field = type.fields[fieldId];
+
+                    writeFieldAssignment(type, field);
+
+                    if (!field.isOptional)
+                        m_out << "                        presentFields |= (1ull << " << fieldId << ");\n";
+
+                    m_out << "                    }\n"
+                          << "                    break;\n";
+                }
+
+                m_out << "                default:\n"
+                      << "                    break;\n"
+                      << "            }\n"
+                      << "        }\n";
+
+                if (requiredCount > 0)
+                {
+                    m_out << "\n";
+
+                    for (size_t fieldId = 0; fieldId < type.fields.size(); ++fieldId)
+                    {
+                        const auto& field = type.fields[fieldId];
+                        if (field.isOptional)
+                            continue;
+
+                        m_out << "        if (!(presentFields & (1ull << " << fieldId << ")))\n"
+                              << "            reactor::telegram::generated::onMissingField(\"" << type.name << "\", \"" << field.name << "\");\n";
+                    }
+                }
+
+                if (type.hasIdentity)
+                {
+                    m_out << "\n"
+                          << "        if (auto* identityMaps = reactor::telegram::TLIdentityScope::getMaps())\n"
+                          << "            object = identityMaps->" << toIdentityMapName(type.name) << ".merge(parsed);\n"
+                          << "        else\n"
+                          << "            object = std::allocate_shared<reactor::telegram::" << type.name << ">(allocator, std::move(parsed));\n";
+                }
+
+                m_out << "    }\n\n";
+            }
+
+            m_out << "}\n";
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <schema> <output header>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        std::ifstream schemaFile { argv[1] };
+        if (!schemaFile)
+            throw std::runtime_error(std::string("unable to open schema ") + argv[1]);
+
+        const auto schema = reactor::codegen::SchemaParser {}.parse(schemaFile);
+        const auto header = reactor::codegen::HeaderWriter { schema }.write();
+
+        // Do not touch output when nothing changed, so dependent sources are not rebuilt
+        {
+            std::ifstream previousFile { argv[2] };
+            std::stringstream previous;
+            previous << previousFile.rdbuf();
+
+            if (previousFile && previous.str() == header)
+                return EXIT_SUCCESS;
+        }
+
+        std::ofstream output { argv[2], std::ios::trunc };
+        if (!output)
+            throw std::runtime_error(std::string("unable to write ") + argv[2]);
+
+        output << header;
+    }
+    catch (const std::exception& exception)
+    {
+        std::cerr << "TLCodegen: " << exception.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
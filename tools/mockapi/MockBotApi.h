@@ -0,0 +1,913 @@
+#pragma once
+
+#include <list>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ctime>
+#include <cctype>
+#include <fstream>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <condition_variable>
+
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <zlib.h>
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+#include <nlohmann/json.hpp>
+
+namespace reactor::mock {
+
+    /**
+     * @brief produces body of update (without update_id) for given update id
+     */
+    using UpdateGenerator = std::function<nlohmann::json(int64_t updateId)>;
+
+    namespace generators {
+
+        /**
+         * @fn textMessages
+         * @brief private text messages from chatsCount users (chat id = user id = 1..chatsCount)
+         */
+        inline UpdateGenerator textMessages(size_t chatsCount = 1, std::string text = "hello")
+        {
+            return [chatsCount, text = std::move(text)](int64_t updateId) {
+                const int64_t chatId = 1 + updateId % static_cast<int64_t>(chatsCount);
+
+                return nlohmann::json {
+                    { "message", {
+                        { "message_id", updateId },
+                        { "date", std::time(nullptr) },
+                        { "from", { { "id", chatId }, { "is_bot", false }, { "first_name", "User" } } },
+                        { "chat", { { "id", chatId }, { "type", "private" }, { "first_name", "User" } } },
+                        { "text", text }
+                    } }
+                };
+            };
+        }
+
+        /**
+         * @fn commands
+         * @brief messages with single bot command entity (e.g. "/status")
+         */
+        inline UpdateGenerator commands(std::string command, size_t chatsCount = 1)
+        {
+            return [chatsCount, command = std::move(command)](int64_t updateId) {
+                const int64_t chatId = 1 + updateId % static_cast<int64_t>(chatsCount);
+
+                return nlohmann::json {
+                    { "message", {
+                        { "message_id", updateId },
+                        { "date", std::time(nullptr) },
+                        { "from", { { "id", chatId }, { "is_bot", false }, { "first_name", "User" } } },
+                        { "chat", { { "id", chatId }, { "type", "private" }, { "first_name", "User" } } },
+                        { "text", command },
+                        { "entities", { { { "type", "bot_command" }, { "offset", 0 }, { "length", command.size() } } } }
+                    } }
+                };
+            };
+        }
+    }
+
+    /**
+     * @struct RecordedRequest
+     * @brief API call received by server (parameters from query, JSON, urlencoded or multipart body)
+     */
+    struct RecordedRequest
+    {
+        std::chrono::steady_clock::time_point receivedAt {};
+        std::string token {};
+        std::string method {};
+        nlohmann::json parameters {};   ///< Files of multipart body are recorded as { "file": name, "size": bytes }
+        size_t bodySize { 0 };
+        int status { 200 };             ///< HTTP status of response
+    };
+
+    /**
+     * @struct Fault
+     * @brief error response injected instead of regular one (see MockBotApiServer::setFault)
+     */
+    struct Fault
+    {
+        int errorCode { 429 };
+        std::string description { "Too Many Requests" };
+        int retryAfter { 0 };           ///< Seconds, passed as parameters.retry_after when not zero
+        size_t every { 1 };             ///< Every N-th call of method fails
+        size_t limit { 0 };             ///< Count of faults to inject, 0 is unlimited
+        std::string body {};            ///< When set, sent as is instead of JSON error (e.g. HTML page of proxy)
+    };
+
+    /**
+     * @class MockBotApiServer
+     * @brief Local stand-in of Bot API (HTTP/1.1 with keep-alive, no TLS) for benchmarks and offline runs.
+     *        Serves getMe, getUpdates (long-poll with offsets and limit), sendMessage, sendVideo and setChatTitle,
+     *        other methods are answered with {"ok":true,"result":true}. Every request is recorded.
+     *        Updates are pushed by owner or produced by generator at given rate. Latency and faults are configured per method.
+     *        Point engine to it with TLPollEngine::setApiBaseUrl(server.getBaseUrl()).
+     * @note every connection is served by own thread, server is meant for tens of connections
+     */
+    class MockBotApiServer
+    {
+    public:
+        struct Config
+        {
+            uint16_t port { 0 };                ///< 0 - any free port (see getPort)
+            std::string token {};               ///< Accepted token, empty accepts any
+            size_t maxLimit { 100 };            ///< Bot API returns at most 100 updates per getUpdates
+            bool isCompressionEnabled { false };///< Answer with gzip when client accepts it
+            std::string recordPath {};          ///< When set, every request is appended to this file as JSON line
+            bool isRecordingEnabled { true };   ///< Keep requests in memory (getRecordedRequests), counters are kept anyway
+        };
+
+        using RequestObserver = std::function<void(const RecordedRequest&)>;
+
+    private:
+        struct Connection
+        {
+            int socket { -1 };
+            std::thread thread {};
+            std::atomic<bool> isFinished { false };
+        };
+
+        struct HttpRequest
+        {
+            std::string method {};
+            std::string target {};
+            std::unordered_map<std::string, std::string> headers {};    ///< Names are lower-cased
+            std::string body {};
+        };
+
+        struct FaultState
+        {
+            Fault fault {};
+            size_t calls { 0 };
+            size_t injected { 0 };
+        };
+
+        Config m_config;
+        int m_socket { -1 };
+        uint16_t m_port { 0 };
+        std::thread m_acceptThread {};
+        std::atomic<bool> m_isDead { true };
+
+        mutable std::mutex m_connectionsLock {};
+        std::list<Connection> m_connections {};
+
+        mutable std::mutex m_updatesLock {};
+        std::condition_variable m_updatesAvailable {};
+        std::deque<nlohmann::json> m_updates {};
+        int64_t m_nextUpdateId { 1 };
+        std::unordered_map<int64_t, std::chrono::steady_clock::time_point> m_publishedAt {};
+
+        std::thread m_generatorThread {};
+        std::atomic<bool> m_isGeneratorActive { false };
+
+        mutable std::mutex m_settingsLock {};
+        std::unordered_map<std::string, std::chrono::milliseconds> m_latencies {};
+        std::unordered_map<std::string, FaultState> m_faults {};
+        RequestObserver m_observer {};
+
+        mutable std::mutex m_recordsLock {};
+        std::condition_variable m_requestReceived {};
+        std::vector<RecordedRequest> m_records {};
+        std::unordered_map<std::string, size_t> m_requestsCount {};
+        std::ofstream m_recordFile {};
+        std::atomic<int64_t> m_nextMessageId { 1 };
+
+    public:
+        MockBotApiServer()
+            : MockBotApiServer(Config {})
+        {
+        }
+
+        explicit MockBotApiServer(Config config)
+            : m_config(std::move(config))
+        {
+            if (!m_config.recordPath.empty())
+                m_recordFile.open(m_config.recordPath, std::ios::out | std::ios::app);
+        }
+
+        MockBotApiServer(const MockBotApiServer&) = delete;
+        MockBotApiServer& operator=(const MockBotApiServer&) = delete;
+
+        ~MockBotApiServer()
+        {
+            stop();
+        }
+
+        /**
+         * @fn start
+         * @brief listen on 127.0.0.1 and serve requests on background threads
+         * @throws std::runtime_error when port could not be bound
+         */
+        void start()
+        {
+            m_socket = ::socket(AF_INET, SOCK_STREAM, 0);
+
+            const int reuse = 1;
+            ::setsockopt(m_socket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(m_config.port);
+
+            if (::bind(m_socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(m_socket, 128) != 0)
+            {
+                ::close(m_socket);
+                throw std::runtime_error(fmt::format("[MockBotApiServer::start] unable to listen on port {}", m_config.port));
+            }
+
+            socklen_t addressSize = sizeof(address);
+            ::getsockname(m_socket, reinterpret_cast<sockaddr*>(&address), &addressSize);
+            m_port = ntohs(address.sin_port);
+
+            m_isDead = false;
+            m_acceptThread = std::thread { &MockBotApiServer::acceptProcedure, this };
+
+            spdlog::info("[MockBotApiServer::start] listening on {}", getBaseUrl());
+        }
+
+        void stop()
+        {
+            stopGenerator();
+
+            if (m_isDead.exchange(true))
+                return;
+
+            m_updatesAvailable.notify_all(); // release pending long-polls
+
+            ::shutdown(m_socket, SHUT_RDWR);
+            ::close(m_socket);
+            m_acceptThread.join();
+
+            std::lock_guard<std::mutex> guard { m_connectionsLock };
+
+            for (auto& connection : m_connections)
+                ::shutdown(connection.socket, SHUT_RDWR);
+
+            for (auto& connection : m_connections)
+                connection.thread.join();
+
+            m_connections.clear();
+        }
+
+        [[nodiscard]] uint16_t getPort() const { return m_port; }
+        [[nodiscard]] std::string getBaseUrl() const { return fmt::format("http://127.0.0.1:{}", m_port); }
+
+        /**
+         * @fn pushUpdate
+         * @brief make update available for getUpdates
+         * @return assigned update_id
+         */
+        int64_t pushUpdate(nlohmann::json update)
+        {
+            int64_t updateId = 0;
+
+            {
+                std::lock_guard<std::mutex> guard { m_updatesLock };
+
+                updateId = m_nextUpdateId++;
+                update["update_id"] = updateId;
+
+                m_updates.push_back(std::move(update));
+                m_publishedAt.emplace(updateId, std::chrono::steady_clock::now());
+            }
+
+            m_updatesAvailable.notify_all();
+            return updateId;
+        }
+
+        void generateUpdates(size_t count, const UpdateGenerator& generator)
+        {
+            for (size_t index = 0; index < count; ++index)
+                pushUpdate(generator(peekNextUpdateId()));
+        }
+
+        /**
+         * @fn startGenerator
+         * @brief push updates produced by generator at constant rate (updates per second) from background thread
+         */
+        void startGenerator(double rate, UpdateGenerator generator)
+        {
+            stopGenerator();
+
+            m_isGeneratorActive = true;
+            m_generatorThread = std::thread { [this, rate, generator = std::move(generator)]() {
+                const auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / rate));
+                auto nextAt = std::chrono::steady_clock::now();
+
+                while (m_isGeneratorActive)
+                {
+                    pushUpdate(generator(peekNextUpdateId()));
+
+                    nextAt += interval;
+                    std::this_thread::sleep_until(nextAt);
+                }
+            } };
+        }
+
+        void stopGenerator()
+        {
+            m_isGeneratorActive = false;
+
+            if (m_generatorThread.joinable())
+                m_generatorThread.join();
+        }
+
+        /**
+         * @fn getPublishTime
+         * @return time when update was pushed (used to measure latency of reply)
+         */
+        [[nodiscard]] std::optional<std::chrono::steady_clock::time_point> getPublishTime(int64_t updateId) const
+        {
+            std::lock_guard<std::mutex> guard { m_updatesLock };
+
+            const auto iter = m_publishedAt.find(updateId);
+            return iter != m_publishedAt.end() ? std::make_optional(iter->second) : std::nullopt;
+        }
+
+        /**
+         * @fn getPendingUpdatesCount
+         * @return updates which were not confirmed by offset of getUpdates yet
+         */
+        [[nodiscard]] size_t getPendingUpdatesCount() const
+        {
+            std::lock_guard<std::mutex> guard { m_updatesLock };
+            return m_updates.size();
+        }
+
+        /**
+         * @fn setLatency
+         * @brief delay response of method (empty method is default for all)
+         */
+        void setLatency(const std::string& method, std::chrono::milliseconds latency)
+        {
+            std::lock_guard<std::mutex> guard { m_settingsLock };
+            m_latencies[method] = latency;
+        }
+
+        /**
+         * @fn setFault
+         * @brief answer method with error (e.g. 429 with retry_after) according to schedule of fault
+         */
+        void setFault(const std::string& method, const Fault& fault)
+        {
+            std::lock_guard<std::mutex> guard { m_settingsLock };
+            m_faults[method] = FaultState { fault, 0, 0 };
+        }
+
+        void clearFaults()
+        {
+            std::lock_guard<std::mutex> guard { m_settingsLock };
+            m_faults.clear();
+        }
+
+        /**
+         * @fn setRequestObserver
+         * @brief callback for every recorded request (called from connection thread before response is sent)
+         */
+        void setRequestObserver(RequestObserver observer)
+        {
+            std::lock_guard<std::mutex> guard { m_settingsLock };
+            m_observer = std::move(observer);
+        }
+
+        [[nodiscard]] std::vector<RecordedRequest> getRecordedRequests() const
+        {
+            std::lock_guard<std::mutex> guard { m_recordsLock };
+            return m_records;
+        }
+
+        [[nodiscard]] size_t getRequestsCount(const std::string& method) const
+        {
+            std::lock_guard<std::mutex> guard { m_recordsLock };
+
+            const auto iter = m_requestsCount.find(method);
+            return iter != m_requestsCount.end() ? iter->second : 0;
+        }
+
+        /**
+         * @fn waitForRequests
+         * @return true when at least count calls of method were received before timeout
+         */
+        bool waitForRequests(const std::string& method, size_t count, std::chrono::milliseconds timeout)
+        {
+            std::unique_lock<std::mutex> lock { m_recordsLock };
+
+            return m_requestReceived.wait_for(lock, timeout, [this, &method, count]() {
+                const auto iter = m_requestsCount.find(method);
+                return iter != m_requestsCount.end() && iter->second >= count;
+            });
+        }
+
+    private:
+        int64_t peekNextUpdateId() const
+        {
+            std::lock_guard<std::mutex> guard { m_updatesLock };
+            return m_nextUpdateId;
+        }
+
+        void acceptProcedure()
+        {
+            while (!m_isDead)
+            {
+                const int client = ::accept(m_socket, nullptr, nullptr);
+                if (client < 0)
+                    continue;
+
+                const int noDelay = 1;
+                ::setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+                std::lock_guard<std::mutex> guard { m_connectionsLock };
+
+                if (m_isDead)
+                {
+                    ::close(client);
+                    break;
+                }
+
+                reapConnections();
+
+                auto& connection = m_connections.emplace_back();
+                connection.socket = client;
+                connection.thread = std::thread { &MockBotApiServer::connectionProcedure, this, &connection };
+            }
+        }
+
+        void reapConnections()
+        {
+            for (auto iter = m_connections.begin(); iter != m_connections.end();)
+            {
+                if (!iter->isFinished)
+                {
+                    ++iter;
+                    continue;
+                }
+
+                iter->thread.join();
+                iter = m_connections.erase(iter);
+            }
+        }
+
+        void connectionProcedure(Connection* connection)
+        {
+            std::string input {};
+            HttpRequest request {};
+
+            while (!m_isDead && readRequest(connection->socket, input, request))
+            {
+                const bool isKeepAlive = request.headers["connection"] != "close";
+
+                if (!handleRequest(connection->socket, request) || !isKeepAlive)
+                    break;
+            }
+
+            ::close(connection->socket);
+            connection->isFinished = true;
+        }
+
+        static bool readRequest(int socket, std::string& input, HttpRequest& request)
+        {
+            request = HttpRequest {};
+
+            size_t headersEnd = std::string::npos;
+            bool isContinueSent = false;
+
+            while (true)
+            {
+                if (headersEnd == std::string::npos)
+                {
+                    headersEnd = input.find("\r\n\r\n");
+
+                    if (headersEnd != std::string::npos)
+                        parseHead(std::string_view(input).substr(0, headersEnd), request);
+                }
+
+                if (headersEnd != std::string::npos)
+                {
+                    const size_t contentLength = std::strtoull(request.headers["content-length"].c_str(), nullptr, 10);
+                    const size_t bodyBegin = headersEnd + 4;
+
+                    if (input.size() >= bodyBegin + contentLength)
+                    {
+                        request.body = input.substr(bodyBegin, contentLength);
+                        input.erase(0, bodyBegin + contentLength);
+                        return true;
+                    }
+
+                    if (!isContinueSent && request.headers["expect"] == "100-continue")
+                    {
+                        static constexpr std::string_view Continue = "HTTP/1.1 100 Continue\r\n\r\n";
+                        ::send(socket, Continue.data(), Continue.size(), MSG_NOSIGNAL);
+                        isContinueSent = true;
+                    }
+                }
+
+                char chunk[16 * 1024];
+                const ssize_t received = ::recv(socket, chunk, sizeof(chunk), 0);
+                if (received <= 0)
+                    return false;
+
+                input.append(chunk, static_cast<size_t>(received));
+            }
+        }
+
+        static void parseHead(std::string_view head, HttpRequest& request)
+        {
+            size_t lineEnd = head.find("\r\n");
+            const std::string_view requestLine = head.substr(0, lineEnd);
+
+            const size_t methodEnd = requestLine.find(' ');
+            const size_t targetEnd = requestLine.find(' ', methodEnd + 1);
+            request.method = requestLine.substr(0, methodEnd);
+            request.target = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+
+            while (lineEnd != std::string_view::npos)
+            {
+                const size_t lineBegin = lineEnd + 2;
+                lineEnd = head.find("\r\n", lineBegin);
+
+                const std::string_view line = head.substr(lineBegin, lineEnd == std::string_view::npos ? std::string_view::npos : lineEnd - lineBegin);
+                const size_t colon = line.find(':');
+                if (colon == std::string_view::npos)
+                    continue;
+
+                std::string name { line.substr(0, colon) };
+                std::transform(name.begin(), name.end(), name.begin(), [](unsigned char ch) { return static_cast<char>(std::tolower(ch)); });
+
+                std::string_view value = line.substr(colon + 1);
+                while (!value.empty() && value.front() == ' ')
+                    value.remove_prefix(1);
+
+                request.headers[name] = std::string(value);
+            }
+        }
+
+        /**
+         * @fn handleRequest
+         * @return false when connection must be closed
+         */
+        bool handleRequest(int socket, HttpRequest& request)
+        {
+            // target is /bot<token>/<method>[?query]
+            const std::string_view target = request.target;
+            const size_t queryBegin = target.find('?');
+            const std::string_view path = target.substr(0, queryBegin);
+
+            const size_t methodBegin = path.rfind('/');
+            if (path.substr(0, 4) != "/bot" || methodBegin == std::string_view::npos || methodBegin < 4)
+                return sendResponse(socket, request, 404, R"({"ok":false,"error_code":404,"description":"Not Found"})");
+
+            RecordedRequest record {};
+            record.receivedAt = std::chrono::steady_clock::now();
+            record.token = path.substr(4, methodBegin - 4);
+            record.method = path.substr(methodBegin + 1);
+            record.bodySize = request.body.size();
+            record.parameters = nlohmann::json::object();
+
+            if (queryBegin != std::string_view::npos)
+                parseUrlEncoded(target.substr(queryBegin + 1), record.parameters);
+
+            parseBody(request, record.parameters);
+
+            int status = 200;
+            std::string response = dispatch(record, status);
+
+            record.status = status;
+            applyLatency(record.method);
+            recordRequest(record);
+
+            return sendResponse(socket, request, status, response);
+        }
+
+        std::string dispatch(const RecordedRequest& record, int& status)
+        {
+            if (!m_config.token.empty() && record.token != m_config.token)
+            {
+                status = 401;
+                return R"({"ok":false,"error_code":401,"description":"Unauthorized"})";
+            }
+
+            if (auto fault = takeFault(record.method))
+            {
+                status = fault->errorCode;
+
+                if (!fault->body.empty())
+                    return fault->body;
+
+                nlohmann::json error = { { "ok", false }, { "error_code", fault->errorCode }, { "description", fault->description } };
+
+                if (fault->retryAfter > 0)
+                {
+                    error["description"] = fmt::format("{}: retry after {}", fault->description, fault->retryAfter);
+                    error["parameters"] = { { "retry_after", fault->retryAfter } };
+                }
+
+                return error.dump();
+            }
+
+            if (record.method == "getMe")
+                return R"({"ok":true,"result":{"id":1000000,"is_bot":true,"first_name":"MockBot","username":"mock_bot"}})";
+
+            if (record.method == "getUpdates")
+                return getUpdates(record.parameters);
+
+            if (record.method == "sendMessage" || record.method == "sendVideo")
+            {
+                nlohmann::json message = {
+                    { "message_id", m_nextMessageId++ },
+                    { "date", std::time(nullptr) },
+                    { "chat", { { "id", toInteger(record.parameters.value("chat_id", nlohmann::json(0))) }, { "type", "private" } } }
+                };
+
+                if (record.parameters.contains("text"))
+                    message["text"] = record.parameters["text"];
+
+                return nlohmann::json({ { "ok", true }, { "result", std::move(message) } }).dump();
+            }
+
+            return R"({"ok":true,"result":true})"; // setChatTitle and the rest of methods
+        }
+
+        std::string getUpdates(const nlohmann::json& parameters)
+        {
+            const int64_t offset = toInteger(parameters.value("offset", nlohmann::json(0)));
+            const int64_t timeout = toInteger(parameters.value("timeout", nlohmann::json(0)));
+            const int64_t requestedLimit = toInteger(parameters.value("limit", nlohmann::json(100)));
+            const size_t limit = std::clamp<size_t>(requestedLimit > 0 ? static_cast<size_t>(requestedLimit) : 100, 1, m_config.maxLimit);
+
+            std::unique_lock<std::mutex> lock { m_updatesLock };
+
+            // updates before offset are confirmed
+            while (offset > 0 && !m_updates.empty() && m_updates.front()["update_id"].get<int64_t>() < offset)
+            {
+                m_publishedAt.erase(m_updates.front()["update_id"].get<int64_t>());
+                m_updates.pop_front();
+            }
+
+            m_updatesAvailable.wait_for(lock, std::chrono::seconds(std::max<int64_t>(timeout, 0)), [this]() {
+                return !m_updates.empty() || m_isDead;
+            });
+
+            std::string response = R"({"ok":true,"result":[)";
+
+            for (size_t index = 0; index < m_updates.size() && index < limit; ++index)
+            {
+                if (index > 0)
+                    response.push_back(',');
+
+                response += m_updates[index].dump();
+            }
+
+            response += "]}";
+            return response;
+        }
+
+        std::optional<Fault> takeFault(const std::string& method)
+        {
+            std::lock_guard<std::mutex> guard { m_settingsLock };
+
+            const auto iter = m_faults.find(method);
+            if (iter == m_faults.end())
+                return std::nullopt;
+
+            auto& state = iter->second;
+            const bool isLimitReached = state.fault.limit > 0 && state.injected >= state.fault.limit;
+
+            if (isLimitReached || ++state.calls % std::max<size_t>(state.fault.every, 1) != 0)
+                return std::nullopt;
+
+            ++state.injected;
+            return state.fault;
+        }
+
+        void applyLatency(const std::string& method)
+        {
+            std::chrono::milliseconds latency { 0 };
+
+            {
+                std::lock_guard<std::mutex> guard { m_settingsLock };
+
+                auto iter = m_latencies.find(method);
+                if (iter == m_latencies.end())
+                    iter = m_latencies.find("");
+
+                if (iter != m_latencies.end())
+                    latency = iter->second;
+            }
+
+            if (latency.count() > 0)
+                std::this_thread::sleep_for(latency);
+        }
+
+        void recordRequest(const RecordedRequest& record)
+        {
+            RequestObserver observer {};
+
+            {
+                std::lock_guard<std::mutex> guard { m_settingsLock };
+                observer = m_observer;
+            }
+
+            if (observer)
+                observer(record);
+
+            {
+                std::lock_guard<std::mutex> guard { m_recordsLock };
+
+                if (m_recordFile.is_open())
+                {
+                    const nlohmann::json line = {
+                        { "time", std::chrono::duration_cast<std::chrono::microseconds>(record.receivedAt.time_since_epoch()).count() },
+                        { "method", record.method },
+                        { "status", record.status },
+                        { "body_size", record.bodySize },
+                        { "parameters", record.parameters }
+                    };
+
+                    m_recordFile << line.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+                }
+
+                ++m_requestsCount[record.method];
+
+                if (m_config.isRecordingEnabled)
+                    m_records.push_back(record);
+            }
+
+            m_requestReceived.notify_all();
+        }
+
+        bool sendResponse(int socket, HttpRequest& request, int status, std::string body)
+        {
+            const bool isGzip = m_config.isCompressionEnabled && request.headers["accept-encoding"].find("gzip") != std::string::npos;
+
+            if (isGzip)
+                body = compress(body);
+
+            const std::string head = fmt::format("HTTP/1.1 {} {}\r\nContent-Type: application/json\r\nContent-Length: {}\r\n{}\r\n",
+                                                 status, status == 200 ? "OK" : "Error", body.size(), isGzip ? "Content-Encoding: gzip\r\n" : "");
+
+            const std::string response = head + body;
+            size_t sent = 0;
+
+            while (sent < response.size())
+            {
+                const ssize_t result = ::send(socket, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+                if (result <= 0)
+                    return false;
+
+                sent += static_cast<size_t>(result);
+            }
+
+            return true;
+        }
+
+        static std::string compress(const std::string& data)
+        {
+            z_stream stream {};
+            deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY); // +16: gzip format
+
+            std::string result(deflateBound(&stream, data.size()), '\0');
+
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+            stream.avail_in = static_cast<uInt>(data.size());
+            stream.next_out = reinterpret_cast<Bytef*>(result.data());
+            stream.avail_out = static_cast<uInt>(result.size());
+
+            deflate(&stream, Z_FINISH);
+            result.resize(stream.total_out);
+            deflateEnd(&stream);
+
+            return result;
+        }
+
+        static void parseBody(const HttpRequest& request, nlohmann::json& parameters)
+        {
+            const auto contentTypeIter = request.headers.find("content-type");
+            if (request.body.empty() || contentTypeIter == request.headers.end())
+                return;
+
+            const std::string& contentType = contentTypeIter->second;
+
+            if (contentType.find("application/json") != std::string::npos)
+            {
+                auto body = nlohmann::json::parse(request.body, nullptr, false);
+                if (body.is_object())
+                    parameters.update(body);
+            }
+            else if (contentType.find("application/x-www-form-urlencoded") != std::string::npos)
+            {
+                parseUrlEncoded(request.body, parameters);
+            }
+            else if (contentType.find("multipart/form-data") != std::string::npos)
+            {
+                const size_t boundaryBegin = contentType.find("boundary=");
+                if (boundaryBegin != std::string::npos)
+                    parseMultipart(request.body, "--" + contentType.substr(boundaryBegin + 9), parameters);
+            }
+        }
+
+        static void parseUrlEncoded(std::string_view data, nlohmann::json& parameters)
+        {
+            while (!data.empty())
+            {
+                const size_t pairEnd = data.find('&');
+                const std::string_view pair = data.substr(0, pairEnd);
+                const size_t separator = pair.find('=');
+
+                if (separator != std::string_view::npos)
+                    parameters[urlDecode(pair.substr(0, separator))] = urlDecode(pair.substr(separator + 1));
+
+                data = pairEnd == std::string_view::npos ? std::string_view {} : data.substr(pairEnd + 1);
+            }
+        }
+
+        static void parseMultipart(std::string_view body, const std::string& boundary, nlohmann::json& parameters)
+        {
+            size_t partBegin = body.find(boundary);
+
+            while (partBegin != std::string_view::npos)
+            {
+                partBegin += boundary.size() + 2; // boundary line ends with CRLF ("--" for last one)
+
+                const size_t partEnd = body.find(boundary, partBegin);
+                if (partEnd == std::string_view::npos)
+                    break;
+
+                const std::string_view part = body.substr(partBegin, partEnd - partBegin - 2);
+                const size_t headersEnd = part.find("\r\n\r\n");
+
+                if (headersEnd != std::string_view::npos)
+                {
+                    const std::string_view headers = part.substr(0, headersEnd);
+                    const std::string_view content = part.substr(headersEnd + 4);
+
+                    const auto attribute = [&headers](std::string_view name) -> std::optional<std::string> {
+                        const size_t begin = headers.find(name);
+                        if (begin == std::string_view::npos)
+                            return std::nullopt;
+
+                        const size_t valueBegin = begin + name.size();
+                        return std::string(headers.substr(valueBegin, headers.find('"', valueBegin) - valueBegin));
+                    };
+
+                    if (const auto name = attribute(" name=\""))
+                    {
+                        if (const auto fileName = attribute("filename=\""))
+                            parameters[*name] = { { "file", *fileName }, { "size", content.size() } };
+                        else
+                            parameters[*name] = std::string(content);
+                    }
+                }
+
+                partBegin = partEnd;
+            }
+        }
+
+        static std::string urlDecode(std::string_view value)
+        {
+            std::string result {};
+            result.reserve(value.size());
+
+            for (size_t index = 0; index < value.size(); ++index)
+            {
+                if (value[index] == '+')
+                    result.push_back(' ');
+                else if (value[index] == '%' && index + 2 < value.size())
+                {
+                    result.push_back(static_cast<char>(std::stoi(std::string(value.substr(index + 1, 2)), nullptr, 16)));
+                    index += 2;
+                }
+                else
+                    result.push_back(value[index]);
+            }
+
+            return result;
+        }
+
+        static int64_t toInteger(const nlohmann::json& value)
+        {
+            if (value.is_number_integer())
+                return value.get<int64_t>();
+
+            if (value.is_string())
+                return std::strtoll(value.get_ref<const std::string&>().c_str(), nullptr, 10);
+
+            return 0;
+        }
+    };
+}
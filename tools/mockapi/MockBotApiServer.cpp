@@ -0,0 +1,147 @@
+/**
+ * @brief MockBotApiServer - local Bot API stand-in for offline runs and benchmarks (see MockBotApi.h).
+ *
+ * Usage: MockBotApiServer [options]
+ *        --port N                       listen port (default 8081)
+ *        --token TOKEN                  accept only this token
+ *        --updates N                    push N updates at start
+ *        --rate R                       push R updates per second
+ *        --command /cmd                 generate bot commands instead of text messages
+ *        --chats N                      spread generated updates over N chats
+ *        --latency [method=]MS          delay responses (of method or all)
+ *        --error method=CODE[:RETRY_AFTER][/EVERY]
+ *                                       answer method with error (e.g. sendMessage=429:3/10)
+ *        --gzip                         compress responses when client accepts gzip
+ *        --record FILE                  append every request to FILE as JSON line
+ *
+ * Run bot against it: REACTOR_TELEGRAM_API_URL=http://127.0.0.1:8081 ICVReactor
+ */
+#include <MockBotApi.h>
+
+#include <csignal>
+#include <cstdlib>
+
+namespace {
+    std::atomic<bool> g_isInterrupted { false };
+
+    void onSignal(int)
+    {
+        g_isInterrupted = true;
+    }
+
+    std::pair<std::string, std::string> splitOption(const std::string& value, char separator)
+    {
+        const size_t position = value.find(separator);
+        if (position == std::string::npos)
+            return { std::string(), value };
+
+        return { value.substr(0, position), value.substr(position + 1) };
+    }
+}
+
+int main(int argc, char** argv)
+{
+    using namespace reactor;
+
+    mock::MockBotApiServer::Config config {};
+    config.port = 8081;
+    config.isRecordingEnabled = false; // long runs, requests are written to --record file when needed
+
+    size_t initialUpdates = 0;
+    double rate = 0.0;
+    size_t chatsCount = 1;
+    std::string command {};
+    std::vector<std::pair<std::string, std::chrono::milliseconds>> latencies {};
+    std::vector<std::pair<std::string, mock::Fault>> faults {};
+
+    for (int argument = 1; argument < argc; ++argument)
+    {
+        const std::string option = argv[argument];
+        const std::string value = argument + 1 < argc ? argv[argument + 1] : "";
+
+        if (option == "--gzip")
+        {
+            config.isCompressionEnabled = true;
+            continue;
+        }
+
+        if (value.empty())
+        {
+            std::fprintf(stderr, "option %s requires value\n", option.c_str());
+            return EXIT_FAILURE;
+        }
+
+        ++argument;
+
+        if (option == "--port")
+            config.port = static_cast<uint16_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (option == "--token")
+            config.token = value;
+        else if (option == "--record")
+            config.recordPath = value;
+        else if (option == "--updates")
+            initialUpdates = std::strtoull(value.c_str(), nullptr, 10);
+        else if (option == "--rate")
+            rate = std::strtod(value.c_str(), nullptr);
+        else if (option == "--chats")
+            chatsCount = std::max<size_t>(std::strtoull(value.c_str(), nullptr, 10), 1);
+        else if (option == "--command")
+            command = value;
+        else if (option == "--latency")
+        {
+            const auto [method, milliseconds] = splitOption(value, '=');
+            latencies.emplace_back(method, std::chrono::milliseconds(std::strtoll(milliseconds.c_str(), nullptr, 10)));
+        }
+        else if (option == "--error")
+        {
+            const auto [method, schedule] = splitOption(value, '=');
+            const auto [error, every] = splitOption(schedule, '/');
+            const auto [code, retryAfter] = splitOption(error, ':');
+
+            mock::Fault fault {};
+            fault.errorCode = std::atoi((code.empty() ? retryAfter : code).c_str());
+            fault.retryAfter = code.empty() ? 0 : std::atoi(retryAfter.c_str());
+            fault.every = std::max<size_t>(std::strtoull(every.c_str(), nullptr, 10), 1);
+            fault.description = fault.errorCode == 429 ? "Too Many Requests" : "Bad Request";
+
+            faults.emplace_back(method, fault);
+        }
+        else
+        {
+            std::fprintf(stderr, "unknown option %s\n", option.c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    mock::MockBotApiServer server { config };
+
+    for (const auto& [method, latency] : latencies)
+        server.setLatency(method, latency);
+
+    for (const auto& [method, fault] : faults)
+        server.setFault(method, fault);
+
+    const auto generator = command.empty() ? mock::generators::textMessages(chatsCount) : mock::generators::commands(command, chatsCount);
+
+    server.start();
+    server.generateUpdates(initialUpdates, generator);
+
+    if (rate > 0.0)
+        server.startGenerator(rate, generator);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    std::printf("MockBotApiServer listening on %s\n", server.getBaseUrl().c_str());
+    std::fflush(stdout);
+
+    while (!g_isInterrupted)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    server.stop();
+
+    for (const char* method : { "getMe", "getUpdates", "sendMessage", "sendVideo", "setChatTitle" })
+        std::printf("%-14s %zu requests\n", method, server.getRequestsCount(method));
+
+    return EXIT_SUCCESS;
+}